@@ -0,0 +1,423 @@
+// Drives Classification on the host SDK stand-in: replays the /configuration
+// sequence from the web page, feeds synthetic raw frames through
+// ProcessRawVideo and reports per-frame latency, metadata output and the
+// component's own per-stage breakdown (get_stats).
+//
+//   classification_bench [--frames N] [--warmup N] [--stream WxH]...
+//                        [--model NAME[:OUTPUT]]... [--settings DIR] [--pipelined]
+//                        [--policy every|latest|target_fps:N|fair] [--feed-fps N]
+//                        [--config JSON]... [--swap-at N:FILE] [--boot] [--channels N]
+//                        [--busy N] [--min-fps N] [--max-p99-us N] [--expect-metadata HASH]
+//                        [--expect-messages N] [--verbose]
+//
+// --feed-fps paces frame delivery like a camera (0, the default, feeds as
+// fast as the component accepts them). --config sends extra /configuration
+// bodies after run_network. Each --model loads one more network on the same
+// stream (google_net.bin when none is given); NAME:OUTPUT names its output
+// tensor (prob_1 by default), e.g. det_0 for a host detector. --swap-at
+// sends swap_model for the first model of every channel before measured
+// frame N, putting FILE in its place while frames keep flowing. --boot skips the /configuration
+// sequence and relies on auto_load from the --settings of an earlier run
+// (--config '{"mode": "set_auto_load", "auto_load": "on"}'), feeding frames
+// until the first metadata comes out. --channels runs N instances of the
+// component with the same configuration, as the ${APPCHANNEL} instances of
+// a camera do, each fed its own frames. The report then adds the time to
+// configure them all, the resident memory they added and the admission and
+// metadata counters of each channel (only channel 0 publishes unless
+// --policy fair); the other lines are channel 0's. --busy feeds
+// channel 0 N frames for every frame of the others, e.g. to check that
+// --policy fair keeps a busy channel from starving the rest.
+//
+// --min-fps, --max-p99-us, --expect-metadata and --expect-messages turn a
+// run into a regression check: the bench exits 1 when throughput falls
+// below N, the p99 frame latency goes above N us, the last metadata hash
+// differs or channel 0 sent other than N messages (ctest runs it this way,
+// see CMakeLists.txt).
+//
+// Component logging goes to /dev/null unless --verbose is given; the report
+// is always written to the original stdout.
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "classification.h"
+#include "host_frame_source.h"
+#include "host_metadata_sink.h"
+
+namespace {
+
+struct Options {
+  int frames = 300;
+  int warmup = 10;
+  std::vector<HostFrameSource::Stream> streams;
+  std::vector<std::string> models;
+  std::string settings = "host_settings/";
+  bool pipelined = false;
+  std::string policy = "every";
+  std::string target_fps;
+  int feed_fps = 0;
+  std::vector<std::string> configs;
+  int swap_at = -1;
+  std::string swap_file;
+  bool boot = false;
+  int channels = 1;
+  int busy = 1;
+  double min_fps = 0;     // 0: not checked
+  double max_p99_us = 0;  // 0: not checked
+  std::string expect_metadata;
+  int expect_messages = -1;  // -1: not checked
+  bool verbose = false;
+};
+
+bool ParseOptions(int argc, char** argv, Options& opt) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--frames" && has_value) {
+      opt.frames = atoi(argv[++i]);
+    } else if (arg == "--warmup" && has_value) {
+      opt.warmup = atoi(argv[++i]);
+    } else if (arg == "--stream" && has_value) {
+      HostFrameSource::Stream s = {0, 0};
+      if (sscanf(argv[++i], "%ux%u", &s.width, &s.height) != 2 || s.width < 16 || s.height < 16) { return false; }
+      opt.streams.push_back(s);
+    } else if (arg == "--model" && has_value) {
+      opt.models.push_back(argv[++i]);
+    } else if (arg == "--settings" && has_value) {
+      opt.settings = argv[++i];
+      if (opt.settings.back() != '/') { opt.settings += '/'; }
+    } else if (arg == "--policy" && has_value) {
+      opt.policy = argv[++i];
+      auto colon = opt.policy.find(':');
+      if (colon != std::string::npos) {
+        opt.target_fps = opt.policy.substr(colon + 1);
+        opt.policy.resize(colon);
+      }
+    } else if (arg == "--feed-fps" && has_value) {
+      opt.feed_fps = atoi(argv[++i]);
+    } else if (arg == "--config" && has_value) {
+      opt.configs.push_back(argv[++i]);
+    } else if (arg == "--swap-at" && has_value) {
+      std::string value = argv[++i];
+      auto colon = value.find(':');
+      if (colon == std::string::npos || colon + 1 == value.size()) { return false; }
+      opt.swap_at = atoi(value.c_str());
+      opt.swap_file = value.substr(colon + 1);
+    } else if (arg == "--channels" && has_value) {
+      opt.channels = atoi(argv[++i]);
+      if (opt.channels < 1) { return false; }
+    } else if (arg == "--busy" && has_value) {
+      opt.busy = atoi(argv[++i]);
+      if (opt.busy < 1) { return false; }
+    } else if (arg == "--min-fps" && has_value) {
+      opt.min_fps = atof(argv[++i]);
+    } else if (arg == "--max-p99-us" && has_value) {
+      opt.max_p99_us = atof(argv[++i]);
+    } else if (arg == "--expect-metadata" && has_value) {
+      opt.expect_metadata = argv[++i];
+    } else if (arg == "--expect-messages" && has_value) {
+      opt.expect_messages = atoi(argv[++i]);
+    } else if (arg == "--boot") {
+      opt.boot = true;
+    } else if (arg == "--pipelined") {
+      opt.pipelined = true;
+    } else if (arg == "--verbose") {
+      opt.verbose = true;
+    } else {
+      return false;
+    }
+  }
+  if (opt.streams.empty()) {
+    // typical camera substream chain, largest first
+    opt.streams = {{1920, 1080}, {1280, 720}, {640, 360}};
+  }
+  if (opt.models.empty()) { opt.models = {"google_net.bin"}; }
+  return opt.frames > 0;
+}
+
+class BenchClassification : public Classification {
+ public:
+  bool Configure(const std::string& body, std::string* response = nullptr) {
+    auto* request = new ("Http") OpenAppSerializable("/configuration", "POST", body);
+    Event event(static_cast<int32_t>(IAppDispatcher::EEventType::eHttpRequest), request);
+    ProcessAEvent(&event);
+    if (response) { *response = request->GetResponseBody(); }
+    return request->GetStatusCode() == 200;
+  }
+};
+
+double Percentile(std::vector<double> v, double p) {
+  if (v.empty()) { return 0.0; }
+  size_t idx = static_cast<size_t>(p * (v.size() - 1) + 0.5);
+  std::nth_element(v.begin(), v.begin() + idx, v.end());
+  return v[idx];
+}
+
+size_t ResidentBytes() {
+  long size = 0;
+  long resident = 0;
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if (!statm) { return 0; }
+  if (fscanf(statm, "%ld %ld", &size, &resident) != 2) { resident = 0; }
+  fclose(statm);
+  return static_cast<size_t>(resident) * sysconf(_SC_PAGESIZE);
+}
+
+uint64_t Fnv1a(const std::string& s) {
+  uint64_t h = 1469598103934665603ull;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!ParseOptions(argc, argv, opt)) {
+    fprintf(stderr, "usage: %s [--frames N] [--warmup N] [--stream WxH]... [--model NAME[:OUTPUT]]... [--settings DIR] [--pipelined] [--policy every|latest|target_fps:N|fair] [--feed-fps N] [--config JSON]... [--swap-at N:FILE] [--boot] [--channels N] [--busy N] [--min-fps N] [--max-p99-us N] [--expect-metadata HASH] [--expect-messages N] [--verbose]\n", argv[0]);
+    return 2;
+  }
+
+  FILE* report = fdopen(dup(fileno(stdout)), "w");
+  if (!opt.verbose) {
+    fflush(stdout);
+    if (!freopen("/dev/null", "w", stdout)) { return 1; }
+  }
+
+  HostMetadataSink sink;
+  BenchClassification component;
+  HostInstanceConfig config;
+  config.model_path = MANIFEST_DIR;
+  config.setting_path = opt.settings;
+  component.HostConfigure(config);
+  HostFrameSource source(opt.streams);
+  std::vector<std::unique_ptr<HostFrameSource>> channel_sources;
+  for (int c = 1; c < opt.channels; c++) { channel_sources.push_back(std::make_unique<HostFrameSource>(opt.streams)); }
+  const auto boot_start = std::chrono::steady_clock::now();
+  component.HostInitialize();
+  component.HostStart();
+
+  // the other channels, each with its own settings and frames
+  std::vector<std::unique_ptr<BenchClassification>> channels;
+  for (int c = 1; c < opt.channels; c++) {
+    HostInstanceConfig channel_config = config;
+    channel_config.channel = c;
+    channel_config.setting_path = opt.settings.substr(0, opt.settings.size() - 1) + "_ch" + std::to_string(c) + "/";
+    channels.push_back(std::make_unique<BenchClassification>());
+    channels.back()->HostConfigure(channel_config);
+    channels.back()->HostInitialize();
+    channels.back()->HostStart();
+  }
+  auto feed_channels = [&]() {
+    for (size_t c = 0; c < channels.size(); c++) {
+      std::unique_ptr<Event> event(channel_sources[c]->NextEvent());
+      channels[c]->ProcessAEvent(event.get());
+    }
+  };
+
+  std::vector<std::string> sequence;
+  for (auto& model : opt.models) {
+    const auto colon = model.find(':');
+    const std::string output = colon == std::string::npos ? "prob_1" : model.substr(colon + 1);
+    sequence.insert(sequence.end(), {
+      "{\"mode\": \"create_network\", \"model_name\": \"" + model.substr(0, colon) + "\"}",
+      "{\"mode\": \"create_input_tensor\", \"input_tensor\": \"data_0\"}",
+      "{\"mode\": \"create_output_tensor\", \"output_tensor\": \"" + output + "\"}",
+      "{\"mode\": \"load_network\"}",
+    });
+  }
+  sequence.insert(sequence.end(), {
+    std::string("{\"mode\": \"set_inference_mode\", \"inference_mode\": \"") + (opt.pipelined ? "pipelined" : "sync") + "\"}",
+    "{\"mode\": \"set_frame_policy\", \"frame_policy\": \"" + opt.policy + "\"" +
+        (opt.target_fps.empty() ? std::string() : ", \"target_fps\": \"" + opt.target_fps + "\"") + "}",
+    "{\"mode\": \"run_network\"}",
+  });
+  sequence.insert(sequence.end(), opt.configs.begin(), opt.configs.end());
+  if (opt.boot) { sequence.clear(); }
+  const size_t resident_before = ResidentBytes();
+  const auto configure_start = std::chrono::steady_clock::now();
+  for (auto& body : sequence) {
+    if (!component.Configure(body)) {
+      fprintf(report, "configuration failed: %s\n", body.c_str());
+      return 1;
+    }
+  }
+  for (auto& channel : channels) {
+    for (auto& body : sequence) {
+      if (!channel->Configure(body)) {
+        fprintf(report, "configuration failed: %s\n", body.c_str());
+        return 1;
+      }
+    }
+  }
+  const double configure_ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - configure_start).count();
+  const size_t resident_added = ResidentBytes() - std::min(resident_before, ResidentBytes());
+
+  int boot_frames = 0;
+  for (; opt.boot && sink.Count() == 0; boot_frames++) {
+    if (boot_frames == 10000) {
+      fprintf(report, "no metadata after boot\n");
+      return 1;
+    }
+    std::unique_ptr<Event> event(source.NextEvent());
+    component.ProcessAEvent(event.get());
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  const double boot_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - boot_start).count();
+  for (int i = 0; i < opt.warmup; i++) {
+    std::unique_ptr<Event> event(source.NextEvent());
+    component.ProcessAEvent(event.get());
+    feed_channels();
+  }
+  component.Configure("{\"mode\": \"get_stats\", \"reset\": true, \"drain\": true}");
+  for (auto& channel : channels) { channel->Configure("{\"mode\": \"get_stats\", \"reset\": true, \"drain\": true}"); }
+  std::vector<uint64_t> warmup_metadata(opt.channels);
+  for (int c = 0; c < opt.channels; c++) { warmup_metadata[c] = sink.Count(c); }
+
+  std::vector<double> latency_us;
+  latency_us.reserve(opt.frames);
+  size_t swap_resident = 0;
+  auto bench_start = std::chrono::steady_clock::now();
+  for (int i = 0; i < opt.frames; i++) {
+    if (opt.feed_fps > 0) {
+      std::this_thread::sleep_until(bench_start + std::chrono::microseconds(1000000LL * i / opt.feed_fps));
+    }
+    if (i == opt.swap_at) {
+      const std::string body = "{\"mode\": \"swap_model\", \"model_file\": \"" + opt.swap_file + "\"}";
+      swap_resident = ResidentBytes();
+      bool swapped = component.Configure(body);
+      for (auto& channel : channels) { swapped = channel->Configure(body) && swapped; }
+      if (!swapped) {
+        fprintf(report, "swap_model failed\n");
+        return 1;
+      }
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int b = 0; b < opt.busy; b++) {
+      std::unique_ptr<Event> event(source.NextEvent());
+      component.ProcessAEvent(event.get());
+    }
+    feed_channels();
+    latency_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+  }
+  // "drain" waits for the frames still in flight first
+  const std::string get_stats = "{\"mode\": \"get_stats\", \"drain\": true}";
+  std::string stats;
+  component.Configure(get_stats, &stats);
+  std::vector<std::string> channel_stats(channels.size());
+  for (size_t c = 0; c < channels.size(); c++) { channels[c]->Configure(get_stats, &channel_stats[c]); }
+  double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - bench_start).count();
+
+  fprintf(report, "frames          : %d (warmup %d, %s, policy %s)\n", opt.frames, opt.warmup,
+          opt.pipelined ? "pipelined" : "sync", opt.policy.c_str());
+  fprintf(report, "streams         :");
+  for (auto& s : opt.streams) { fprintf(report, " %ux%u", s.width, s.height); }
+  fprintf(report, "\n");
+  if (opt.channels > 1) {
+    fprintf(report, "channels        : %d, configured in %.0f ms, resident +%.1f MB\n", opt.channels, configure_ms,
+            resident_added / 1048576.0);
+  }
+  const double fps = opt.frames / elapsed_s;
+  const double p99_us = Percentile(latency_us, 0.99);
+  char last_metadata[17];
+  snprintf(last_metadata, sizeof(last_metadata), "%016" PRIx64, Fnv1a(sink.Last()));
+  fprintf(report, "throughput      : %.1f fps\n", fps);
+  fprintf(report, "frame latency us: p50 %.0f  p95 %.0f  p99 %.0f  max %.0f\n",
+          Percentile(latency_us, 0.50), Percentile(latency_us, 0.95), p99_us,
+          *std::max_element(latency_us.begin(), latency_us.end()));
+  fprintf(report, "metadata        : %" PRIu64 " messages, %" PRIu64 " bytes total, in order: %s\n",
+          sink.Count() - warmup_metadata[0], sink.Bytes(), sink.InOrder() ? "yes" : "no");
+  fprintf(report, "last metadata   : %s\n", last_metadata);
+  fprintf(report, "raw frames held : %" PRIu64 " after drain\n", static_cast<uint64_t>(source.FramesInFlight()));
+  if (opt.boot) {
+    std::string startup;
+    component.Configure("{\"mode\": \"get_startup_status\"}", &startup);
+    JsonUtility::JsonDocument status;
+    status.Parse(startup);
+    if (!status.HasParseError() && status.HasMember("auto_load")) {
+      fprintf(report, "boot            : first metadata after %.0f ms, %d frames (component %" PRId64
+              " ms; auto_load %s, load %" PRIu64 " ms, warm-up %" PRIu64 " ms)\n", boot_ms, boot_frames,
+              status["first_metadata_ms"].GetInt64(), status["auto_load"].GetString(), status["load_ms"].GetUint64(),
+              status["warmup_ms"].GetUint64());
+    }
+  }
+  if (opt.swap_at >= 0) {
+    std::string swap;
+    component.Configure("{\"mode\": \"get_swap_status\"}", &swap);
+    JsonUtility::JsonDocument status;
+    status.Parse(swap);
+    if (!status.HasParseError() && status.HasMember("state")) {
+      fprintf(report, "model swap      : %s at frame %d (load %" PRIu64 " ms, warm-up %" PRIu64 " ms), resident %+.1f MB\n",
+              status["state"].GetString(), opt.swap_at, status["load_ms"].GetUint64(), status["warmup_ms"].GetUint64(),
+              (static_cast<double>(ResidentBytes()) - static_cast<double>(swap_resident)) / (1024.0 * 1024.0));
+    }
+  }
+
+  JsonUtility::JsonDocument document;
+  document.Parse(stats);
+  if (!document.HasParseError() && document.HasMember("Frames")) {
+    const auto& frames = document["Frames"];
+    fprintf(report, "admission       : received %" PRIu64 "  dropped %" PRIu64 "  inferred %" PRIu64
+            "  reused %" PRIu64 "  suppressed %" PRIu64 "\n", frames["received"].GetUint64(),
+            frames["dropped"].GetUint64(), frames["inferred"].GetUint64(), frames["reused"].GetUint64(),
+            frames["suppressed"].GetUint64());
+  }
+  for (size_t c = 0; c < channel_stats.size(); c++) {
+    JsonUtility::JsonDocument channel_document;
+    channel_document.Parse(channel_stats[c]);
+    if (channel_document.HasParseError() || !channel_document.HasMember("Frames")) { continue; }
+    const auto& frames = channel_document["Frames"];
+    fprintf(report, "  channel %-6zu: received %" PRIu64 "  dropped %" PRIu64 "  inferred %" PRIu64 "  metadata %" PRIu64 "\n",
+            c + 1, frames["received"].GetUint64(), frames["dropped"].GetUint64(), frames["inferred"].GetUint64(),
+            sink.Count(static_cast<int>(c + 1)) - warmup_metadata[c + 1]);
+  }
+  if (!document.HasParseError() && document.HasMember("Stages")) {
+    fprintf(report, "%-16s %8s %8s %8s %8s %8s\n", "stage (us)", "count", "p50", "p95", "p99", "max");
+    for (auto& stage : document["Stages"].GetObject()) {
+      const auto& v = stage.value;
+      fprintf(report, "%-16s %8" PRIu64 " %8" PRIu64 " %8" PRIu64 " %8" PRIu64 " %8" PRIu64 "\n", stage.name.GetString(),
+              v["count"].GetUint64(), v["p50_us"].GetUint64(), v["p95_us"].GetUint64(),
+              v["p99_us"].GetUint64(), v["max_us"].GetUint64());
+    }
+  }
+
+  bool failed = false;
+  if (opt.min_fps > 0 && fps < opt.min_fps) {
+    fprintf(report, "FAILED: throughput %.1f fps below %.1f\n", fps, opt.min_fps);
+    failed = true;
+  }
+  if (opt.max_p99_us > 0 && p99_us > opt.max_p99_us) {
+    fprintf(report, "FAILED: p99 frame latency %.0f us above %.0f\n", p99_us, opt.max_p99_us);
+    failed = true;
+  }
+  if (!opt.expect_metadata.empty() && opt.expect_metadata != last_metadata) {
+    fprintf(report, "FAILED: last metadata %s, expected %s\n", last_metadata, opt.expect_metadata.c_str());
+    failed = true;
+  }
+  const uint64_t messages = sink.Count() - warmup_metadata[0];
+  if (opt.expect_messages >= 0 && messages != static_cast<uint64_t>(opt.expect_messages)) {
+    fprintf(report, "FAILED: %" PRIu64 " metadata messages, expected %d\n", messages, opt.expect_messages);
+    failed = true;
+  }
+  fclose(report);
+
+  for (auto& channel : channels) {
+    channel->Configure("{\"mode\": \"unload_network\"}");
+    channel->HostFinalize();
+  }
+  component.Configure("{\"mode\": \"unload_network\"}");
+  component.HostFinalize();
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,189 @@
+// Compares building the ONVIF metadata document for one frame:
+//
+//   concat : the string-concatenating builder used before MetadataWriter
+//            (operator+ temporaries, std::to_string, a stringstream for
+//            the timestamp)
+//   xml    : MetadataWriter, ONVIF document in one reused buffer
+//
+// for a whole-frame result (1 object) and for grids of boxed crop results,
+// counting heap allocations per frame through a replaced operator new, and
+// checks that both produce the same bytes. A second table gives the size
+// and cost of the compact formats (set_metadata_format json / binary).
+//
+//   metadata_bench [--iterations N] [--k K]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "class_result.h"
+#include "metadata_writer.h"
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+
+}  // namespace
+
+void* operator new(size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = malloc(size ? size : 1)) { return p; }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+namespace {
+
+std::string TimePointToString(uint64_t timestamp) {
+  time_t sec = (time_t)(timestamp / 1000);
+  uint32_t msec = (uint32_t)(timestamp % 1000);
+  auto conv_time = ::gmtime((const time_t*)&sec);
+  std::stringstream ss("");
+  ss << std::put_time(conv_time, "%FT%T.") << std::setfill('0') << std::setw(3) << msec << "Z";
+  return ss.str();
+}
+
+std::string Concat(const ClassResult* objects, size_t count, const int64_t timestamp) {
+  using std::string;
+  using std::to_string;
+  string str_time = TimePointToString(timestamp);
+
+  string star_xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
+  string MetadataStream = "<tt:MetadataStream xmlns:tt=\"http://www.onvif.org/ver10/schema\" xmlns:ttr=\"https://www.onvif.org/ver20/analytics/radiometry\" xmlns:wsnt=\"http://docs.oasis-open.org/wsn/b-2\" xmlns:tns1=\"http://www.onvif.org/ver10/topics\" xmlns:tnssamsung=\"http://www.samsungcctv.com/2011/event/topics\" xmlns:fc=\"http://www.onvif.org/ver20/analytics/humanface\" xmlns:bd=\"http://www.onvif.org/ver20/analytics/humanbody\"><tt:VideoAnalytics>";
+  string utc_time = "<tt:Frame UtcTime=\"" + str_time + "\">";
+
+  string xml_data = star_xml + MetadataStream + utc_time;
+  for (size_t i = 0; i < count; i++) {
+    const auto& object = objects[i];
+    xml_data += "<tt:Object ObjectId=\"" + to_string(2 + i) + "\"><tt:Appearance>";
+    if (object.has_box) {
+      float left = object.box.x * 2.0f - 1.0f;
+      float right = (object.box.x + object.box.width) * 2.0f - 1.0f;
+      float top = 1.0f - object.box.y * 2.0f;
+      float bottom = 1.0f - (object.box.y + object.box.height) * 2.0f;
+      xml_data += "<tt:Shape><tt:BoundingBox left=\"" + to_string(left) + "\" top=\"" + to_string(top) +
+                  "\" right=\"" + to_string(right) + "\" bottom=\"" + to_string(bottom) + "\"/>" +
+                  "<tt:CenterOfGravity x=\"" + to_string((left + right) / 2) + "\" y=\"" + to_string((top + bottom) / 2) + "\"/></tt:Shape>";
+    }
+    xml_data += "<tt:Class>";
+    for (uint32_t k = 0; k < object.count; k++) {
+      xml_data += "<tt:Type Likelihood=\"" + to_string(object.top[k].value) + "\">" + to_string(object.top[k].id) + "</tt:Type>";
+    }
+    xml_data += "</tt:Class></tt:Appearance></tt:Object>";
+  }
+  xml_data += "</tt:Frame></tt:VideoAnalytics></tt:MetadataStream>";
+
+  return xml_data;
+}
+
+std::vector<ClassResult> MakeObjects(int grid, uint32_t k, std::mt19937& rng) {
+  std::uniform_real_distribution<float> prob(0.0f, 1.0f);
+  std::uniform_int_distribution<int> id(0, 21842);
+  std::vector<ClassResult> objects;
+  const int cells = grid > 0 ? grid * grid : 1;
+  for (int c = 0; c < cells; c++) {
+    ClassResult object{};
+    object.count = k;
+    for (uint32_t i = 0; i < k; i++) { object.top[i] = {id(rng), prob(rng)}; }
+    if (grid > 0) {
+      object.has_box = true;
+      object.box = {float(c % grid) / grid, float(c / grid) / grid, 1.0f / grid, 1.0f / grid};
+    }
+    objects.push_back(object);
+  }
+  return objects;
+}
+
+// Runs |f| once per frame over |frames| consecutive 33 ms timestamps and
+// returns ns and allocations per frame.
+template <typename F>
+void PerFrame(int frames, F&& f, double& ns, double& allocations) {
+  const uint64_t start_ms = 1760000000000ull;
+  f(start_ms);
+  const uint64_t allocations_before = g_allocations.load();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < frames; i++) { f(start_ms + 33ull * i); }
+  ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frames;
+  allocations = double(g_allocations.load() - allocations_before) / frames;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = 20000;
+  uint32_t k = 5;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--iterations" && i + 1 < argc) {
+      iterations = std::max(1, atoi(argv[++i]));
+    } else if (arg == "--k" && i + 1 < argc) {
+      k = static_cast<uint32_t>(std::min(static_cast<int>(ClassResult::kMaxTopK), std::max(1, atoi(argv[++i]))));
+    } else {
+      fprintf(stderr, "usage: %s [--iterations N] [--k K]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  using Format = MetadataWriter::Format;
+  const uint32_t model_id = MetadataWriter::ModelId("google_net.bin");
+  std::mt19937 rng(7);
+  std::vector<std::vector<ClassResult>> cases;
+  for (int grid : {0, 2, 4, 8}) { cases.push_back(MakeObjects(grid, k, rng)); }
+
+  printf("%-8s %7s %7s %10s %10s %8s %13s %13s %6s\n", "objects", "boxes", "bytes", "concat ns", "xml ns",
+         "speedup", "concat alloc", "xml alloc", "same");
+  for (const auto& objects : cases) {
+    MetadataWriter writer;
+
+    bool same = true;
+    size_t bytes = 0;
+    for (uint64_t t : {0ull, 999ull, 1760000000123ull, 1760000001000ull}) {
+      const std::string expected = Concat(objects.data(), objects.size(), t);
+      same &= writer.Write(Format::eXml, model_id, 0, objects.data(), objects.size(), t) == expected;
+      bytes = expected.size();
+    }
+
+    size_t sink = 0;
+    double concat_ns, concat_allocations, writer_ns, writer_allocations;
+    PerFrame(iterations, [&](uint64_t t) { sink += Concat(objects.data(), objects.size(), t).size(); },
+             concat_ns, concat_allocations);
+    PerFrame(iterations, [&](uint64_t t) {
+      sink += writer.Write(Format::eXml, model_id, 0, objects.data(), objects.size(), t).size();
+    }, writer_ns, writer_allocations);
+
+    printf("%-8zu %7s %7zu %10.0f %10.0f %7.1fx %13.1f %13.1f %6s\n", objects.size(), objects[0].has_box ? "yes" : "no",
+           bytes, concat_ns, writer_ns, concat_ns / writer_ns, concat_allocations, writer_allocations,
+           same && sink ? "yes" : "NO");
+  }
+
+  printf("\n%-8s %7s %10s %10s %10s %10s %10s %10s %10s\n", "objects", "boxes", "xml bytes", "json bytes",
+         "bin bytes", "xml ns", "json ns", "bin ns", "allocs");
+  for (const auto& objects : cases) {
+    MetadataWriter writer;
+    size_t bytes[3];
+    double ns[3];
+    double allocations = 0;
+    for (Format format : {Format::eXml, Format::eJson, Format::eBinary}) {
+      const int i = static_cast<int>(format);
+      double format_allocations;
+      PerFrame(iterations, [&](uint64_t t) {
+        bytes[i] = writer.Write(format, model_id, 0, objects.data(), objects.size(), t).size();
+      }, ns[i], format_allocations);
+      allocations = std::max(allocations, format_allocations);
+    }
+    printf("%-8zu %7s %10zu %10zu %10zu %10.0f %10.0f %10.0f %10.1f\n", objects.size(),
+           objects[0].has_box ? "yes" : "no", bytes[0], bytes[1], bytes[2], ns[0], ns[1], ns[2], allocations);
+  }
+  return 0;
+}
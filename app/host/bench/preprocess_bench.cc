@@ -0,0 +1,112 @@
+// Compares the two ways PreProcess can fill a 224x224 float32 network input
+// from a raw NV12 frame:
+//
+//   sdk   : Tensor::Allocate (NV12 -> RGB888 at full size), Tensor::Resize,
+//           then the per-channel mean/scale the SDK applies in RunNetwork
+//   fused : FusedPreprocessor, one pass from NV12
+//
+// and reports the time per frame and the difference between the two outputs
+// (0..255 scale). The fused pass clamps after interpolating rather than
+// before, so saturated edges differ by more than the mean.
+//
+//   preprocess_bench [--iterations N] [--stream WxH]...
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fused_preprocess.h"
+#include "host_frame_source.h"
+#include "pl_video_frame_raw.h"
+
+namespace {
+
+const std::vector<float> kMean = {123.68f, 116.779f, 103.939f};
+const std::vector<float> kScale = {1.0f, 1.0f, 1.0f};
+const img_size_t kInput = {224, 224};
+
+template <typename F>
+double MicrosPerRun(int iterations, F&& f) {
+  f();  // warm up buffers and tables
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) { f(); }
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = 50;
+  std::vector<HostFrameSource::Stream> streams;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--iterations" && i + 1 < argc) {
+      iterations = std::max(1, atoi(argv[++i]));
+    } else if (arg == "--stream" && i + 1 < argc) {
+      HostFrameSource::Stream s = {0, 0};
+      if (sscanf(argv[++i], "%ux%u", &s.width, &s.height) != 2 || s.width < 16 || s.height < 16) { return 2; }
+      streams.push_back(s);
+    } else {
+      fprintf(stderr, "usage: %s [--iterations N] [--stream WxH]...\n", argv[0]);
+      return 2;
+    }
+  }
+  if (streams.empty()) {
+    streams = {{1920, 1080}, {1280, 720}, {640, 360}, {320, 240}};
+  }
+
+  printf("%-11s %12s %12s %8s %10s %10s\n", "source", "sdk us", "fused us", "speedup", "max diff", "mean diff");
+  for (auto& stream : streams) {
+    HostFrameSource source({stream});
+    Blob blob = source.NextFrame();
+    IPLVideoFrameRaw frame;
+    std::pair<std::variant<BaseObject*, char*>, uint64_t> ret((char*)blob.GetRawData(), blob.GetSize());
+    if (!frame.DeserializeBaseObject(&frame, ret)) { return 1; }
+    const RawImage& image = *frame.GetRawImage();
+
+    std::unique_ptr<Tensor> rgb(Tensor::Create());
+    std::unique_ptr<Tensor> sdk(Tensor::Create("data_0", {kInput.width, kInput.height, 3}, eTensorFloat32));
+    std::unique_ptr<Tensor> fused(Tensor::Create("data_0", {kInput.width, kInput.height, 3}, eTensorFloat32));
+    const size_t plane = static_cast<size_t>(kInput.width) * kInput.height;
+
+    double sdk_us = MicrosPerRun(iterations, [&] {
+      rgb->Allocate(image);
+      rgb->Resize(*sdk, kInput);
+      auto* p = static_cast<float*>(sdk->VirtAddr());
+      for (size_t c = 0; c < 3; c++) {
+        for (size_t i = 0; i < plane; i++) { p[c * plane + i] = (p[c * plane + i] - kMean[c]) * kScale[c]; }
+      }
+    });
+
+    FusedPreprocessor preprocessor;
+    preprocessor.SetNormalization(kMean, kScale);
+    double fused_us = MicrosPerRun(iterations, [&] { preprocessor.Run(image, *fused, kInput); });
+
+    // the sdk lambda normalises in place, so recompute a single clean pass
+    rgb->Allocate(image);
+    rgb->Resize(*sdk, kInput);
+    preprocessor.Run(image, *fused, kInput);
+    const auto* a = static_cast<const float*>(sdk->VirtAddr());
+    const auto* b = static_cast<const float*>(fused->VirtAddr());
+    float max_diff = 0.0f;
+    double sum_diff = 0.0;
+    for (size_t c = 0; c < 3; c++) {
+      for (size_t i = 0; i < plane; i++) {
+        float d = std::fabs((a[c * plane + i] - kMean[c]) * kScale[c] - b[c * plane + i]);
+        max_diff = std::max(max_diff, d);
+        sum_diff += d;
+      }
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "%ux%u", stream.width, stream.height);
+    printf("%-11s %12.0f %12.0f %7.1fx %10.2f %10.3f\n", name, sdk_us, fused_us, sdk_us / fused_us, max_diff, sum_diff / (3 * plane));
+    blob.ClearResource();
+  }
+  return 0;
+}
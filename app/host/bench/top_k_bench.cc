@@ -0,0 +1,189 @@
+// Compares top-k selection over a classifier output:
+//
+//   cascade   : the five-branch insertion ParseResult used before TopK
+//               (K = 5 only, zero-initialised, so it cannot rank logits)
+//   insertion : the same insertion into a sorted array, generalised to K
+//   topk      : TopK::Select, SIMD threshold pre-filter plus a min-heap
+//
+// on softmax probabilities and on raw logits, for 1000 (ImageNet-1k) and
+// 21843 (ImageNet-21k) classes, and checks that all methods agree.
+//
+// A second table compares the cost of reporting top-k softmax
+// probabilities from logits: materialising the full softmax and selecting
+// from it, against Activation (top-k on the logits plus one log-sum-exp).
+//
+// A third table times top-k on quantised outputs (uint8/int8, ranked on the
+// integers, only the winners dequantised) against dequantising the whole
+// int8 output to float first and selecting from that.
+//
+//   top_k_bench [--iterations N] [--k K]...
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "activation.h"
+#include "top_k.h"
+
+namespace {
+
+template <typename F>
+double NanosPerRun(int iterations, F&& f) {
+  f();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) { f(); }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+void Cascade(const float* data, int out_width, int* max_id, float* max_val) {
+  for (int i = 0; i < 5; i++) { max_id[i] = 0; max_val[i] = 0; }
+  for (int i = 0; i < out_width; i++) {
+    if (max_val[0] < *(data + i)) {
+      max_val[4] = max_val[3], max_id[4] = max_id[3];
+      max_val[3] = max_val[2], max_id[3] = max_id[2];
+      max_val[2] = max_val[1], max_id[2] = max_id[1];
+      max_val[1] = max_val[0], max_id[1] = max_id[0];
+      max_val[0] = *(data + i), max_id[0] = i;
+    } else if (max_val[1] < *(data + i)) {
+      max_val[4] = max_val[3], max_id[4] = max_id[3];
+      max_val[3] = max_val[2], max_id[3] = max_id[2];
+      max_val[2] = max_val[1], max_id[2] = max_id[1];
+      max_val[1] = *(data + i), max_id[1] = i;
+    } else if (max_val[2] < *(data + i)) {
+      max_val[4] = max_val[3], max_id[4] = max_id[3];
+      max_val[3] = max_val[2], max_id[3] = max_id[2];
+      max_val[2] = *(data + i), max_id[2] = i;
+    } else if (max_val[3] < *(data + i)) {
+      max_val[4] = max_val[3], max_id[4] = max_id[3];
+      max_val[3] = *(data + i), max_id[3] = i;
+    } else if (max_val[4] < *(data + i)) {
+      max_val[4] = *(data + i), max_id[4] = i;
+    }
+  }
+}
+
+size_t Insertion(const float* data, size_t width, size_t k, TopK::Entry* out) {
+  size_t n = 0;
+  for (size_t i = 0; i < width; i++) {
+    if (n == k && !(data[i] > out[n - 1].value)) { continue; }
+    size_t j = n < k ? n++ : n - 1;
+    for (; j > 0 && out[j - 1].value < data[i]; j--) { out[j] = out[j - 1]; }
+    out[j] = {static_cast<int>(i), data[i]};
+  }
+  return n;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = 2000;
+  std::vector<size_t> ks;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--iterations" && i + 1 < argc) {
+      iterations = std::max(1, atoi(argv[++i]));
+    } else if (arg == "--k" && i + 1 < argc) {
+      ks.push_back(static_cast<size_t>(std::max(1, atoi(argv[++i]))));
+    } else {
+      fprintf(stderr, "usage: %s [--iterations N] [--k K]...\n", argv[0]);
+      return 2;
+    }
+  }
+  if (ks.empty()) { ks = {5, 20}; }
+
+  std::mt19937 rng(1);
+  printf("%-7s %-6s %4s %12s %12s %12s %8s %6s\n", "classes", "scores", "k", "cascade ns", "insert ns", "topk ns", "speedup", "agree");
+  for (size_t width : {size_t(1000), size_t(21843)}) {
+    for (bool logits : {false, true}) {
+      std::normal_distribution<float> dist(0.0f, 3.0f);
+      std::vector<float> data(width);
+      for (auto& v : data) { v = dist(rng); }
+      if (!logits) {
+        float max_v = *std::max_element(data.begin(), data.end());
+        double sum = 0;
+        for (auto& v : data) { v = std::exp(v - max_v); sum += v; }
+        for (auto& v : data) { v = static_cast<float>(v / sum); }
+      }
+
+      for (size_t k : ks) {
+        std::vector<TopK::Entry> expected(k), actual(k);
+        double insert_ns = NanosPerRun(iterations, [&] { Insertion(data.data(), width, k, expected.data()); });
+        double topk_ns = NanosPerRun(iterations, [&] { TopK::Select(data.data(), width, k, actual.data()); });
+        bool agree = true;
+        for (size_t i = 0; i < k; i++) { agree &= expected[i].id == actual[i].id; }
+
+        std::string cascade = "n/a";
+        if (k == 5) {
+          int max_id[5];
+          float max_val[5];
+          double cascade_ns = NanosPerRun(iterations, [&] { Cascade(data.data(), static_cast<int>(width), max_id, max_val); });
+          char buffer[32];
+          snprintf(buffer, sizeof(buffer), "%.0f", cascade_ns);
+          cascade = buffer;
+          for (size_t i = 0; i < k; i++) { agree &= logits || max_id[i] == actual[i].id; }
+        }
+
+        printf("%-7zu %-6s %4zu %12s %12.0f %12.0f %7.1fx %6s\n", width, logits ? "logit" : "prob", k,
+               cascade.c_str(), insert_ns, topk_ns, insert_ns / topk_ns, agree ? "yes" : "NO");
+      }
+    }
+  }
+
+  printf("\n%-7s %4s %12s %12s %8s %10s\n", "classes", "k", "full ns", "lse ns", "speedup", "max error");
+  for (size_t width : {size_t(1000), size_t(21843)}) {
+    std::normal_distribution<float> dist(0.0f, 3.0f);
+    std::vector<float> data(width), prob(width);
+    for (auto& v : data) { v = dist(rng); }
+
+    for (size_t k : ks) {
+      std::vector<TopK::Entry> expected(k), actual(k);
+      double full_ns = NanosPerRun(iterations, [&] {
+        float max_v = *std::max_element(data.begin(), data.end());
+        float sum = 0;
+        for (size_t i = 0; i < width; i++) { prob[i] = std::exp(data[i] - max_v); sum += prob[i]; }
+        for (auto& v : prob) { v /= sum; }
+        TopK::Select(prob.data(), width, k, expected.data());
+      });
+      double lse_ns = NanosPerRun(iterations, [&] {
+        size_t n = TopK::Select(data.data(), width, k, actual.data());
+        Activation::Apply(Activation::Type::eSoftmax, data.data(), width, actual.data(), n);
+      });
+      float max_error = 0;
+      for (size_t i = 0; i < k; i++) { max_error = std::max(max_error, std::fabs(expected[i].value - actual[i].value)); }
+      printf("%-7zu %4zu %12.0f %12.0f %7.1fx %10.2g\n", width, k, full_ns, lse_ns, full_ns / lse_ns, max_error);
+    }
+  }
+
+  printf("\n%-7s %4s %12s %12s %12s %6s\n", "classes", "k", "dequant ns", "uint8 ns", "int8 ns", "agree");
+  for (size_t width : {size_t(1000), size_t(21843)}) {
+    std::normal_distribution<float> dist(0.0f, 3.0f);
+    std::vector<float> dequantized(width);
+    std::vector<uint8_t> u8(width);
+    std::vector<int8_t> s8(width);
+    for (size_t i = 0; i < width; i++) {
+      // logits at scale 1/8: uint8 with zero point 128, int8 with 0
+      int q = std::min(127, std::max(-128, static_cast<int>(std::lround(dist(rng) * 8.0f))));
+      s8[i] = static_cast<int8_t>(q);
+      u8[i] = static_cast<uint8_t>(q + 128);
+    }
+
+    for (size_t k : ks) {
+      std::vector<TopK::Entry> f(k), u(k), i8(k);
+      double float_ns = NanosPerRun(iterations, [&] {
+        for (size_t i = 0; i < width; i++) { dequantized[i] = s8[i] * 0.125f; }
+        TopK::Select(dequantized.data(), width, k, f.data());
+      });
+      double u8_ns = NanosPerRun(iterations, [&] { TopK::Select(u8.data(), width, k, u.data()); });
+      double s8_ns = NanosPerRun(iterations, [&] { TopK::Select(s8.data(), width, k, i8.data()); });
+      bool agree = true;
+      for (size_t i = 0; i < k; i++) { agree &= f[i].id == u[i].id && f[i].id == i8[i].id; }
+      printf("%-7zu %4zu %12.0f %12.0f %12.0f %6s\n", width, k, float_ns, u8_ns, s8_ns, agree ? "yes" : "NO");
+    }
+  }
+  return 0;
+}
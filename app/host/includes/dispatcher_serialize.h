@@ -0,0 +1,4 @@
+#pragma once
+
+#include "host_component.h"
+#include "host_json.h"
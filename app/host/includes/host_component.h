@@ -0,0 +1,211 @@
+#pragma once
+
+// Host stand-in for the SDK component framework: BaseObject, Event, blob
+// arguments, attribute (de)serialisation and the Component base class.
+// Events sent by a component are routed through HostEventBus so that a host
+// driver can play the part of MetadataManager, AppDispatcher, etc.
+
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "host_json.h"
+
+typedef uint64_t ClassID;
+typedef std::string String;
+template <typename T>
+using Vector = std::vector<T>;
+
+// The SDK tags every allocation with a short label for its memory tracker.
+void* operator new(std::size_t size, const char* tag);
+void operator delete(void* ptr, const char* tag) noexcept;
+
+class Log {
+ public:
+  static void Print(const char* format, ...);
+};
+
+class Exception : public std::exception {
+ public:
+  Exception(ClassID id, const std::string& message) : id_(id), message_(message) {}
+  uint64_t GetClassId() const { return id_; }
+  const char* what() const noexcept override { return message_.c_str(); }
+
+ private:
+  ClassID id_;
+  std::string message_;
+};
+
+class BaseObject {
+ public:
+  virtual ~BaseObject() {}
+};
+
+namespace Platform_Std_Refine {
+class SerializableString : public BaseObject {
+ public:
+  explicit SerializableString(const char* str) : str_(str ? str : "") {}
+  const std::string& GetString() const { return str_; }
+
+ private:
+  std::string str_;
+};
+}  // namespace Platform_Std_Refine
+
+namespace Base64 {
+std::pair<std::unique_ptr<char[]>, size_t> encode(const char* data, size_t size);
+std::pair<std::unique_ptr<char[]>, size_t> decode(const char* data, size_t size);
+}  // namespace Base64
+
+// Stand-in for the shared-buffer handle carried by eVideoRawData events.
+// Copies share the underlying buffer; ClearResource() drops this handle's
+// reference and the release hook runs once the last reference is gone.
+class Blob {
+ public:
+  Blob() {}
+  Blob(const void* data, uint64_t size, std::function<void()> release);
+
+  void* GetRawData() const { return resource_ ? resource_->data : nullptr; }
+  uint64_t GetSize() const { return resource_ ? resource_->size : 0; }
+  bool IsValid() const { return resource_ != nullptr; }
+  void ClearResource() { resource_.reset(); }
+
+ private:
+  struct Resource {
+    void* data = nullptr;
+    uint64_t size = 0;
+    std::function<void()> release;
+    ~Resource() {
+      if (release) { release(); }
+    }
+  };
+  std::shared_ptr<Resource> resource_;
+};
+
+struct HostMemManager {
+  HostMemManager(void* mem_manager = nullptr) : handle(mem_manager) {}
+  void* handle;
+};
+
+class Event {
+ public:
+  static HostMemManager allocator;
+
+  Event(int32_t type, BaseObject* argument, bool is_reply = false);
+  Event(int32_t type, const Blob& blob);
+  ~Event();
+
+  int32_t GetType() const { return type_; }
+  bool IsReply() const { return is_reply_; }
+  BaseObject* GetBaseObjectArgument() const { return argument_; }
+  Blob GetBlobArgument() const { return blob_; }
+  // Detaches the argument and blob from the event; the receiver now owns them.
+  void ClearBaseObjectArgument();
+
+ private:
+  int32_t type_;
+  bool is_reply_;
+  BaseObject* argument_;
+  Blob blob_;
+};
+
+namespace ComponentInterface {
+enum class EProtocolEventType : int32_t {
+  eSet = 0x100,
+  eGet,
+  eRemove,
+};
+}  // namespace ComponentInterface
+
+struct SerializerAttribute {
+  std::string value;
+};
+
+class SerializableJson : public BaseObject {
+ public:
+  virtual std::string Serialize(const std::string& groupName, std::map<std::string, SerializerAttribute>& _keyValueMap, std::string version) = 0;
+  virtual bool Deserialize(const std::string& inputString, const std::string& groupName, std::map<std::string, SerializerAttribute>& _keyValueMap) = 0;
+  virtual bool WriteFile(const std::string& filename, const std::string& groupName, std::string& outputString);
+
+ protected:
+  size_t sizeOfThis = 0;
+};
+
+// Routes events sent by components to host-side receivers by name.
+class HostEventBus {
+ public:
+  using Handler = std::function<void(int32_t type, BaseObject* argument)>;
+
+  static HostEventBus& Instance();
+
+  void Subscribe(const std::string& receiver, Handler handler);
+  void Unsubscribe(const std::string& receiver);
+  // Returns false when nobody listens on the receiver name.
+  bool Deliver(const std::string& receiver, int32_t type, BaseObject* argument);
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, Handler> handlers_;
+};
+
+// What the life cycle manager reads from *_manifest_instance_0.json.
+struct HostInstanceConfig {
+  std::string instance_name = "Classification";
+  int channel = 0;
+  std::string model_path = "../res/models/";
+  std::string setting_path = "../storage/settings/";
+  std::string version = "1.0.0";
+};
+
+class Component : public BaseObject {
+ public:
+  static HostMemManager allocator;
+
+  Component(ClassID id, const char* name);
+  virtual ~Component();
+
+  virtual bool ProcessAEvent(Event* event);
+
+  // Host driver entry points standing in for the life cycle manager.
+  void HostConfigure(const HostInstanceConfig& config) { config_ = config; }
+  bool HostInitialize() { return Initialize(); }
+  void HostStart() { Start(); }
+  bool HostFinalize() { return Finalize(); }
+
+  ClassID GetClassId() const { return id_; }
+  const std::string& GetObjectName() const { return name_; }
+  const std::string& GetInstanceName() const { return config_.instance_name; }
+  int GetChannel() const { return config_.channel; }
+
+ protected:
+  virtual bool Initialize() { return true; }
+  virtual void Start() {}
+  virtual bool Finalize() { return true; }
+
+  std::string GetStringComponentVersion() const { return config_.version; }
+  bool PrepareAttributes(SerializableJson* attributes, const std::string& group_name);
+  bool WriteAttributes(SerializableJson* attributes, const std::string& group_name);
+  JsonUtility::JsonDocument PrepareJson() const { return JsonUtility::JsonDocument(rapidjson::kObjectType); }
+
+  void SendNoReplyEvent(const std::string& receiver, int32_t type, int32_t option, BaseObject* argument);
+  void SendTargetEvents(const std::string& group, int32_t type, int32_t option, BaseObject* argument);
+
+ private:
+  ClassID id_;
+  std::string name_;
+  HostInstanceConfig config_;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+// Synthetic camera for host runs: renders deterministic NV12 substreams into
+// a ring of shared buffers and hands them out as eVideoRawData blobs in the
+// same layout IPLVideoFrameRaw deserializes.
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "host_component.h"
+#include "tensor.h"
+
+struct HostFrameHeader {
+  static constexpr uint32_t kMagic = 0x57524146;  // "FARW"
+  uint32_t magic;
+  uint32_t image_count;
+  uint64_t pts;
+};
+
+struct HostImageHeader {
+  uint32_t width;
+  uint32_t height;
+  uint32_t stride;
+  uint32_t format;
+  uint64_t offset;  // from the start of the blob
+  uint64_t size;
+};
+
+class HostFrameSource {
+ public:
+  struct Stream {
+    uint32_t width;
+    uint32_t height;
+  };
+
+  // |streams| largest first, like the SDK substream chain. |distinct_frames|
+  // pattern phases are pre-rendered and cycled.
+  HostFrameSource(const std::vector<Stream>& streams, uint32_t fps = 30, uint32_t distinct_frames = 8);
+  ~HostFrameSource();
+
+  // Next frame; pts advances by 1000 / fps milliseconds.
+  Blob NextFrame();
+  // Wraps the blob in an event the way SPMgrVideoRaw delivers it.
+  Event* NextEvent();
+
+  uint64_t FramesProduced() const;
+  // Blobs handed out whose resource has not been cleared yet.
+  uint64_t FramesInFlight() const;
+  size_t FrameBytes() const { return frame_bytes_; }
+
+ private:
+  struct Slot {
+    std::vector<uint8_t> data;
+    uint32_t phase = 0;
+    bool in_use = false;
+  };
+  // Shared with the blob release hooks, which may outlive the source.
+  struct State {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Slot>> slots;
+    uint64_t produced = 0;
+    uint64_t released = 0;
+  };
+
+  void Render(std::vector<uint8_t>& data, uint32_t phase) const;
+
+  std::vector<Stream> streams_;
+  uint32_t period_ms_;
+  uint32_t distinct_frames_;
+  size_t frame_bytes_ = 0;
+  uint64_t pts_ = 0;
+  std::shared_ptr<State> state_;
+};
@@ -0,0 +1,437 @@
+#pragma once
+
+// Host stand-in for the subset of rapidjson / JsonUtility that the SDK
+// re-exports. Only the calls made by the application are provided; the
+// allocator is stateless because values own their storage.
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rapidjson {
+
+typedef unsigned SizeType;
+
+enum Type {
+  kNullType = 0,
+  kFalseType = 1,
+  kTrueType = 2,
+  kObjectType = 3,
+  kArrayType = 4,
+  kStringType = 5,
+  kNumberType = 6
+};
+
+enum ParseErrorCode {
+  kParseErrorNone = 0,
+  kParseErrorDocumentEmpty,
+  kParseErrorDocumentRootNotSingular,
+  kParseErrorValueInvalid,
+  kParseErrorObjectMissName,
+  kParseErrorObjectMissColon,
+  kParseErrorObjectMissCommaOrCurlyBracket,
+  kParseErrorArrayMissCommaOrSquareBracket,
+  kParseErrorStringInvalidEscape,
+  kParseErrorStringMissQuotationMark,
+  kParseErrorNumberMissExponent
+};
+
+struct ParseResult {
+  ParseResult() : code_(kParseErrorNone), offset_(0) {}
+  ParseResult(ParseErrorCode code, size_t offset) : code_(code), offset_(offset) {}
+
+  ParseErrorCode Code() const { return code_; }
+  size_t Offset() const { return offset_; }
+  bool IsError() const { return code_ != kParseErrorNone; }
+  operator bool() const { return !IsError(); }
+
+ private:
+  ParseErrorCode code_;
+  size_t offset_;
+};
+
+class MemoryPoolAllocator {};
+
+class StringBuffer {
+ public:
+  void Put(char c) { buffer_.push_back(c); }
+  void Puts(const char* s, size_t n) { buffer_.append(s, n); }
+  void Clear() { buffer_.clear(); }
+  const char* GetString() const { return buffer_.c_str(); }
+  size_t GetSize() const { return buffer_.size(); }
+
+ private:
+  std::string buffer_;
+};
+
+class Value;
+
+struct Member {
+  Member(Value&& n, Value&& v);
+  Member(Member&& other) noexcept;
+  Member& operator=(Member&& other) noexcept;
+  ~Member();
+
+  std::unique_ptr<Value> name_ptr;
+  std::unique_ptr<Value> value_ptr;
+  Value& name;
+  Value& value;
+};
+
+class Value {
+ public:
+  typedef MemoryPoolAllocator AllocatorType;
+  typedef std::vector<Member>::iterator MemberIterator;
+  typedef std::vector<Member>::const_iterator ConstMemberIterator;
+  typedef Value* ValueIterator;
+  typedef const Value* ConstValueIterator;
+
+  template <typename It>
+  struct Range {
+    It b, e;
+    It begin() const { return b; }
+    It end() const { return e; }
+    SizeType Size() const { return static_cast<SizeType>(e - b); }
+  };
+
+  Value() : type_(kNullType) {}
+  explicit Value(Type type) : type_(type) {}
+  Value(const char* s, AllocatorType&) : type_(kStringType), string_(s) {}
+  Value(const std::string& s, AllocatorType&) : type_(kStringType), string_(s) {}
+  explicit Value(bool b) : type_(b ? kTrueType : kFalseType) {}
+  explicit Value(int i) : type_(kNumberType), num_kind_(kInt), i64_(i), d_(i) {}
+  explicit Value(unsigned u) : type_(kNumberType), num_kind_(kUint), u64_(u), d_(u) {}
+  explicit Value(int64_t i) : type_(kNumberType), num_kind_(kInt), i64_(i), d_(static_cast<double>(i)) {}
+  explicit Value(uint64_t u) : type_(kNumberType), num_kind_(kUint), u64_(u), d_(static_cast<double>(u)) {}
+  explicit Value(double d) : type_(kNumberType), num_kind_(kDouble), d_(d) {}
+
+  Value(const Value&) = delete;
+  Value(Value&& other) noexcept = default;
+  Value& operator=(Value&& other) noexcept = default;
+  // rapidjson assigns with move semantics from an lvalue.
+  Value& operator=(Value& other) noexcept { return *this = std::move(other); }
+
+  Type GetType() const { return type_; }
+  bool IsNull() const { return type_ == kNullType; }
+  bool IsBool() const { return type_ == kTrueType || type_ == kFalseType; }
+  bool IsTrue() const { return type_ == kTrueType; }
+  bool IsFalse() const { return type_ == kFalseType; }
+  bool IsObject() const { return type_ == kObjectType; }
+  bool IsArray() const { return type_ == kArrayType; }
+  bool IsString() const { return type_ == kStringType; }
+  bool IsNumber() const { return type_ == kNumberType; }
+  bool IsInt() const;
+  bool IsUint() const;
+  bool IsInt64() const;
+  bool IsUint64() const;
+  bool IsDouble() const { return IsNumber() && num_kind_ == kDouble; }
+
+  bool GetBool() const { return type_ == kTrueType; }
+  int GetInt() const { return static_cast<int>(GetInt64()); }
+  unsigned GetUint() const { return static_cast<unsigned>(GetUint64()); }
+  int64_t GetInt64() const;
+  uint64_t GetUint64() const;
+  double GetDouble() const { return IsNumber() ? d_ : 0.0; }
+  float GetFloat() const { return static_cast<float>(GetDouble()); }
+  const char* GetString() const { return IsString() ? string_.c_str() : ""; }
+  SizeType GetStringLength() const { return static_cast<SizeType>(string_.size()); }
+
+  Value& SetObject();
+  Value& SetArray();
+  Value& SetNull() { *this = Value(); return *this; }
+  Value& SetString(const char* s, SizeType length, AllocatorType&);
+  Value& SetString(const std::string& s, AllocatorType& a) { return SetString(s.c_str(), static_cast<SizeType>(s.size()), a); }
+  Value& SetInt(int i) { *this = Value(i); return *this; }
+  Value& SetUint(unsigned u) { *this = Value(u); return *this; }
+  Value& SetInt64(int64_t i) { *this = Value(i); return *this; }
+  Value& SetUint64(uint64_t u) { *this = Value(u); return *this; }
+  Value& SetDouble(double d) { *this = Value(d); return *this; }
+  Value& SetBool(bool b) { *this = Value(b); return *this; }
+
+  // object
+  bool HasMember(const char* name) const { return FindMember(name) != MemberEnd(); }
+  MemberIterator FindMember(const char* name);
+  ConstMemberIterator FindMember(const char* name) const;
+  MemberIterator MemberBegin() { return members_.begin(); }
+  MemberIterator MemberEnd() { return members_.end(); }
+  ConstMemberIterator MemberBegin() const { return members_.begin(); }
+  ConstMemberIterator MemberEnd() const { return members_.end(); }
+  SizeType MemberCount() const { return static_cast<SizeType>(members_.size()); }
+  Value& operator[](const char* name);
+  const Value& operator[](const char* name) const;
+  Value& operator[](const std::string& name) { return (*this)[name.c_str()]; }
+  Value& AddMember(Value& name, Value& value, AllocatorType&);
+  Value& AddMember(Value&& name, Value&& value, AllocatorType& a) { return AddMember(name, value, a); }
+  Value& AddMember(Value&& name, Value& value, AllocatorType& a) { return AddMember(name, value, a); }
+  Value& AddMember(Value& name, Value&& value, AllocatorType& a) { return AddMember(name, value, a); }
+  Value& AddMember(const char* name, Value& value, AllocatorType& a);
+  Value& AddMember(const char* name, Value&& value, AllocatorType& a) { return AddMember(name, value, a); }
+  Value& AddMember(const char* name, const std::string& value, AllocatorType& a);
+  Value& AddMember(const char* name, const char* value, AllocatorType& a) { return AddMember(name, std::string(value), a); }
+  Value& AddMember(const char* name, int value, AllocatorType& a) { return AddMember(name, Value(value), a); }
+  Value& AddMember(const char* name, unsigned value, AllocatorType& a) { return AddMember(name, Value(value), a); }
+  Value& AddMember(const char* name, int64_t value, AllocatorType& a) { return AddMember(name, Value(value), a); }
+  Value& AddMember(const char* name, uint64_t value, AllocatorType& a) { return AddMember(name, Value(value), a); }
+  Value& AddMember(const char* name, double value, AllocatorType& a) { return AddMember(name, Value(value), a); }
+  Value& AddMember(const char* name, bool value, AllocatorType& a) { return AddMember(name, Value(value), a); }
+  bool RemoveMember(const char* name);
+  Range<MemberIterator> GetObject() { return {members_.begin(), members_.end()}; }
+  Range<ConstMemberIterator> GetObject() const { return {members_.begin(), members_.end()}; }
+
+  // array
+  SizeType Size() const { return static_cast<SizeType>(elements_.size()); }
+  bool Empty() const { return elements_.empty(); }
+  void Clear() { elements_.clear(); members_.clear(); }
+  void Reserve(SizeType n, AllocatorType&) { elements_.reserve(n); }
+  Value& operator[](SizeType index) { return elements_[index]; }
+  const Value& operator[](SizeType index) const { return elements_[index]; }
+  Value& operator[](int index) { return elements_[static_cast<size_t>(index)]; }
+  const Value& operator[](int index) const { return elements_[static_cast<size_t>(index)]; }
+  Value& PushBack(Value& value, AllocatorType&);
+  Value& PushBack(Value&& value, AllocatorType& a) { return PushBack(value, a); }
+  ValueIterator Begin() { return elements_.data(); }
+  ValueIterator End() { return elements_.data() + elements_.size(); }
+  ConstValueIterator Begin() const { return elements_.data(); }
+  ConstValueIterator End() const { return elements_.data() + elements_.size(); }
+  Range<ValueIterator> GetArray() { return {Begin(), End()}; }
+  Range<ConstValueIterator> GetArray() const { return {Begin(), End()}; }
+
+  template <typename Handler>
+  bool Accept(Handler& handler) const;
+
+ protected:
+  enum NumberKind { kInt, kUint, kDouble };
+
+  Type type_;
+  NumberKind num_kind_ = kInt;
+  int64_t i64_ = 0;
+  uint64_t u64_ = 0;
+  double d_ = 0.0;
+  std::string string_;
+  std::vector<Member> members_;
+  std::vector<Value> elements_;
+};
+
+class Document : public Value {
+ public:
+  typedef MemoryPoolAllocator AllocatorType;
+
+  Document() : Value() {}
+  explicit Document(Type type) : Value(type) {}
+  Document(Document&&) noexcept = default;
+  Document& operator=(Document&&) noexcept = default;
+
+  AllocatorType& GetAllocator() { return allocator_; }
+
+  Document& Parse(const char* json, size_t length);
+  Document& Parse(const char* json) { return Parse(json, std::strlen(json)); }
+  Document& Parse(const std::string& json) { return Parse(json.c_str(), json.size()); }
+
+  bool HasParseError() const { return parse_result_.IsError(); }
+  ParseErrorCode GetParseError() const { return parse_result_.Code(); }
+  size_t GetErrorOffset() const { return parse_result_.Offset(); }
+  operator ParseResult() const { return parse_result_; }
+
+ private:
+  AllocatorType allocator_;
+  ParseResult parse_result_;
+};
+
+template <typename OutputStream>
+class Writer {
+ public:
+  explicit Writer(OutputStream& os) : os_(os) {}
+  virtual ~Writer() {}
+
+  bool Null() { Prefix(); Write("null"); return true; }
+  bool Bool(bool b) { Prefix(); Write(b ? "true" : "false"); return true; }
+  bool Int(int i) { return Int64(i); }
+  bool Uint(unsigned u) { return Uint64(u); }
+  bool Int64(int64_t i) { Prefix(); Write(std::to_string(i)); return true; }
+  bool Uint64(uint64_t u) { Prefix(); Write(std::to_string(u)); return true; }
+  bool Double(double d);
+  bool String(const char* s, SizeType length);
+  bool Key(const char* s, SizeType length) { return String(s, length); }
+  bool StartObject() { Prefix(); os_.Put('{'); levels_.push_back({false, 0}); return true; }
+  bool EndObject() { return End('}'); }
+  bool StartArray() { Prefix(); os_.Put('['); levels_.push_back({true, 0}); return true; }
+  bool EndArray() { return End(']'); }
+
+ protected:
+  struct Level {
+    bool in_array;
+    size_t count;
+  };
+
+  virtual void Indent() {}
+  virtual void KeySeparator() {}
+
+  void Write(const std::string& s) { os_.Puts(s.data(), s.size()); }
+  void Write(const char* s) { os_.Puts(s, std::strlen(s)); }
+  void Prefix();
+  bool End(char c);
+
+  OutputStream& os_;
+  std::vector<Level> levels_;
+};
+
+template <typename OutputStream>
+class PrettyWriter : public Writer<OutputStream> {
+ public:
+  explicit PrettyWriter(OutputStream& os) : Writer<OutputStream>(os) {}
+
+ protected:
+  void Indent() override {
+    this->os_.Put('\n');
+    for (size_t i = 0; i < this->levels_.size() * 4; i++) {
+      this->os_.Put(' ');
+    }
+  }
+  void KeySeparator() override { this->os_.Put(' '); }
+};
+
+// ---------------------------------------------------------------------------
+
+inline Member::Member(Value&& n, Value&& v)
+    : name_ptr(new Value(std::move(n))), value_ptr(new Value(std::move(v))), name(*name_ptr), value(*value_ptr) {}
+inline Member::Member(Member&& other) noexcept
+    : name_ptr(std::move(other.name_ptr)), value_ptr(std::move(other.value_ptr)), name(*name_ptr), value(*value_ptr) {}
+inline Member& Member::operator=(Member&& other) noexcept {
+  *name_ptr = std::move(*other.name_ptr);
+  *value_ptr = std::move(*other.value_ptr);
+  return *this;
+}
+inline Member::~Member() = default;
+
+template <typename OutputStream>
+void Writer<OutputStream>::Prefix() {
+  if (levels_.empty()) { return; }
+  Level& level = levels_.back();
+  if (level.in_array) {
+    if (level.count++ > 0) { os_.Put(','); }
+    Indent();
+  } else {
+    // members alternate key, value
+    if (level.count % 2 == 0) {
+      if (level.count > 0) { os_.Put(','); }
+      Indent();
+    } else {
+      os_.Put(':');
+      KeySeparator();
+    }
+    level.count++;
+  }
+}
+
+template <typename OutputStream>
+bool Writer<OutputStream>::End(char c) {
+  bool empty = levels_.back().count == 0;
+  levels_.pop_back();
+  if (!empty) { Indent(); }
+  os_.Put(c);
+  return true;
+}
+
+template <typename OutputStream>
+bool Writer<OutputStream>::Double(double d) {
+  Prefix();
+  char buf[32];
+  int n = snprintf(buf, sizeof(buf), "%.17g", d);
+  // keep the value recognisable as a floating point number on re-parse
+  if (strpbrk(buf, ".eEni") == nullptr && n + 2 < static_cast<int>(sizeof(buf))) {
+    buf[n++] = '.';
+    buf[n++] = '0';
+    buf[n] = '\0';
+  }
+  Write(buf);
+  return true;
+}
+
+template <typename OutputStream>
+bool Writer<OutputStream>::String(const char* s, SizeType length) {
+  Prefix();
+  os_.Put('"');
+  for (SizeType i = 0; i < length; i++) {
+    unsigned char c = static_cast<unsigned char>(s[i]);
+    switch (c) {
+      case '"': Write("\\\""); break;
+      case '\\': Write("\\\\"); break;
+      case '\b': Write("\\b"); break;
+      case '\f': Write("\\f"); break;
+      case '\n': Write("\\n"); break;
+      case '\r': Write("\\r"); break;
+      case '\t': Write("\\t"); break;
+      default:
+        if (c < 0x20) {
+          char esc[8];
+          snprintf(esc, sizeof(esc), "\\u%04x", c);
+          Write(esc);
+        } else {
+          os_.Put(static_cast<char>(c));
+        }
+        break;
+    }
+  }
+  os_.Put('"');
+  return true;
+}
+
+template <typename Handler>
+bool Value::Accept(Handler& handler) const {
+  switch (type_) {
+    case kNullType: return handler.Null();
+    case kFalseType: return handler.Bool(false);
+    case kTrueType: return handler.Bool(true);
+    case kStringType: return handler.String(string_.c_str(), static_cast<SizeType>(string_.size()));
+    case kNumberType:
+      if (num_kind_ == kDouble) { return handler.Double(d_); }
+      if (num_kind_ == kUint) { return handler.Uint64(u64_); }
+      return handler.Int64(i64_);
+    case kObjectType:
+      handler.StartObject();
+      for (const auto& m : members_) {
+        handler.Key(m.name.GetString(), m.name.GetStringLength());
+        m.value.Accept(handler);
+      }
+      return handler.EndObject();
+    case kArrayType:
+      handler.StartArray();
+      for (const auto& e : elements_) {
+        e.Accept(handler);
+      }
+      return handler.EndArray();
+  }
+  return false;
+}
+
+}  // namespace rapidjson
+
+namespace JsonUtility {
+
+typedef rapidjson::Document JsonDocument;
+typedef rapidjson::Value ValueType;
+typedef rapidjson::Type Type;
+
+void set(ValueType& object, const char* key, const std::string& value, JsonDocument::AllocatorType& alloc);
+void set(ValueType& object, const char* key, const char* value, JsonDocument::AllocatorType& alloc);
+void set(ValueType& object, const char* key, int value, JsonDocument::AllocatorType& alloc);
+void set(ValueType& object, const char* key, unsigned value, JsonDocument::AllocatorType& alloc);
+void set(ValueType& object, const char* key, int64_t value, JsonDocument::AllocatorType& alloc);
+void set(ValueType& object, const char* key, uint64_t value, JsonDocument::AllocatorType& alloc);
+void set(ValueType& object, const char* key, double value, JsonDocument::AllocatorType& alloc);
+void set(ValueType& object, const char* key, bool value, JsonDocument::AllocatorType& alloc);
+
+bool get(const ValueType& object, const char* key, std::string& value);
+bool get(const ValueType& object, const char* key, int& value);
+bool get(const ValueType& object, const char* key, unsigned& value);
+bool get(const ValueType& object, const char* key, int64_t& value);
+bool get(const ValueType& object, const char* key, uint64_t& value);
+bool get(const ValueType& object, const char* key, double& value);
+bool get(const ValueType& object, const char* key, float& value);
+bool get(const ValueType& object, const char* key, bool& value);
+
+}  // namespace JsonUtility
+
+bool getJsonString(const JsonUtility::ValueType& value, std::string& out);
@@ -0,0 +1,40 @@
+#pragma once
+
+// Plays MetadataManager for host runs: collects the StringMetadata documents
+// a component sends with eRequestRawMetadata, per channel, since the
+// components of every channel in the process send them to the one receiver.
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "i_p_metadata_manager.h"
+
+class HostMetadataSink {
+ public:
+  explicit HostMetadataSink(const std::string& receiver = "MetadataManager");
+  ~HostMetadataSink();
+
+  uint64_t Count(int channel = 0) const;
+  uint64_t Bytes(int channel = 0) const;
+  std::string Last(int channel = 0) const;
+  uint64_t LastTimestamp(int channel = 0) const;
+  // pts must never go backwards on one channel; checked for all of them
+  bool InOrder() const;
+
+ private:
+  struct Channel {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+    std::string last;
+    uint64_t last_timestamp = 0;
+  };
+
+  void OnEvent(int32_t type, BaseObject* argument);
+  const Channel* Find(int channel) const;
+
+  std::string receiver_;
+  mutable std::mutex mutex_;
+  std::map<int, Channel> channels_;
+  bool in_order_ = true;
+};
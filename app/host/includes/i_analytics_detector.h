@@ -0,0 +1,3 @@
+#pragma once
+
+#include "typedef_analytics_detector.h"
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "host_component.h"
+
+class IAppDispatcher {
+ public:
+  enum class EEventType : int32_t {
+    eHttpRequest = 0x200,
+    eHttpResponse,
+    eRegisterCommand,
+  };
+
+  class OpenAPIRegistrar : public BaseObject {
+   public:
+    OpenAPIRegistrar(const String& uri, const String& instance_name, const Vector<String>& methods)
+        : uri_(uri), instance_name_(instance_name), methods_(methods) {}
+    const String& GetUri() const { return uri_; }
+    const String& GetInstanceName() const { return instance_name_; }
+    const Vector<String>& GetMethods() const { return methods_; }
+
+   private:
+    String uri_;
+    String instance_name_;
+    Vector<String> methods_;
+  };
+};
+
+// HTTP request forwarded by AppDispatcher; the handler fills in the response.
+class OpenAppSerializable : public BaseObject {
+ public:
+  OpenAppSerializable(const std::string& path_info, const std::string& method, const std::string& body)
+      : method_(method), body_(body) {
+    params_["PATH_INFO"] = path_info;
+  }
+
+  String GetFCGXParam(const std::string& name) const {
+    auto it = params_.find(name);
+    return it != params_.end() ? it->second : String();
+  }
+  const String& GetMethod() const { return method_; }
+  const String& GetRequestBody() const { return body_; }
+
+  void SetStatusCode(int code) { status_code_ = code; }
+  void SetResponseBody(const std::string& body) { response_body_ = body; }
+  int GetStatusCode() const { return status_code_; }
+  const String& GetResponseBody() const { return response_body_; }
+
+ private:
+  std::map<std::string, String> params_;
+  String method_;
+  String body_;
+  int status_code_ = 200;
+  String response_body_;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "host_component.h"
+
+class ILogManager {
+ public:
+  static constexpr const char* remote_debug_message_group = "RemoteDebugMessage";
+  enum class EEvent : int32_t {
+    eRemoteDebugMessage = 0x600,
+  };
+};
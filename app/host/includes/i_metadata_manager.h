@@ -0,0 +1,26 @@
+#pragma once
+
+#include "host_component.h"
+
+class StringMetadata {
+ public:
+  StringMetadata(int channel, uint64_t timestamp) : channel_(channel), timestamp_(timestamp) {}
+
+  void Set(const std::string& data) { data_ = data; }
+  void Set(std::string&& data) { data_ = std::move(data); }
+  const std::string& Get() const { return data_; }
+  int GetChannel() const { return channel_; }
+  uint64_t GetTimestamp() const { return timestamp_; }
+
+ private:
+  int channel_;
+  uint64_t timestamp_;
+  std::string data_;
+};
+
+class IMetadataManager {
+ public:
+  enum class EEventType : int32_t {
+    eRequestRawMetadata = 0x400,
+  };
+};
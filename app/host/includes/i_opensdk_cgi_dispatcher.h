@@ -0,0 +1,11 @@
+#pragma once
+
+#include "host_component.h"
+
+class I_OpenSDKCGIDispatcher {
+ public:
+  enum class EEventType : int32_t {
+    eMetaFrameSchema = 0x500,
+    eMetaFrameCapability,
+  };
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "i_metadata_manager.h"
+
+class IPMetadataManager {
+ public:
+  class StringMetadataRequest : public BaseObject {
+   public:
+    StringMetadataRequest() : metadata_(0, 0) {}
+    void SetStringMetadata(StringMetadata&& metadata) { metadata_ = std::move(metadata); }
+    const StringMetadata& GetStringMetadata() const { return metadata_; }
+
+   private:
+    StringMetadata metadata_;
+  };
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "host_component.h"
+
+class IPStreamProviderManagerVideoRaw {
+ public:
+  enum class EEventType : int32_t {
+    eVideoRawData = 0x300,
+  };
+};
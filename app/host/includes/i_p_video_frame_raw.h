@@ -0,0 +1,17 @@
+#pragma once
+
+// Host stand-in for the raw video frame object carried by SPMgrVideoRaw.
+
+#include "host_component.h"
+#include "tensor.h"
+
+class IPVideoFrameRaw : public BaseObject {
+ public:
+  virtual ~IPVideoFrameRaw() {}
+
+  // Reads the frame held in |data| (the event blob). Image planes are not
+  // copied: the RawImage chain points into the blob, so it is only valid
+  // until the blob resource is cleared.
+  virtual bool DeserializeBaseObject(BaseObject* object, const std::pair<std::variant<BaseObject*, char*>, uint64_t>& data) = 0;
+  virtual RawImage* GetRawImage() = 0;
+};
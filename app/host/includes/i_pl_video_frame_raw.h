@@ -0,0 +1,3 @@
+#pragma once
+
+#include "i_p_video_frame_raw.h"
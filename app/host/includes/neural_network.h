@@ -0,0 +1,75 @@
+#pragma once
+
+// Host stand-in for the SDK NeuralNetwork API, backed by a small CPU
+// reference network (3x3 stride-2 convolution, ReLU, 8x8 average pool and a
+// dense classifier) whose weights are derived from the model file name, so
+// results are deterministic for a given model and input.
+//
+// Output tensors named "prob*" receive softmax probabilities, "det*" 16
+// detection rows of [x, y, width, height, score, class] (float32, top-left
+// box normalised to the input, score relative to the strongest box; see
+// DetectionDecoder), any other name receives raw logits.
+// HOST_NPU_LATENCY_US adds an off-CPU sleep to each run to model accelerator
+// time.
+//
+// HOST_NPU_BATCH=N models a network compiled for batch N: input tensors are
+// {224, 224, 3, N} (one CHW image per slot) and outputs {classes, N}, and a
+// RunNetwork call executes all N slots for a single HOST_NPU_LATENCY_US.
+//
+// HOST_NPU_OUTPUT=uint8|int8 leaves the outputs quantised, as an NPU without
+// output dequantisation does. real = (q - zero_point) * scale with
+//   prob*   : scale 1/255, zero point 0 (uint8) or -128 (int8)
+//   others  : scale 1/8,   zero point 128 (uint8) or 0 (int8)
+//
+// HOST_NPU_FAIL_EVERY=N makes every Nth run of a network fail, and
+// HOST_NPU_NAN_EVERY=N fills the float32 non-detection outputs of every Nth
+// run with NaN, as a corrupted accelerator result would.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensor.h"
+
+struct stat_t {
+  uint32_t pre_time;   // input conversion on the accelerator, usec
+  uint32_t run_time;   // network execution, usec
+  uint32_t post_time;  // output conversion, usec
+};
+
+class NeuralNetwork {
+ public:
+  static NeuralNetwork* Create();
+  virtual ~NeuralNetwork();
+
+  const std::shared_ptr<Tensor>& CreateInputTensor(const std::string& name);
+  const std::shared_ptr<Tensor>& CreateOutputTensor(const std::string& name);
+
+  bool LoadNetwork(const std::string& bin, const std::vector<float>& mean = {}, const std::vector<float>& scale = {});
+  bool RunNetwork(stat_t& stat);
+  void UnloadNetwork();
+
+  const std::shared_ptr<Tensor>& GetInputTensor(const std::string& name) const;
+  const std::shared_ptr<Tensor>& GetInputTensor(size_t index) const;
+  const std::shared_ptr<Tensor>& GetOutputTensor(const std::string& name) const;
+  const std::shared_ptr<Tensor>& GetOutputTensor(size_t index) const;
+  const std::vector<std::shared_ptr<Tensor>>& GetAllInputTensors() const { return inputs_; }
+  const std::vector<std::shared_ptr<Tensor>>& GetAllOutputTensors() const { return outputs_; }
+  size_t GetInputTensorCount() const { return inputs_.size(); }
+  size_t GetOutputTensorCount() const { return outputs_.size(); }
+
+ private:
+  NeuralNetwork() {}
+
+  std::vector<std::shared_ptr<Tensor>> inputs_;
+  std::vector<std::shared_ptr<Tensor>> outputs_;
+  std::vector<float> mean_;
+  std::vector<float> scale_;
+  std::vector<float> conv_weights_;
+  std::vector<float> fc_weights_;
+  std::vector<float> fc_bias_;
+  std::vector<float> scratch_;
+  std::vector<float> values_;  // one output slot before quantisation
+  bool loaded_ = false;
+  uint64_t runs_ = 0;  // RunNetwork calls since LoadNetwork
+};
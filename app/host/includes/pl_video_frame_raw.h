@@ -0,0 +1,17 @@
+#pragma once
+
+#include "i_pl_video_frame_raw.h"
+
+class IPLVideoFrameRaw : public IPVideoFrameRaw {
+ public:
+  IPLVideoFrameRaw() {}
+  ~IPLVideoFrameRaw() override;
+
+  bool DeserializeBaseObject(BaseObject* object, const std::pair<std::variant<BaseObject*, char*>, uint64_t>& data) override;
+  RawImage* GetRawImage() override { return head_; }
+
+ private:
+  void Release();
+
+  RawImage* head_ = nullptr;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+// Host stand-in for the SDK tensor API. Source tensors hold packed RGB888
+// converted from the camera raw image; network tensors are float32 planar
+// (CHW) with Length(0) = width, Length(1) = height, Length(2) = channels.
+//
+// Beyond the members the original sample calls, this stand-in carries the
+// frame's plane pointer, stride and format and the tensor's element type
+// and rank, so the host build can exercise the features that read them.
+// They are not taken from the vendor headers: the component reads them only
+// through sdk_access.h under SDK_EXTENDED_API, which only this host build
+// defines. Length() past the last axis returning 1 is likewise a stand-in
+// convenience; the component bounds its reads with SdkAccess::Length().
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum pixel_format_t : uint32_t {
+  ePixelFormatNV12 = 0,
+  ePixelFormatRGB888 = 1,
+};
+
+// One plane set of a camera raw frame. Frames with several substreams are
+// chained through |next|, largest first.
+struct RawImage {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t stride = 0;
+  pixel_format_t format = ePixelFormatNV12;
+  uint64_t pts = 0;
+  void* virt_addr = nullptr;
+  RawImage* next = nullptr;
+};
+
+struct img_size_t {
+  uint32_t width;
+  uint32_t height;
+};
+
+enum tensor_data_type_t : uint32_t {
+  eTensorFloat32 = 0,
+  eTensorUint8 = 1,
+  eTensorInt8 = 2,
+};
+
+class Tensor {
+ public:
+  static Tensor* Create();
+  // Network tensor with the given dimensions, innermost (width) first.
+  static Tensor* Create(const std::string& name, const std::vector<uint32_t>& dims, tensor_data_type_t type);
+  virtual ~Tensor();
+
+  // Converts |image| into this tensor as packed RGB888.
+  bool Allocate(const RawImage& image);
+  // Bilinear resize of this RGB888 tensor into |dst| (float32 CHW or RGB888).
+  bool Resize(Tensor& dst, const img_size_t& size);
+
+  const std::string& Name() const { return name_; }
+  uint32_t Length(size_t axis) const { return axis < dims_.size() ? dims_[axis] : 1; }
+  size_t Dims() const { return dims_.size(); }
+  tensor_data_type_t DataType() const { return type_; }
+  size_t ElementCount() const;
+  size_t Size() const { return buffer_.size(); }
+  void* VirtAddr() const { return buffer_.empty() ? nullptr : const_cast<uint8_t*>(buffer_.data()); }
+
+ private:
+  Tensor() {}
+
+  std::string name_;
+  std::vector<uint32_t> dims_;
+  tensor_data_type_t type_ = eTensorUint8;
+  std::vector<uint8_t> buffer_;
+};
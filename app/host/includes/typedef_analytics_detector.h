@@ -0,0 +1,9 @@
+#pragma once
+
+#include "host_component.h"
+
+namespace _ELayer_Analytics_Detector {
+enum : ClassID {
+  _eObjectDetectorAI = 0x7000,
+};
+}  // namespace _ELayer_Analytics_Detector
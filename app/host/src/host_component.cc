@@ -0,0 +1,168 @@
+#include "host_component.h"
+
+#include <sys/stat.h>
+
+HostMemManager Component::allocator;
+HostMemManager Event::allocator;
+
+void* operator new(std::size_t size, const char* tag) {
+  return ::operator new(size);
+}
+
+void operator delete(void* ptr, const char* tag) noexcept {
+  ::operator delete(ptr);
+}
+
+void Log::Print(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+}
+
+namespace Base64 {
+
+static const char kTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::pair<std::unique_ptr<char[]>, size_t> encode(const char* data, size_t size) {
+  size_t out_size = 4 * ((size + 2) / 3);
+  std::unique_ptr<char[]> out(new char[out_size + 1]);
+  size_t o = 0;
+  for (size_t i = 0; i < size; i += 3) {
+    uint32_t n = static_cast<unsigned char>(data[i]) << 16;
+    if (i + 1 < size) { n |= static_cast<unsigned char>(data[i + 1]) << 8; }
+    if (i + 2 < size) { n |= static_cast<unsigned char>(data[i + 2]); }
+    out[o++] = kTable[(n >> 18) & 0x3F];
+    out[o++] = kTable[(n >> 12) & 0x3F];
+    out[o++] = i + 1 < size ? kTable[(n >> 6) & 0x3F] : '=';
+    out[o++] = i + 2 < size ? kTable[n & 0x3F] : '=';
+  }
+  out[o] = '\0';
+  return {std::move(out), out_size};
+}
+
+std::pair<std::unique_ptr<char[]>, size_t> decode(const char* data, size_t size) {
+  int lookup[256];
+  for (int& v : lookup) { v = -1; }
+  for (int i = 0; i < 64; i++) { lookup[static_cast<unsigned char>(kTable[i])] = i; }
+
+  std::unique_ptr<char[]> out(new char[size / 4 * 3 + 1]);
+  size_t o = 0;
+  uint32_t bits = 0;
+  int count = 0;
+  for (size_t i = 0; i < size; i++) {
+    int v = lookup[static_cast<unsigned char>(data[i])];
+    if (v < 0) { continue; }
+    bits = (bits << 6) | static_cast<uint32_t>(v);
+    count += 6;
+    if (count >= 8) {
+      count -= 8;
+      out[o++] = static_cast<char>((bits >> count) & 0xFF);
+    }
+  }
+  out[o] = '\0';
+  return {std::move(out), o};
+}
+
+}  // namespace Base64
+
+Blob::Blob(const void* data, uint64_t size, std::function<void()> release)
+    : resource_(std::make_shared<Resource>()) {
+  resource_->data = const_cast<void*>(data);
+  resource_->size = size;
+  resource_->release = std::move(release);
+}
+
+Event::Event(int32_t type, BaseObject* argument, bool is_reply)
+    : type_(type), is_reply_(is_reply), argument_(argument) {}
+
+Event::Event(int32_t type, const Blob& blob)
+    : type_(type), is_reply_(false), argument_(nullptr), blob_(blob) {}
+
+Event::~Event() {
+  delete argument_;
+}
+
+void Event::ClearBaseObjectArgument() {
+  argument_ = nullptr;
+  blob_.ClearResource();
+}
+
+bool SerializableJson::WriteFile(const std::string& filename, const std::string& groupName, std::string& outputString) {
+  std::ofstream output_file(filename.c_str());
+  if (!output_file.is_open()) { return false; }
+  output_file << outputString;
+  return true;
+}
+
+HostEventBus& HostEventBus::Instance() {
+  static HostEventBus bus;
+  return bus;
+}
+
+void HostEventBus::Subscribe(const std::string& receiver, Handler handler) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  handlers_[receiver] = std::move(handler);
+}
+
+void HostEventBus::Unsubscribe(const std::string& receiver) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  handlers_.erase(receiver);
+}
+
+bool HostEventBus::Deliver(const std::string& receiver, int32_t type, BaseObject* argument) {
+  Handler handler;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = handlers_.find(receiver);
+    if (it == handlers_.end()) { return false; }
+    handler = it->second;
+  }
+  handler(type, argument);
+  return true;
+}
+
+Component::Component(ClassID id, const char* name) : id_(id), name_(name) {}
+
+Component::~Component() {}
+
+bool Component::ProcessAEvent(Event* event) {
+  return true;
+}
+
+static bool ReadWholeFile(const std::string& path, std::string& out) {
+  std::ifstream input(path.c_str());
+  if (!input.is_open()) { return false; }
+  std::stringstream ss;
+  ss << input.rdbuf();
+  out = ss.str();
+  return true;
+}
+
+bool Component::PrepareAttributes(SerializableJson* attributes, const std::string& group_name) {
+  std::map<std::string, SerializerAttribute> key_value_map;
+  std::string json;
+  // persisted settings win over the shipped defaults
+  if (!ReadWholeFile(config_.setting_path + group_name + "_attribute_0.json", json) &&
+      !ReadWholeFile(config_.model_path + group_name + "_default_attribute_0.json", json)) {
+    return false;
+  }
+  return attributes->Deserialize(json, group_name, key_value_map);
+}
+
+bool Component::WriteAttributes(SerializableJson* attributes, const std::string& group_name) {
+  std::map<std::string, SerializerAttribute> key_value_map;
+  std::string json = attributes->Serialize(group_name, key_value_map, config_.version);
+  mkdir(config_.setting_path.c_str(), 0755);
+  return attributes->WriteFile(config_.setting_path + group_name + "_attribute_0.json", group_name, json);
+}
+
+void Component::SendNoReplyEvent(const std::string& receiver, int32_t type, int32_t option, BaseObject* argument) {
+  std::unique_ptr<BaseObject> owned(argument);
+  HostEventBus::Instance().Deliver(receiver, type, owned.get());
+}
+
+void Component::SendTargetEvents(const std::string& group, int32_t type, int32_t option, BaseObject* argument) {
+  std::unique_ptr<BaseObject> owned(argument);
+  HostEventBus::Instance().Deliver(group, type, owned.get());
+}
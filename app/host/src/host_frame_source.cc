@@ -0,0 +1,114 @@
+#include "host_frame_source.h"
+
+#include <cstring>
+
+#include "i_p_stream_provider_manager_video_raw.h"
+
+HostFrameSource::HostFrameSource(const std::vector<Stream>& streams, uint32_t fps, uint32_t distinct_frames)
+    : streams_(streams),
+      period_ms_(fps ? 1000 / fps : 33),
+      distinct_frames_(distinct_frames ? distinct_frames : 1),
+      state_(std::make_shared<State>()) {
+  frame_bytes_ = sizeof(HostFrameHeader) + streams_.size() * sizeof(HostImageHeader);
+  for (auto& s : streams_) {
+    frame_bytes_ += static_cast<size_t>(s.width) * s.height * 3 / 2;
+  }
+  for (uint32_t phase = 0; phase < distinct_frames_; phase++) {
+    auto slot = std::make_unique<Slot>();
+    slot->phase = phase;
+    Render(slot->data, phase);
+    state_->slots.push_back(std::move(slot));
+  }
+}
+
+HostFrameSource::~HostFrameSource() {}
+
+void HostFrameSource::Render(std::vector<uint8_t>& data, uint32_t phase) const {
+  data.assign(frame_bytes_, 0);
+  auto* header = reinterpret_cast<HostFrameHeader*>(data.data());
+  header->magic = HostFrameHeader::kMagic;
+  header->image_count = static_cast<uint32_t>(streams_.size());
+  header->pts = 0;
+
+  uint64_t offset = sizeof(HostFrameHeader) + streams_.size() * sizeof(HostImageHeader);
+  for (size_t i = 0; i < streams_.size(); i++) {
+    const Stream& s = streams_[i];
+    auto* image = reinterpret_cast<HostImageHeader*>(data.data() + sizeof(HostFrameHeader)) + i;
+    image->width = s.width;
+    image->height = s.height;
+    image->stride = s.width;
+    image->format = ePixelFormatNV12;
+    image->offset = offset;
+    image->size = static_cast<uint64_t>(s.width) * s.height * 3 / 2;
+
+    // a diagonal gradient with a bright square drifting with |phase|
+    uint8_t* y_plane = data.data() + offset;
+    uint8_t* uv_plane = y_plane + static_cast<size_t>(s.width) * s.height;
+    uint32_t box = s.width / 6;
+    uint32_t bx = (phase * s.width / 16) % (s.width - box);
+    uint32_t by = s.height / 3;
+    for (uint32_t y = 0; y < s.height; y++) {
+      for (uint32_t x = 0; x < s.width; x++) {
+        bool in_box = x >= bx && x < bx + box && y >= by && y < by + box;
+        y_plane[static_cast<size_t>(y) * s.width + x] =
+            in_box ? 235 : static_cast<uint8_t>(16 + ((x * 219 / s.width + y * 64 / s.height + phase * 3) % 219));
+      }
+    }
+    for (uint32_t y = 0; y < s.height / 2; y++) {
+      for (uint32_t x = 0; x < s.width; x += 2) {
+        uv_plane[static_cast<size_t>(y) * s.width + x] = static_cast<uint8_t>(96 + (x * 64 / s.width));
+        uv_plane[static_cast<size_t>(y) * s.width + x + 1] = static_cast<uint8_t>(160 - (y * 128 / s.height));
+      }
+    }
+    offset += image->size;
+  }
+}
+
+Blob HostFrameSource::NextFrame() {
+  Slot* slot = nullptr;
+  uint32_t phase = 0;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    phase = static_cast<uint32_t>(state_->produced % distinct_frames_);
+    for (auto& s : state_->slots) {
+      if (s->phase == phase && !s->in_use) {
+        slot = s.get();
+        break;
+      }
+    }
+    if (!slot) {
+      // every buffer of this phase is still held downstream; grow the ring
+      auto fresh = std::make_unique<Slot>();
+      fresh->phase = phase;
+      fresh->data = state_->slots[phase]->data;
+      slot = fresh.get();
+      state_->slots.push_back(std::move(fresh));
+    }
+    slot->in_use = true;
+    state_->produced++;
+  }
+
+  reinterpret_cast<HostFrameHeader*>(slot->data.data())->pts = pts_;
+  pts_ += period_ms_;
+
+  std::shared_ptr<State> state = state_;
+  return Blob(slot->data.data(), slot->data.size(), [state, slot]() {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    slot->in_use = false;
+    state->released++;
+  });
+}
+
+Event* HostFrameSource::NextEvent() {
+  return new ("VideoRaw") Event(static_cast<int32_t>(IPStreamProviderManagerVideoRaw::EEventType::eVideoRawData), NextFrame());
+}
+
+uint64_t HostFrameSource::FramesProduced() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->produced;
+}
+
+uint64_t HostFrameSource::FramesInFlight() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->produced - state_->released;
+}
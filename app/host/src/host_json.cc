@@ -0,0 +1,402 @@
+#include "host_json.h"
+
+#include <cctype>
+#include <cstdlib>
+
+namespace rapidjson {
+
+bool Value::IsInt() const {
+  if (!IsNumber() || num_kind_ == kDouble) { return false; }
+  return num_kind_ == kInt ? (i64_ >= INT32_MIN && i64_ <= INT32_MAX) : u64_ <= INT32_MAX;
+}
+
+bool Value::IsUint() const {
+  if (!IsNumber() || num_kind_ == kDouble) { return false; }
+  return num_kind_ == kUint ? u64_ <= UINT32_MAX : (i64_ >= 0 && i64_ <= UINT32_MAX);
+}
+
+bool Value::IsInt64() const {
+  if (!IsNumber() || num_kind_ == kDouble) { return false; }
+  return num_kind_ == kInt || u64_ <= static_cast<uint64_t>(INT64_MAX);
+}
+
+bool Value::IsUint64() const {
+  if (!IsNumber() || num_kind_ == kDouble) { return false; }
+  return num_kind_ == kUint || i64_ >= 0;
+}
+
+int64_t Value::GetInt64() const {
+  if (!IsNumber()) { return 0; }
+  if (num_kind_ == kInt) { return i64_; }
+  if (num_kind_ == kUint) { return static_cast<int64_t>(u64_); }
+  return static_cast<int64_t>(d_);
+}
+
+uint64_t Value::GetUint64() const {
+  if (!IsNumber()) { return 0; }
+  if (num_kind_ == kUint) { return u64_; }
+  if (num_kind_ == kInt) { return static_cast<uint64_t>(i64_); }
+  return static_cast<uint64_t>(d_);
+}
+
+Value& Value::SetObject() {
+  *this = Value(kObjectType);
+  return *this;
+}
+
+Value& Value::SetArray() {
+  *this = Value(kArrayType);
+  return *this;
+}
+
+Value& Value::SetString(const char* s, SizeType length, AllocatorType&) {
+  *this = Value(kStringType);
+  string_.assign(s, length);
+  return *this;
+}
+
+Value::MemberIterator Value::FindMember(const char* name) {
+  for (auto it = members_.begin(); it != members_.end(); ++it) {
+    if (it->name.string_ == name) { return it; }
+  }
+  return members_.end();
+}
+
+Value::ConstMemberIterator Value::FindMember(const char* name) const {
+  for (auto it = members_.begin(); it != members_.end(); ++it) {
+    if (it->name.string_ == name) { return it; }
+  }
+  return members_.end();
+}
+
+Value& Value::operator[](const char* name) {
+  auto it = FindMember(name);
+  if (it != members_.end()) { return it->value; }
+  // rapidjson asserts here; hand back a fresh null so callers see "" / 0
+  static thread_local Value null_value;
+  null_value = Value();
+  return null_value;
+}
+
+const Value& Value::operator[](const char* name) const {
+  auto it = FindMember(name);
+  if (it != members_.end()) { return it->value; }
+  static const Value null_value;
+  return null_value;
+}
+
+Value& Value::AddMember(Value& name, Value& value, AllocatorType&) {
+  if (type_ != kObjectType) { SetObject(); }
+  members_.emplace_back(std::move(name), std::move(value));
+  name = Value();
+  value = Value();
+  return *this;
+}
+
+Value& Value::AddMember(const char* name, Value& value, AllocatorType& a) {
+  Value key(name, a);
+  return AddMember(key, value, a);
+}
+
+Value& Value::AddMember(const char* name, const std::string& value, AllocatorType& a) {
+  Value key(name, a);
+  Value v(value, a);
+  return AddMember(key, v, a);
+}
+
+bool Value::RemoveMember(const char* name) {
+  auto it = FindMember(name);
+  if (it == members_.end()) { return false; }
+  members_.erase(it);
+  return true;
+}
+
+Value& Value::PushBack(Value& value, AllocatorType&) {
+  if (type_ != kArrayType) { SetArray(); }
+  elements_.push_back(std::move(value));
+  value = Value();
+  return *this;
+}
+
+namespace {
+
+class Parser {
+ public:
+  Parser(const char* json, size_t length) : begin_(json), cur_(json), end_(json + length) {}
+
+  ParseResult Parse(Value& root) {
+    SkipWhitespace();
+    if (cur_ == end_) { return Fail(kParseErrorDocumentEmpty); }
+    if (!ParseValue(root)) { return result_; }
+    SkipWhitespace();
+    if (cur_ != end_) { return Fail(kParseErrorDocumentRootNotSingular); }
+    return ParseResult();
+  }
+
+ private:
+  ParseResult Fail(ParseErrorCode code) {
+    if (!result_.IsError()) { result_ = ParseResult(code, static_cast<size_t>(cur_ - begin_)); }
+    return result_;
+  }
+
+  void SkipWhitespace() {
+    while (cur_ != end_ && (*cur_ == ' ' || *cur_ == '\n' || *cur_ == '\r' || *cur_ == '\t')) { cur_++; }
+  }
+
+  bool Consume(const char* literal) {
+    size_t n = strlen(literal);
+    if (static_cast<size_t>(end_ - cur_) < n || strncmp(cur_, literal, n) != 0) { return false; }
+    cur_ += n;
+    return true;
+  }
+
+  bool ParseValue(Value& out) {
+    SkipWhitespace();
+    if (cur_ == end_) { Fail(kParseErrorValueInvalid); return false; }
+    switch (*cur_) {
+      case '{': return ParseObject(out);
+      case '[': return ParseArray(out);
+      case '"': {
+        std::string s;
+        if (!ParseString(s)) { return false; }
+        MemoryPoolAllocator a;
+        out = Value(s, a);
+        return true;
+      }
+      case 't':
+        if (Consume("true")) { out = Value(true); return true; }
+        break;
+      case 'f':
+        if (Consume("false")) { out = Value(false); return true; }
+        break;
+      case 'n':
+        if (Consume("null")) { out = Value(); return true; }
+        break;
+      default:
+        return ParseNumber(out);
+    }
+    Fail(kParseErrorValueInvalid);
+    return false;
+  }
+
+  bool ParseObject(Value& out) {
+    MemoryPoolAllocator a;
+    out.SetObject();
+    cur_++;  // '{'
+    SkipWhitespace();
+    if (cur_ != end_ && *cur_ == '}') { cur_++; return true; }
+    while (true) {
+      SkipWhitespace();
+      if (cur_ == end_ || *cur_ != '"') { Fail(kParseErrorObjectMissName); return false; }
+      std::string key;
+      if (!ParseString(key)) { return false; }
+      SkipWhitespace();
+      if (cur_ == end_ || *cur_ != ':') { Fail(kParseErrorObjectMissColon); return false; }
+      cur_++;
+      Value v;
+      if (!ParseValue(v)) { return false; }
+      Value k(key, a);
+      out.AddMember(k, v, a);
+      SkipWhitespace();
+      if (cur_ != end_ && *cur_ == ',') { cur_++; continue; }
+      if (cur_ != end_ && *cur_ == '}') { cur_++; return true; }
+      Fail(kParseErrorObjectMissCommaOrCurlyBracket);
+      return false;
+    }
+  }
+
+  bool ParseArray(Value& out) {
+    MemoryPoolAllocator a;
+    out.SetArray();
+    cur_++;  // '['
+    SkipWhitespace();
+    if (cur_ != end_ && *cur_ == ']') { cur_++; return true; }
+    while (true) {
+      Value v;
+      if (!ParseValue(v)) { return false; }
+      out.PushBack(v, a);
+      SkipWhitespace();
+      if (cur_ != end_ && *cur_ == ',') { cur_++; continue; }
+      if (cur_ != end_ && *cur_ == ']') { cur_++; return true; }
+      Fail(kParseErrorArrayMissCommaOrSquareBracket);
+      return false;
+    }
+  }
+
+  static void AppendUtf8(std::string& s, unsigned cp) {
+    if (cp < 0x80) {
+      s.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+      s.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+      s.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+      s.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+      s.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      s.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+      s.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+      s.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+      s.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      s.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+  }
+
+  bool ParseHex4(unsigned& cp) {
+    if (end_ - cur_ < 4) { Fail(kParseErrorStringInvalidEscape); return false; }
+    char hex[5] = {cur_[0], cur_[1], cur_[2], cur_[3], '\0'};
+    char* parsed_end = nullptr;
+    cp = static_cast<unsigned>(strtoul(hex, &parsed_end, 16));
+    if (parsed_end != hex + 4) { Fail(kParseErrorStringInvalidEscape); return false; }
+    cur_ += 4;
+    return true;
+  }
+
+  bool ParseString(std::string& s) {
+    cur_++;  // '"'
+    while (cur_ != end_) {
+      char c = *cur_++;
+      if (c == '"') { return true; }
+      if (c != '\\') { s.push_back(c); continue; }
+      if (cur_ == end_) { break; }
+      char e = *cur_++;
+      switch (e) {
+        case '"': s.push_back('"'); break;
+        case '\\': s.push_back('\\'); break;
+        case '/': s.push_back('/'); break;
+        case 'b': s.push_back('\b'); break;
+        case 'f': s.push_back('\f'); break;
+        case 'n': s.push_back('\n'); break;
+        case 'r': s.push_back('\r'); break;
+        case 't': s.push_back('\t'); break;
+        case 'u': {
+          unsigned cp = 0;
+          if (!ParseHex4(cp)) { return false; }
+          if (cp >= 0xD800 && cp <= 0xDBFF && Consume("\\u")) {
+            unsigned low = 0;
+            if (!ParseHex4(low)) { return false; }
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+          }
+          AppendUtf8(s, cp);
+          break;
+        }
+        default:
+          Fail(kParseErrorStringInvalidEscape);
+          return false;
+      }
+    }
+    Fail(kParseErrorStringMissQuotationMark);
+    return false;
+  }
+
+  bool ParseNumber(Value& out) {
+    const char* start = cur_;
+    bool is_double = false;
+    if (cur_ != end_ && *cur_ == '-') { cur_++; }
+    if (cur_ == end_ || !isdigit(static_cast<unsigned char>(*cur_))) { Fail(kParseErrorValueInvalid); return false; }
+    while (cur_ != end_ && isdigit(static_cast<unsigned char>(*cur_))) { cur_++; }
+    if (cur_ != end_ && *cur_ == '.') {
+      is_double = true;
+      cur_++;
+      while (cur_ != end_ && isdigit(static_cast<unsigned char>(*cur_))) { cur_++; }
+    }
+    if (cur_ != end_ && (*cur_ == 'e' || *cur_ == 'E')) {
+      is_double = true;
+      cur_++;
+      if (cur_ != end_ && (*cur_ == '+' || *cur_ == '-')) { cur_++; }
+      if (cur_ == end_ || !isdigit(static_cast<unsigned char>(*cur_))) { Fail(kParseErrorNumberMissExponent); return false; }
+      while (cur_ != end_ && isdigit(static_cast<unsigned char>(*cur_))) { cur_++; }
+    }
+
+    std::string text(start, cur_);
+    if (is_double) {
+      out = Value(strtod(text.c_str(), nullptr));
+    } else if (text[0] == '-') {
+      out = Value(static_cast<int64_t>(strtoll(text.c_str(), nullptr, 10)));
+    } else {
+      out = Value(static_cast<uint64_t>(strtoull(text.c_str(), nullptr, 10)));
+    }
+    return true;
+  }
+
+  const char* begin_;
+  const char* cur_;
+  const char* end_;
+  ParseResult result_;
+};
+
+}  // namespace
+
+Document& Document::Parse(const char* json, size_t length) {
+  Value root;
+  Parser parser(json, length);
+  parse_result_ = parser.Parse(root);
+  if (!parse_result_.IsError()) {
+    static_cast<Value&>(*this) = std::move(root);
+  }
+  return *this;
+}
+
+}  // namespace rapidjson
+
+namespace JsonUtility {
+
+void set(ValueType& object, const char* key, const std::string& value, JsonDocument::AllocatorType& alloc) {
+  object.RemoveMember(key);
+  object.AddMember(key, value, alloc);
+}
+
+void set(ValueType& object, const char* key, const char* value, JsonDocument::AllocatorType& alloc) {
+  set(object, key, std::string(value), alloc);
+}
+
+template <typename T>
+static void SetScalar(ValueType& object, const char* key, T value, JsonDocument::AllocatorType& alloc) {
+  object.RemoveMember(key);
+  object.AddMember(key, ValueType(value), alloc);
+}
+
+void set(ValueType& object, const char* key, int value, JsonDocument::AllocatorType& alloc) { SetScalar(object, key, value, alloc); }
+void set(ValueType& object, const char* key, unsigned value, JsonDocument::AllocatorType& alloc) { SetScalar(object, key, value, alloc); }
+void set(ValueType& object, const char* key, int64_t value, JsonDocument::AllocatorType& alloc) { SetScalar(object, key, value, alloc); }
+void set(ValueType& object, const char* key, uint64_t value, JsonDocument::AllocatorType& alloc) { SetScalar(object, key, value, alloc); }
+void set(ValueType& object, const char* key, double value, JsonDocument::AllocatorType& alloc) { SetScalar(object, key, value, alloc); }
+void set(ValueType& object, const char* key, bool value, JsonDocument::AllocatorType& alloc) { SetScalar(object, key, value, alloc); }
+
+bool get(const ValueType& object, const char* key, std::string& value) {
+  auto it = object.FindMember(key);
+  if (it == object.MemberEnd() || !it->value.IsString()) { return false; }
+  value = it->value.GetString();
+  return true;
+}
+
+template <typename T, typename Getter>
+static bool GetNumber(const ValueType& object, const char* key, T& value, Getter getter) {
+  auto it = object.FindMember(key);
+  if (it == object.MemberEnd() || !it->value.IsNumber()) { return false; }
+  value = static_cast<T>((it->value.*getter)());
+  return true;
+}
+
+bool get(const ValueType& object, const char* key, int& value) { return GetNumber(object, key, value, &ValueType::GetInt64); }
+bool get(const ValueType& object, const char* key, unsigned& value) { return GetNumber(object, key, value, &ValueType::GetUint64); }
+bool get(const ValueType& object, const char* key, int64_t& value) { return GetNumber(object, key, value, &ValueType::GetInt64); }
+bool get(const ValueType& object, const char* key, uint64_t& value) { return GetNumber(object, key, value, &ValueType::GetUint64); }
+bool get(const ValueType& object, const char* key, double& value) { return GetNumber(object, key, value, &ValueType::GetDouble); }
+bool get(const ValueType& object, const char* key, float& value) { return GetNumber(object, key, value, &ValueType::GetDouble); }
+
+bool get(const ValueType& object, const char* key, bool& value) {
+  auto it = object.FindMember(key);
+  if (it == object.MemberEnd() || !it->value.IsBool()) { return false; }
+  value = it->value.GetBool();
+  return true;
+}
+
+}  // namespace JsonUtility
+
+bool getJsonString(const JsonUtility::ValueType& value, std::string& out) {
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  value.Accept(writer);
+  out.assign(buffer.GetString(), buffer.GetSize());
+  return true;
+}
@@ -0,0 +1,58 @@
+#include "host_metadata_sink.h"
+
+HostMetadataSink::HostMetadataSink(const std::string& receiver) : receiver_(receiver) {
+  HostEventBus::Instance().Subscribe(receiver_, [this](int32_t type, BaseObject* argument) { OnEvent(type, argument); });
+}
+
+HostMetadataSink::~HostMetadataSink() {
+  HostEventBus::Instance().Unsubscribe(receiver_);
+}
+
+void HostMetadataSink::OnEvent(int32_t type, BaseObject* argument) {
+  if (type != static_cast<int32_t>(IMetadataManager::EEventType::eRequestRawMetadata)) { return; }
+  auto* request = dynamic_cast<IPMetadataManager::StringMetadataRequest*>(argument);
+  if (!request) { return; }
+
+  const StringMetadata& metadata = request->GetStringMetadata();
+  std::lock_guard<std::mutex> lock(mutex_);
+  Channel& channel = channels_[metadata.GetChannel()];
+  if (channel.count > 0 && metadata.GetTimestamp() < channel.last_timestamp) { in_order_ = false; }
+  channel.count++;
+  channel.bytes += metadata.Get().size();
+  channel.last = metadata.Get();
+  channel.last_timestamp = metadata.GetTimestamp();
+}
+
+const HostMetadataSink::Channel* HostMetadataSink::Find(int channel) const {
+  auto it = channels_.find(channel);
+  return it == channels_.end() ? nullptr : &it->second;
+}
+
+uint64_t HostMetadataSink::Count(int channel) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const Channel* found = Find(channel);
+  return found ? found->count : 0;
+}
+
+uint64_t HostMetadataSink::Bytes(int channel) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const Channel* found = Find(channel);
+  return found ? found->bytes : 0;
+}
+
+std::string HostMetadataSink::Last(int channel) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const Channel* found = Find(channel);
+  return found ? found->last : std::string();
+}
+
+uint64_t HostMetadataSink::LastTimestamp(int channel) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const Channel* found = Find(channel);
+  return found ? found->last_timestamp : 0;
+}
+
+bool HostMetadataSink::InOrder() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return in_order_;
+}
@@ -0,0 +1,315 @@
+#include "neural_network.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <thread>
+
+namespace {
+
+constexpr uint32_t kInputWidth = 224;
+constexpr uint32_t kInputHeight = 224;
+constexpr uint32_t kInputChannels = 3;
+constexpr uint32_t kClasses = 1000;
+constexpr uint32_t kConvChannels = 8;
+constexpr uint32_t kPoolGrid = 8;
+constexpr uint32_t kDetections = 16;
+constexpr uint32_t kDetectionRow = 6;  // x, y, width, height, score, class
+
+const std::shared_ptr<Tensor> kNullTensor;
+
+uint64_t Fnv1a(const std::string& s) {
+  uint64_t h = 1469598103934665603ull;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+// xorshift64*, mapped to [-1, 1)
+float NextWeight(uint64_t& state) {
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  uint64_t r = state * 2685821657736338717ull;
+  return static_cast<float>((r >> 40) & 0xFFFFFF) / 8388608.0f - 1.0f;
+}
+
+bool IsDetection(const std::string& name) {
+  return name.compare(0, 3, "det") == 0;
+}
+
+// The kDetections strongest pool cells as boxes two cells wide centred on
+// the cell, scored against the strongest one, class = strongest channel.
+void Detect(const std::vector<float>& pooled, std::vector<float>& rows) {
+  constexpr uint32_t kCells = kPoolGrid * kPoolGrid;
+  float energy[kCells] = {};
+  int best[kCells] = {};
+  for (uint32_t cell = 0; cell < kCells; cell++) {
+    float strongest = -1.0f;
+    for (uint32_t oc = 0; oc < kConvChannels; oc++) {
+      const float v = pooled[oc * kCells + cell];
+      energy[cell] += v;
+      if (v > strongest) {
+        strongest = v;
+        best[cell] = static_cast<int>(oc);
+      }
+    }
+  }
+  uint32_t order[kCells];
+  for (uint32_t cell = 0; cell < kCells; cell++) { order[cell] = cell; }
+  std::stable_sort(order, order + kCells, [&energy](uint32_t a, uint32_t b) { return energy[a] > energy[b]; });
+
+  rows.assign(kDetections * kDetectionRow, 0.0f);
+  const float top = energy[order[0]] > 0.0f ? energy[order[0]] : 1.0f;
+  for (uint32_t i = 0; i < kDetections; i++) {
+    const uint32_t cell = order[i];
+    float* row = &rows[i * kDetectionRow];
+    row[0] = (static_cast<float>(cell % kPoolGrid) - 0.5f) / kPoolGrid;
+    row[1] = (static_cast<float>(cell / kPoolGrid) - 0.5f) / kPoolGrid;
+    row[2] = 2.0f / kPoolGrid;
+    row[3] = 2.0f / kPoolGrid;
+    row[4] = energy[cell] / top;
+    row[5] = static_cast<float>(best[cell]);
+  }
+}
+
+uint32_t BatchSize() {
+  static const uint32_t batch = getenv("HOST_NPU_BATCH") ? std::max(1, atoi(getenv("HOST_NPU_BATCH"))) : 1;
+  return batch;
+}
+
+// True when |run| (1-based) is a multiple of N from the environment variable.
+bool EveryNth(const char* name, uint64_t run) {
+  const char* value = getenv(name);
+  const long every = value ? atol(value) : 0;
+  return every > 0 && run % static_cast<uint64_t>(every) == 0;
+}
+
+tensor_data_type_t OutputType() {
+  static const std::string type = getenv("HOST_NPU_OUTPUT") ? getenv("HOST_NPU_OUTPUT") : "";
+  if (type == "uint8") { return eTensorUint8; }
+  if (type == "int8") { return eTensorInt8; }
+  return eTensorFloat32;
+}
+
+// Stores |values| as |out|'s data type, quantised as described in the header.
+void StoreOutput(const std::vector<float>& values, Tensor& out, uint32_t slot) {
+  const size_t offset = static_cast<size_t>(slot) * values.size();
+  if (out.DataType() == eTensorFloat32) {
+    std::copy(values.begin(), values.end(), static_cast<float*>(out.VirtAddr()) + offset);
+    return;
+  }
+
+  const bool prob = out.Name().compare(0, 4, "prob") == 0;
+  const bool is_signed = out.DataType() == eTensorInt8;
+  const float scale = prob ? 1.0f / 255.0f : 1.0f / 8.0f;
+  const int zero_point = prob ? (is_signed ? -128 : 0) : (is_signed ? 0 : 128);
+  const int lo = is_signed ? -128 : 0;
+  const int hi = is_signed ? 127 : 255;
+  auto* q = static_cast<uint8_t*>(out.VirtAddr()) + offset;
+  for (size_t j = 0; j < values.size(); j++) {
+    int v = static_cast<int>(std::lround(values[j] / scale)) + zero_point;
+    v = std::min(std::max(v, lo), hi);
+    q[j] = static_cast<uint8_t>(static_cast<int8_t>(v));
+  }
+}
+
+uint32_t MicrosSince(std::chrono::steady_clock::time_point start) {
+  return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+}  // namespace
+
+NeuralNetwork* NeuralNetwork::Create() {
+  return new NeuralNetwork();
+}
+
+NeuralNetwork::~NeuralNetwork() {}
+
+const std::shared_ptr<Tensor>& NeuralNetwork::CreateInputTensor(const std::string& name) {
+  if (GetInputTensor(name)) { return kNullTensor; }
+  std::vector<uint32_t> dims = {kInputWidth, kInputHeight, kInputChannels};
+  if (BatchSize() > 1) { dims.push_back(BatchSize()); }
+  inputs_.emplace_back(Tensor::Create(name, dims, eTensorFloat32));
+  return inputs_.back();
+}
+
+const std::shared_ptr<Tensor>& NeuralNetwork::CreateOutputTensor(const std::string& name) {
+  if (GetOutputTensor(name)) { return kNullTensor; }
+  std::vector<uint32_t> dims = {IsDetection(name) ? kDetections * kDetectionRow : kClasses};
+  if (BatchSize() > 1) { dims.push_back(BatchSize()); }
+  outputs_.emplace_back(Tensor::Create(name, dims, IsDetection(name) ? eTensorFloat32 : OutputType()));
+  return outputs_.back();
+}
+
+bool NeuralNetwork::LoadNetwork(const std::string& bin, const std::vector<float>& mean, const std::vector<float>& scale) {
+  if (inputs_.empty() || outputs_.empty()) { return false; }
+
+  // Weights only depend on the model file name (and size, when the file is
+  // present) so host runs are reproducible without shipping the blob.
+  std::string base = bin.substr(bin.find_last_of('/') + 1);
+  uint64_t seed = Fnv1a(base);
+  struct stat st;
+  if (::stat(bin.c_str(), &st) == 0) { seed ^= static_cast<uint64_t>(st.st_size); }
+  if (seed == 0) { seed = 1; }
+
+  mean_ = mean;
+  scale_ = scale;
+  mean_.resize(kInputChannels, 0.0f);
+  scale_.resize(kInputChannels, 1.0f);
+
+  conv_weights_.resize(kConvChannels * kInputChannels * 9);
+  for (auto& w : conv_weights_) { w = NextWeight(seed) / 64.0f; }
+
+  const size_t features = kConvChannels * kPoolGrid * kPoolGrid;
+  size_t classes = 0;
+  for (auto& out : outputs_) {
+    if (!IsDetection(out->Name())) { classes = std::max<size_t>(classes, out->Length(0)); }
+  }
+  fc_weights_.resize(classes * features);
+  fc_bias_.resize(classes);
+  for (auto& w : fc_weights_) { w = NextWeight(seed) * 0.05f; }
+  for (auto& b : fc_bias_) { b = NextWeight(seed) * 0.1f; }
+
+  runs_ = 0;
+  loaded_ = true;
+  return true;
+}
+
+bool NeuralNetwork::RunNetwork(stat_t& stat) {
+  if (!loaded_) { return false; }
+  stat.pre_time = stat.run_time = stat.post_time = 0;
+  const uint64_t run = ++runs_;
+  if (EveryNth("HOST_NPU_FAIL_EVERY", run)) { return false; }
+  const bool corrupt = EveryNth("HOST_NPU_NAN_EVERY", run);
+
+  const Tensor& input = *inputs_[0];
+  const uint32_t w = input.Length(0);
+  const uint32_t h = input.Length(1);
+  const uint32_t batch = input.Length(3);
+  const size_t plane = static_cast<size_t>(w) * h;
+
+  for (uint32_t n = 0; n < batch; n++) {
+    auto start = std::chrono::steady_clock::now();
+    const float* in = static_cast<const float*>(input.VirtAddr()) + n * plane * kInputChannels;
+
+    // normalisation, as the SDK applies the mean/scale given to LoadNetwork
+    scratch_.resize(plane * kInputChannels);
+    for (uint32_t c = 0; c < kInputChannels; c++) {
+      for (size_t i = 0; i < plane; i++) {
+        scratch_[c * plane + i] = (in[c * plane + i] - mean_[c]) * scale_[c];
+      }
+    }
+    stat.pre_time += MicrosSince(start);
+
+    // 3x3 stride-2 convolution + ReLU, accumulated straight into the pool grid
+    auto run_start = std::chrono::steady_clock::now();
+    const uint32_t ow = w / 2;
+    const uint32_t oh = h / 2;
+    std::vector<float> pooled(kConvChannels * kPoolGrid * kPoolGrid, 0.0f);
+    for (uint32_t oc = 0; oc < kConvChannels; oc++) {
+      const float* k = &conv_weights_[oc * kInputChannels * 9];
+      for (uint32_t oy = 0; oy < oh; oy++) {
+        for (uint32_t ox = 0; ox < ow; ox++) {
+          float acc = 0.0f;
+          for (uint32_t c = 0; c < kInputChannels; c++) {
+            const float* p = &scratch_[c * plane];
+            for (int ky = -1; ky <= 1; ky++) {
+              int iy = std::min<int>(std::max<int>(static_cast<int>(oy * 2) + ky, 0), h - 1);
+              for (int kx = -1; kx <= 1; kx++) {
+                int ix = std::min<int>(std::max<int>(static_cast<int>(ox * 2) + kx, 0), w - 1);
+                acc += p[static_cast<size_t>(iy) * w + ix] * k[c * 9 + (ky + 1) * 3 + (kx + 1)];
+              }
+            }
+          }
+          if (acc > 0.0f) {
+            pooled[(oc * kPoolGrid + oy * kPoolGrid / oh) * kPoolGrid + ox * kPoolGrid / ow] += acc;
+          }
+        }
+      }
+    }
+    const float cell = static_cast<float>(ow * oh) / (kPoolGrid * kPoolGrid);
+    for (auto& v : pooled) { v /= cell; }
+
+    stat.run_time += MicrosSince(run_start);
+
+    for (auto& out : outputs_) {
+      if (IsDetection(out->Name())) {
+        auto post_start = std::chrono::steady_clock::now();
+        Detect(pooled, values_);
+        StoreOutput(values_, *out, n);
+        stat.post_time += MicrosSince(post_start);
+        continue;
+      }
+      const uint32_t classes = out->Length(0);
+      auto fc_start = std::chrono::steady_clock::now();
+      values_.resize(classes);
+      for (uint32_t j = 0; j < classes; j++) {
+        const float* row = &fc_weights_[static_cast<size_t>(j) * pooled.size()];
+        float acc = fc_bias_[j];
+        for (size_t i = 0; i < pooled.size(); i++) { acc += row[i] * pooled[i]; }
+        values_[j] = acc;
+      }
+      stat.run_time += MicrosSince(fc_start);
+
+      auto post_start = std::chrono::steady_clock::now();
+      if (out->Name().compare(0, 4, "prob") == 0) {
+        float max_logit = *std::max_element(values_.begin(), values_.end());
+        float sum = 0.0f;
+        for (auto& v : values_) {
+          v = std::exp(v - max_logit);
+          sum += v;
+        }
+        for (auto& v : values_) { v /= sum; }
+      }
+      if (corrupt && out->DataType() == eTensorFloat32) {
+        std::fill(values_.begin(), values_.end(), std::numeric_limits<float>::quiet_NaN());
+      }
+      StoreOutput(values_, *out, n);
+      stat.post_time += MicrosSince(post_start);
+    }
+  }
+
+  static const long npu_latency_us = getenv("HOST_NPU_LATENCY_US") ? atol(getenv("HOST_NPU_LATENCY_US")) : 0;
+  if (npu_latency_us > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(npu_latency_us));
+    stat.run_time += static_cast<uint32_t>(npu_latency_us);
+  }
+  return true;
+}
+
+void NeuralNetwork::UnloadNetwork() {
+  conv_weights_.clear();
+  fc_weights_.clear();
+  fc_bias_.clear();
+  scratch_.clear();
+  loaded_ = false;
+}
+
+const std::shared_ptr<Tensor>& NeuralNetwork::GetInputTensor(const std::string& name) const {
+  for (auto& t : inputs_) {
+    if (t->Name() == name) { return t; }
+  }
+  return kNullTensor;
+}
+
+const std::shared_ptr<Tensor>& NeuralNetwork::GetInputTensor(size_t index) const {
+  return index < inputs_.size() ? inputs_[index] : kNullTensor;
+}
+
+const std::shared_ptr<Tensor>& NeuralNetwork::GetOutputTensor(const std::string& name) const {
+  for (auto& t : outputs_) {
+    if (t->Name() == name) { return t; }
+  }
+  return kNullTensor;
+}
+
+const std::shared_ptr<Tensor>& NeuralNetwork::GetOutputTensor(size_t index) const {
+  return index < outputs_.size() ? outputs_[index] : kNullTensor;
+}
@@ -0,0 +1,46 @@
+#include "pl_video_frame_raw.h"
+
+#include "host_frame_source.h"
+
+IPLVideoFrameRaw::~IPLVideoFrameRaw() {
+  Release();
+}
+
+void IPLVideoFrameRaw::Release() {
+  while (head_) {
+    RawImage* next = head_->next;
+    delete head_;
+    head_ = next;
+  }
+}
+
+bool IPLVideoFrameRaw::DeserializeBaseObject(BaseObject* object, const std::pair<std::variant<BaseObject*, char*>, uint64_t>& data) {
+  Release();
+
+  if (!std::holds_alternative<char*>(data.first)) { return false; }
+  const char* blob = std::get<char*>(data.first);
+  const uint64_t size = data.second;
+  if (!blob || size < sizeof(HostFrameHeader)) { return false; }
+
+  const auto* header = reinterpret_cast<const HostFrameHeader*>(blob);
+  if (header->magic != HostFrameHeader::kMagic ||
+      size < sizeof(HostFrameHeader) + header->image_count * sizeof(HostImageHeader)) {
+    return false;
+  }
+
+  const auto* images = reinterpret_cast<const HostImageHeader*>(blob + sizeof(HostFrameHeader));
+  RawImage** tail = &head_;
+  for (uint32_t i = 0; i < header->image_count; i++) {
+    if (images[i].offset + images[i].size > size) { Release(); return false; }
+    auto* image = new RawImage();
+    image->width = images[i].width;
+    image->height = images[i].height;
+    image->stride = images[i].stride;
+    image->format = static_cast<pixel_format_t>(images[i].format);
+    image->pts = header->pts;
+    image->virt_addr = const_cast<char*>(blob + images[i].offset);
+    *tail = image;
+    tail = &image->next;
+  }
+  return head_ != nullptr;
+}
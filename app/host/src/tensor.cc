@@ -0,0 +1,104 @@
+#include "tensor.h"
+
+#include <algorithm>
+#include <cstring>
+
+Tensor* Tensor::Create() {
+  return new Tensor();
+}
+
+Tensor* Tensor::Create(const std::string& name, const std::vector<uint32_t>& dims, tensor_data_type_t type) {
+  auto* tensor = new Tensor();
+  tensor->name_ = name;
+  tensor->dims_ = dims;
+  tensor->type_ = type;
+  tensor->buffer_.assign(tensor->ElementCount() * (type == eTensorFloat32 ? sizeof(float) : 1), 0);
+  return tensor;
+}
+
+Tensor::~Tensor() {}
+
+size_t Tensor::ElementCount() const {
+  size_t count = dims_.empty() ? 0 : 1;
+  for (auto d : dims_) { count *= d; }
+  return count;
+}
+
+static inline uint8_t Clamp8(int v) {
+  return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+bool Tensor::Allocate(const RawImage& image) {
+  if (image.width == 0 || image.height == 0 || image.virt_addr == nullptr) { return false; }
+
+  dims_ = {image.width, image.height, 3};
+  type_ = eTensorUint8;
+  buffer_.resize(static_cast<size_t>(image.width) * image.height * 3);
+
+  const auto* src = static_cast<const uint8_t*>(image.virt_addr);
+  const uint32_t stride = image.stride ? image.stride : image.width * (image.format == ePixelFormatRGB888 ? 3 : 1);
+
+  if (image.format == ePixelFormatRGB888) {
+    for (uint32_t y = 0; y < image.height; y++) {
+      memcpy(&buffer_[static_cast<size_t>(y) * image.width * 3], src + static_cast<size_t>(y) * stride, image.width * 3);
+    }
+    return true;
+  }
+
+  if (image.format != ePixelFormatNV12) { return false; }
+
+  // BT.601 limited range, fixed point
+  const uint8_t* uv_plane = src + static_cast<size_t>(stride) * image.height;
+  for (uint32_t y = 0; y < image.height; y++) {
+    const uint8_t* y_row = src + static_cast<size_t>(y) * stride;
+    const uint8_t* uv_row = uv_plane + static_cast<size_t>(y / 2) * stride;
+    uint8_t* out = &buffer_[static_cast<size_t>(y) * image.width * 3];
+    for (uint32_t x = 0; x < image.width; x++) {
+      int c = (y_row[x] - 16) * 298;
+      int d = uv_row[x & ~1u] - 128;
+      int e = uv_row[(x & ~1u) + 1] - 128;
+      out[3 * x + 0] = Clamp8((c + 409 * e + 128) >> 8);
+      out[3 * x + 1] = Clamp8((c - 100 * d - 208 * e + 128) >> 8);
+      out[3 * x + 2] = Clamp8((c + 516 * d + 128) >> 8);
+    }
+  }
+  return true;
+}
+
+bool Tensor::Resize(Tensor& dst, const img_size_t& size) {
+  if (buffer_.empty() || Length(2) != 3) { return false; }
+  if (size.width == 0 || size.height == 0 || dst.Length(0) < size.width || dst.Length(1) < size.height) { return false; }
+
+  const uint32_t sw = Length(0);
+  const uint32_t sh = Length(1);
+  const float fx = static_cast<float>(sw) / size.width;
+  const float fy = static_cast<float>(sh) / size.height;
+  const size_t plane = static_cast<size_t>(dst.Length(0)) * dst.Length(1);
+
+  for (uint32_t y = 0; y < size.height; y++) {
+    float sy = std::max(0.0f, (y + 0.5f) * fy - 0.5f);
+    uint32_t y0 = std::min(static_cast<uint32_t>(sy), sh - 1);
+    uint32_t y1 = std::min(y0 + 1, sh - 1);
+    float wy = sy - y0;
+    for (uint32_t x = 0; x < size.width; x++) {
+      float sx = std::max(0.0f, (x + 0.5f) * fx - 0.5f);
+      uint32_t x0 = std::min(static_cast<uint32_t>(sx), sw - 1);
+      uint32_t x1 = std::min(x0 + 1, sw - 1);
+      float wx = sx - x0;
+      for (uint32_t c = 0; c < 3; c++) {
+        float p00 = buffer_[(static_cast<size_t>(y0) * sw + x0) * 3 + c];
+        float p01 = buffer_[(static_cast<size_t>(y0) * sw + x1) * 3 + c];
+        float p10 = buffer_[(static_cast<size_t>(y1) * sw + x0) * 3 + c];
+        float p11 = buffer_[(static_cast<size_t>(y1) * sw + x1) * 3 + c];
+        float v = (p00 * (1 - wx) + p01 * wx) * (1 - wy) + (p10 * (1 - wx) + p11 * wx) * wy;
+        size_t di = static_cast<size_t>(y) * dst.Length(0) + x;
+        if (dst.type_ == eTensorFloat32) {
+          reinterpret_cast<float*>(dst.buffer_.data())[c * plane + di] = v;
+        } else {
+          dst.buffer_[di * 3 + c] = Clamp8(static_cast<int>(v + 0.5f));
+        }
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,98 @@
+// Activation against a direct double-precision softmax/sigmoid, on float
+// logits (including ones large enough to overflow a naive exp) and on
+// quantised outputs through the histogram log-sum-exp.
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "activation.h"
+#include "test_check.h"
+
+namespace {
+
+double LogSumExp(const std::vector<double>& values)
+{
+  double max_value = values[0];
+  for (double v : values) { max_value = std::max(max_value, v); }
+  double sum = 0.0;
+  for (double v : values) { sum += std::exp(v - max_value); }
+  return max_value + std::log(sum);
+}
+
+void TestFromString()
+{
+  Activation::Type type = Activation::Type::eSoftmax;
+  CHECK(Activation::FromString("", type) && type == Activation::Type::eNone);
+  CHECK(Activation::FromString("none", type) && type == Activation::Type::eNone);
+  CHECK(Activation::FromString("softmax", type) && type == Activation::Type::eSoftmax);
+  CHECK(Activation::FromString("sigmoid", type) && type == Activation::Type::eSigmoid);
+  CHECK(!Activation::FromString("relu", type));
+}
+
+void TestFloat()
+{
+  std::mt19937 rng(3);
+  std::normal_distribution<float> logits(0.0f, 5.0f);
+  for (size_t width : {1u, 7u, 8u, 1000u}) {
+    std::vector<float> data(width);
+    for (auto& v : data) { v = logits(rng); }
+    // exp(100) overflows a float
+    data[width / 2] = 100.0f;
+    std::vector<double> wide(data.begin(), data.end());
+    const double lse = LogSumExp(wide);
+
+    TopK::Entry top[5];
+    const size_t count = TopK::Select(data.data(), width, 5, top);
+    CHECK(test::Near(Activation::LogSumExp(data.data(), width, top[0].value), lse, 1e-4 * std::fabs(lse) + 1e-5));
+
+    TopK::Entry softmax[5];
+    std::copy(top, top + count, softmax);
+    Activation::Apply(Activation::Type::eSoftmax, data.data(), width, softmax, count);
+    TopK::Entry sigmoid[5];
+    std::copy(top, top + count, sigmoid);
+    Activation::Apply(Activation::Type::eSigmoid, data.data(), width, sigmoid, count);
+    TopK::Entry none[5];
+    std::copy(top, top + count, none);
+    Activation::Apply(Activation::Type::eNone, data.data(), width, none, count);
+
+    for (size_t i = 0; i < count; i++) {
+      CHECK(softmax[i].id == top[i].id);
+      CHECK(test::Near(softmax[i].value, std::exp(top[i].value - lse), 1e-5));
+      CHECK(test::Near(sigmoid[i].value, 1.0 / (1.0 + std::exp(-static_cast<double>(top[i].value))), 1e-6));
+      CHECK(none[i].value == top[i].value);
+    }
+  }
+}
+
+template <typename T>
+void TestQuantized(float scale, int32_t zero_point)
+{
+  std::mt19937 rng(11);
+  std::uniform_int_distribution<int> values(0, 255);
+  std::vector<T> data(1000);
+  for (auto& v : data) { v = static_cast<T>(values(rng) + (sizeof(T) == 1 && static_cast<T>(-1) < 0 ? -128 : 0)); }
+  std::vector<double> real;
+  for (T q : data) { real.push_back((q - zero_point) * static_cast<double>(scale)); }
+  const double lse = LogSumExp(real);
+
+  TopK::Entry top[5];
+  const size_t count = TopK::Select(data.data(), data.size(), 5, top);
+  for (size_t i = 0; i < count; i++) { top[i].value = (top[i].value - zero_point) * scale; }
+  Activation::Apply(Activation::Type::eSoftmax, data.data(), data.size(), scale, zero_point, top, count);
+  for (size_t i = 0; i < count; i++) {
+    CHECK(test::Near(top[i].value, std::exp(real[top[i].id] - lse), 1e-5));
+  }
+}
+
+}  // namespace
+
+int main()
+{
+  TestFromString();
+  TestFloat();
+  TestQuantized<uint8_t>(1.0f / 8, 128);
+  TestQuantized<int8_t>(1.0f / 8, 0);
+  return test::TestResult();
+}
@@ -0,0 +1,161 @@
+// ChannelScheduler and BoundedQueue: latest-frame-only posting, the ready
+// check and Wake(), weighted round-robin order, frames released on Leave(),
+// and the queue's capacity, close, timed pop and reopen.
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "channel_scheduler.h"
+#include "test_check.h"
+
+namespace {
+
+char frames[16];
+
+Blob Frame(int id, std::atomic<int>& released)
+{
+  return Blob(frames + id % 16, 1, [&released] { released++; });
+}
+
+void TestReadyAndSupersede()
+{
+  auto& scheduler = ChannelScheduler::Instance();
+  std::atomic<bool> ready{false};
+  std::atomic<int> handled{0};
+  std::atomic<int> released{0};
+  const void* last = nullptr;
+  scheduler.Join(1, 1, 0, [&](Blob& blob, StageClock::time_point) {
+    last = blob.GetRawData();
+    handled++;
+  }, [&ready] { return ready.load(); });
+  CHECK(scheduler.IsJoined(1));
+
+  // not ready: the frame waits, and a newer one replaces it
+  CHECK(!scheduler.Post(1, Frame(0, released), StageClock::now()));
+  CHECK(scheduler.Post(1, Frame(1, released), StageClock::now()));
+  CHECK(released == 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  CHECK(handled == 0);
+
+  ready = true;
+  scheduler.Wake();
+  scheduler.Drain(1);
+  CHECK(handled == 1);
+  CHECK(released == 2);
+  CHECK(last == frames + 1);
+
+  // a frame left waiting is released on Leave()
+  ready = false;
+  const int before = released;
+  scheduler.Post(1, Frame(2, released), StageClock::now());
+  scheduler.Leave(1);
+  CHECK(!scheduler.IsJoined(1));
+  CHECK(released == before + 1);
+  CHECK(handled == 1);
+
+  // posting to a channel that left hands the frame straight back
+  CHECK(scheduler.Post(1, Frame(3, released), StageClock::now()));
+  CHECK(released == before + 2);
+}
+
+void TestWeightedOrder()
+{
+  auto& scheduler = ChannelScheduler::Instance();
+  std::atomic<bool> ready{false};
+  std::atomic<int> released{0};
+  std::mutex order_mutex;
+  std::vector<int> order;
+  constexpr size_t kFrames = 9;
+
+  // each handled frame is followed by the channel's next one, so both
+  // channels always have a frame waiting
+  auto handler = [&](int channel) {
+    return [&, channel](Blob&, StageClock::time_point) {
+      std::lock_guard<std::mutex> lock(order_mutex);
+      order.push_back(channel);
+      if (order.size() < kFrames) { scheduler.Post(channel, Frame(channel, released), StageClock::now()); }
+    };
+  };
+  auto is_ready = [&ready] { return ready.load(); };
+  scheduler.Join(10, 2, 0, handler(10), is_ready);
+  scheduler.Join(20, 1, 0, handler(20), is_ready);
+  scheduler.Post(10, Frame(0, released), StageClock::now());
+  scheduler.Post(20, Frame(1, released), StageClock::now());
+  ready = true;
+  scheduler.Wake();
+
+  for (int i = 0; i < 1000; i++) {
+    {
+      std::lock_guard<std::mutex> lock(order_mutex);
+      if (order.size() >= kFrames) { break; }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  scheduler.Drain(10);
+  scheduler.Drain(20);
+  scheduler.Leave(10);
+  scheduler.Leave(20);
+
+  std::lock_guard<std::mutex> lock(order_mutex);
+  CHECK(order.size() >= kFrames);
+  const std::vector<int> expected = {10, 10, 20, 10, 10, 20, 10, 10, 20};
+  CHECK(std::vector<int>(order.begin(), order.begin() + std::min(order.size(), kFrames)) == expected);
+}
+
+void TestBoundedQueue()
+{
+  BoundedQueue<int> queue(2);
+  CHECK(queue.Capacity() == 2);
+  CHECK(queue.Push(1) && queue.Push(2));
+  CHECK(queue.Size() == 2);
+
+  // a full queue blocks the producer until a slot frees
+  std::atomic<bool> pushed{false};
+  std::thread producer([&] { pushed = queue.Push(3); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  CHECK(!pushed);
+  int item = 0;
+  CHECK(queue.Pop(item) && item == 1);
+  producer.join();
+  CHECK(pushed);
+
+  // PopUntil takes what is queued even past its deadline, and gives up on
+  // an empty queue
+  const auto past = std::chrono::steady_clock::now() - std::chrono::seconds(1);
+  CHECK(queue.PopUntil(item, past) && item == 2);
+  CHECK(queue.Pop(item) && item == 3);
+  CHECK(!queue.PopUntil(item, std::chrono::steady_clock::now() + std::chrono::milliseconds(5)));
+
+  // Close() wakes a waiting consumer, and the items left are still handed out
+  std::atomic<bool> popped{true};
+  std::thread consumer([&] {
+    int value;
+    popped = queue.Pop(value);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  queue.Close();
+  consumer.join();
+  CHECK(!popped);
+  CHECK(!queue.Push(4));
+
+  queue.Reopen(0);
+  CHECK(queue.Capacity() == 1 && queue.Size() == 0);
+  CHECK(queue.Push(5));
+  queue.Close();
+  CHECK(queue.Pop(item) && item == 5);
+  CHECK(!queue.Pop(item));
+}
+
+}  // namespace
+
+int main()
+{
+  TestReadyAndSupersede();
+  TestWeightedOrder();
+  TestBoundedQueue();
+  return test::TestResult();
+}
@@ -0,0 +1,80 @@
+// DetectionDecoder: score threshold, best-first order with ties kept in row
+// order, max_boxes, clipping to the frame, malformed outputs, and
+// quantised rows.
+
+#include <cstdint>
+#include <vector>
+
+#include "detection_decoder.h"
+#include "test_check.h"
+
+namespace {
+
+template <typename T>
+OutputView View(const std::vector<T>& rows, ElementType type)
+{
+  OutputView view;
+  view.data = rows.data();
+  view.type = type;
+  view.width = static_cast<int>(rows.size());
+  return view;
+}
+
+void TestFloat()
+{
+  const std::vector<float> rows = {
+      0.1f, 0.1f, 0.2f, 0.2f, 0.5f, 3.0f,    // kept
+      0.5f, 0.5f, 0.1f, 0.1f, 0.05f, 1.0f,   // below min_score
+      -0.2f, 0.8f, 0.4f, 0.4f, 0.9f, 2.0f,   // clipped to the frame
+      1.2f, 0.0f, 0.3f, 0.3f, 0.95f, 4.0f,   // nothing left inside the frame
+      0.0f, 0.0f, 1.0f, 1.0f, 0.5f, 7.0f,    // ties with the first row
+      0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,    // unused
+  };
+  std::vector<ClassResult> boxes;
+  CHECK(DetectionDecoder::Decode(View(rows, ElementType::eFloat32), 1.0f, 0, 0.3f, 10, boxes));
+  CHECK(boxes.size() == 3);
+  if (boxes.size() == 3) {
+    CHECK(boxes[0].top[0].id == 2 && boxes[0].top[0].value == 0.9f && boxes[0].has_box);
+    CHECK(test::Near(boxes[0].box.x, 0.0, 1e-6) && test::Near(boxes[0].box.y, 0.8, 1e-6));
+    CHECK(test::Near(boxes[0].box.width, 0.2, 1e-6) && test::Near(boxes[0].box.height, 0.2, 1e-6));
+    CHECK(boxes[1].top[0].id == 3 && boxes[2].top[0].id == 7);
+    CHECK(boxes[1].count == 1 && test::Near(boxes[1].box.width, 0.2, 1e-6));
+  }
+
+  CHECK(DetectionDecoder::Decode(View(rows, ElementType::eFloat32), 1.0f, 0, 0.3f, 2, boxes));
+  CHECK(boxes.size() == 2);
+
+  // a partial row is not a detector output; the old boxes do not survive it
+  std::vector<float> partial(rows.begin(), rows.begin() + 8);
+  CHECK(!DetectionDecoder::Decode(View(partial, ElementType::eFloat32), 1.0f, 0, 0.3f, 10, boxes));
+  CHECK(boxes.empty());
+  OutputView empty;
+  CHECK(!DetectionDecoder::Decode(empty, 1.0f, 0, 0.3f, 10, boxes));
+}
+
+void TestQuantized()
+{
+  // real = (q - 128) / 100
+  const std::vector<uint8_t> rows = {138, 148, 178, 158, 218, 228, 128, 128, 228, 228, 148, 129};
+  std::vector<ClassResult> boxes;
+  CHECK(DetectionDecoder::Decode(View(rows, ElementType::eUint8), 0.01f, 128, 0.3f, 10, boxes));
+  CHECK(boxes.size() == 1);
+  if (!boxes.empty()) {
+    CHECK(boxes[0].top[0].id == 1 && test::Near(boxes[0].top[0].value, 0.9, 1e-6));
+    CHECK(test::Near(boxes[0].box.x, 0.1, 1e-6) && test::Near(boxes[0].box.y, 0.2, 1e-6));
+    CHECK(test::Near(boxes[0].box.width, 0.5, 1e-6) && test::Near(boxes[0].box.height, 0.3, 1e-6));
+  }
+
+  const std::vector<int8_t> signed_rows = {10, 20, 50, 30, 90, 5};
+  CHECK(DetectionDecoder::Decode(View(signed_rows, ElementType::eInt8), 0.01f, 0, 0.3f, 10, boxes));
+  CHECK(boxes.size() == 1 && boxes[0].top[0].id == 0);
+}
+
+}  // namespace
+
+int main()
+{
+  TestFloat();
+  TestQuantized();
+  return test::TestResult();
+}
@@ -0,0 +1,131 @@
+// MetadataWriter: the JSON and binary record layouts documented in
+// metadata_writer.h, the XML timestamp cache across seconds, and buffer
+// reuse between documents of different sizes.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "host_component.h"
+#include "metadata_writer.h"
+#include "test_check.h"
+
+namespace {
+
+ClassResult Object(int id, float score, bool boxed)
+{
+  ClassResult object;
+  object.count = 1;
+  object.top[0] = {id, score};
+  object.has_box = boxed;
+  if (boxed) { object.box = {0.25f, 0.5f, 0.125f, 0.5f}; }
+  return object;
+}
+
+template <typename T>
+T Read(const std::string& record, size_t& offset)
+{
+  T value;
+  memcpy(&value, record.data() + offset, sizeof(value));
+  offset += sizeof(value);
+  return value;
+}
+
+void TestFromString()
+{
+  MetadataWriter::Format format = MetadataWriter::Format::eJson;
+  CHECK(MetadataWriter::FromString("", format) && format == MetadataWriter::Format::eXml);
+  CHECK(MetadataWriter::FromString("xml", format) && format == MetadataWriter::Format::eXml);
+  CHECK(MetadataWriter::FromString("json", format) && format == MetadataWriter::Format::eJson);
+  CHECK(MetadataWriter::FromString("binary", format) && format == MetadataWriter::Format::eBinary);
+  CHECK(!MetadataWriter::FromString("protobuf", format));
+}
+
+void TestModelId()
+{
+  // FNV-1a 32-bit test vectors
+  CHECK(MetadataWriter::ModelId("") == 0x811c9dc5u);
+  CHECK(MetadataWriter::ModelId("a") == 0xe40c292cu);
+  CHECK(MetadataWriter::ModelId("foobar") == 0xbf9cf968u);
+}
+
+void TestJson()
+{
+  MetadataWriter writer;
+  ClassResult objects[2] = {Object(3, 0.5f, false), Object(7, 0.25f, true)};
+  objects[0].count = 2;
+  objects[0].top[1] = {1, 0.125f};
+  const std::string& json = writer.Write(MetadataWriter::Format::eJson, 42, 2, objects, 2, 1500);
+  CHECK(json == "{\"t\":1500,\"ch\":2,\"model\":42,\"objects\":["
+                "{\"classes\":[[3,0.500000],[1,0.125000]]},"
+                "{\"box\":[0.250000,0.500000,0.125000,0.500000],\"classes\":[[7,0.250000]]}]}");
+
+  // a smaller document after a larger one leaves nothing of it behind
+  CHECK(writer.Write(MetadataWriter::Format::eJson, 42, 2, objects, 0, 1500) ==
+        "{\"t\":1500,\"ch\":2,\"model\":42,\"objects\":[]}");
+}
+
+void TestBinary()
+{
+  MetadataWriter writer;
+  const ClassResult objects[2] = {Object(3, 0.5f, false), Object(7, 0.25f, true)};
+  const std::string text = writer.Write(MetadataWriter::Format::eBinary, 0xdeadbeef, 1, objects, 2, 123456789012ull);
+  auto decoded = Base64::decode(text.data(), text.size());
+  const std::string record(decoded.first.get(), decoded.second);
+
+  size_t offset = 0;
+  CHECK(record.size() == 16 + (4 + 8) + (4 + 16 + 8));
+  CHECK(Read<uint8_t>(record, offset) == MetadataWriter::kBinaryVersion);
+  CHECK(Read<uint8_t>(record, offset) == 1);
+  CHECK(Read<uint16_t>(record, offset) == 2);
+  CHECK(Read<uint32_t>(record, offset) == 0xdeadbeefu);
+  CHECK(Read<uint64_t>(record, offset) == 123456789012ull);
+
+  CHECK(Read<uint8_t>(record, offset) == 1);
+  CHECK(Read<uint8_t>(record, offset) == 0);
+  CHECK(Read<uint16_t>(record, offset) == 0);
+  CHECK(Read<int32_t>(record, offset) == 3);
+  CHECK(Read<float>(record, offset) == 0.5f);
+
+  CHECK(Read<uint8_t>(record, offset) == 1);
+  CHECK(Read<uint8_t>(record, offset) == 1);
+  CHECK(Read<uint16_t>(record, offset) == 0);
+  CHECK(Read<float>(record, offset) == 0.25f);
+  CHECK(Read<float>(record, offset) == 0.5f);
+  CHECK(Read<float>(record, offset) == 0.125f);
+  CHECK(Read<float>(record, offset) == 0.5f);
+  CHECK(Read<int32_t>(record, offset) == 7);
+  CHECK(Read<float>(record, offset) == 0.25f);
+}
+
+void TestXmlTime()
+{
+  MetadataWriter writer;
+  const ClassResult object = Object(5, 0.75f, false);
+  auto time_of = [&writer, &object](uint64_t timestamp_ms) {
+    const std::string& xml = writer.Write(MetadataWriter::Format::eXml, 0, 0, &object, 1, timestamp_ms);
+    const size_t start = xml.find("UtcTime=\"");
+    return start == std::string::npos ? std::string() : xml.substr(start + 9, 24);
+  };
+  CHECK(time_of(1700000000123ull) == "2023-11-14T22:13:20.123Z");
+  CHECK(time_of(1700000000999ull) == "2023-11-14T22:13:20.999Z");
+  // the cached second is replaced, in either direction
+  CHECK(time_of(1700000001000ull) == "2023-11-14T22:13:21.000Z");
+  CHECK(time_of(1700000000007ull) == "2023-11-14T22:13:20.007Z");
+
+  const std::string& xml = writer.Write(MetadataWriter::Format::eXml, 0, 0, &object, 1, 0);
+  CHECK(xml.find("Likelihood=\"0.750000\">5</tt:Type>") != std::string::npos);
+  CHECK(xml.rfind("</tt:MetadataStream>") == xml.size() - strlen("</tt:MetadataStream>"));
+}
+
+}  // namespace
+
+int main()
+{
+  TestFromString();
+  TestModelId();
+  TestJson();
+  TestBinary();
+  TestXmlTime();
+  return test::TestResult();
+}
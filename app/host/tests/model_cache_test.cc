@@ -0,0 +1,170 @@
+// ModelCache: one load per key while references are held, reloading after
+// the last one goes, retry after a failed load, other models acquired while
+// one is still loading, concurrent acquires sharing one load, and Lock().
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "model_cache.h"
+#include "network_registry.h"
+#include "test_check.h"
+
+namespace {
+
+// One-shot signal with a bound on the wait, so a regression fails the check
+// instead of hanging the test.
+class Signal {
+ public:
+  void Set()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    set_ = true;
+    cv_.notify_all();
+  }
+  bool Wait()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(lock, std::chrono::seconds(10), [this] { return set_; });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool set_ = false;
+};
+
+void TestSharing()
+{
+  ModelCache cache;
+  int loads = 0;
+  auto load = [&loads] {
+    loads++;
+    return NetworkRegistry::Create();
+  };
+
+  auto first = cache.Acquire("a", load);
+  auto second = cache.Acquire("a", load);
+  CHECK(first && first.get() == second.get());
+  CHECK(loads == 1);
+  auto other = cache.Acquire("b", load);
+  CHECK(other && other.get() != first.get());
+  CHECK(loads == 2);
+
+  // unloaded with the last reference, loaded again on the next acquire
+  first.reset();
+  CHECK(cache.Acquire("a", load).get() == second.get());
+  second.reset();
+  CHECK(cache.Acquire("a", load) != nullptr);
+  CHECK(loads == 3);
+
+  // a failed load is not remembered
+  int attempts = 0;
+  auto failing = [&attempts] {
+    attempts++;
+    return std::shared_ptr<NeuralNetwork>();
+  };
+  CHECK(cache.Acquire("c", failing) == nullptr);
+  CHECK(cache.Acquire("c", failing) == nullptr);
+  CHECK(attempts == 2);
+  CHECK(cache.Acquire("c", load) != nullptr);
+}
+
+void TestSlowLoad()
+{
+  ModelCache cache;
+  Signal other_acquired;
+  bool waited = false;
+  std::shared_ptr<NeuralNetwork> slow;
+  std::thread loader([&] {
+    slow = cache.Acquire("slow", [&] {
+      // held open until the other model has been acquired meanwhile
+      waited = other_acquired.Wait();
+      return NetworkRegistry::Create();
+    });
+  });
+
+  // give the loader a head start; the check below holds either way
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  auto fast = cache.Acquire("fast", [] { return NetworkRegistry::Create(); });
+  other_acquired.Set();
+  loader.join();
+  CHECK(fast != nullptr && slow != nullptr);
+  CHECK(waited);
+}
+
+void TestConcurrentAcquire()
+{
+  ModelCache cache;
+  std::atomic<int> loads{0};
+  Signal second_started;
+  auto load = [&] {
+    loads++;
+    second_started.Wait();
+    // let the second acquire reach the pending load
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    return NetworkRegistry::Create();
+  };
+
+  std::shared_ptr<NeuralNetwork> a, b;
+  std::thread first([&] { a = cache.Acquire("m", load); });
+  std::thread second([&] {
+    second_started.Set();
+    b = cache.Acquire("m", load);
+  });
+  first.join();
+  second.join();
+  CHECK(a && a.get() == b.get());
+  CHECK(loads == 1);
+}
+
+void TestLock()
+{
+  ModelCache cache;
+  auto shared = cache.Acquire("m", [] { return NetworkRegistry::Create(); });
+  auto lock = ModelCache::Lock(shared);
+  CHECK(lock.owns_lock());
+  // the second reference is the same network, so the same mutex
+  auto again = cache.Acquire("m", [] { return NetworkRegistry::Create(); });
+  std::atomic<bool> locked{false};
+  std::thread other([&] {
+    auto other_lock = ModelCache::Lock(again);
+    locked = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  CHECK(!locked);
+  lock.unlock();
+  other.join();
+  CHECK(locked);
+
+  // a network outside the cache has nothing to share
+  CHECK(!ModelCache::Lock(NetworkRegistry::Create()).owns_lock());
+}
+
+void TestKey()
+{
+  auto network = NetworkRegistry::Create();
+  const std::string key = ModelCache::Key("missing.bin", *network, {1, 2, 3}, {1, 1, 1});
+  CHECK(key == ModelCache::Key("missing.bin", *network, {1, 2, 3}, {1, 1, 1}));
+  CHECK(key != ModelCache::Key("missing.bin", *network, {0, 0, 0}, {1, 1, 1}));
+  CHECK(key != ModelCache::Key("missing.bin", *network, {1, 2, 3}, {2, 2, 2}));
+  CHECK(key != ModelCache::Key("other.bin", *network, {1, 2, 3}, {1, 1, 1}));
+
+  network->CreateInputTensor("data");
+  CHECK(key != ModelCache::Key("missing.bin", *network, {1, 2, 3}, {1, 1, 1}));
+}
+
+}  // namespace
+
+int main()
+{
+  TestSharing();
+  TestSlowLoad();
+  TestConcurrentAcquire();
+  TestLock();
+  TestKey();
+  return test::TestResult();
+}
@@ -0,0 +1,103 @@
+// NetworkRegistry: networks stay out of snapshots until Activate(), a
+// snapshot keeps a removed or replaced network alive until it is dropped,
+// and a reader iterating snapshots runs against create/activate/remove
+// cycles (build with -fsanitize=thread to check the publication itself).
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "network_registry.h"
+#include "test_check.h"
+
+namespace {
+
+void TestLifecycle()
+{
+  NetworkRegistry registry;
+  CHECK(registry.Load()->empty());
+  CHECK(registry.Find("a") == nullptr);
+
+  NeuralNetwork* a = registry.GetOrCreate("a");
+  CHECK(a != nullptr);
+  CHECK(registry.GetOrCreate("a") == a);
+  CHECK(registry.Find("a") == a);
+  // registered, not yet on the frame path
+  CHECK(registry.Load()->empty());
+  CHECK(!registry.Activate("b"));
+  CHECK(registry.Activate("a"));
+  CHECK(registry.Activate("a"));
+  auto snapshot = registry.Load();
+  CHECK(snapshot->size() == 1 && snapshot->at("a").get() == a);
+
+  // a replaced network lives on in the snapshots taken before
+  std::weak_ptr<NeuralNetwork> old = registry.Get("a");
+  auto replacement = NetworkRegistry::Create();
+  CHECK(!registry.Replace("b", replacement));
+  CHECK(!registry.Replace("a", nullptr));
+  CHECK(registry.Replace("a", replacement));
+  CHECK(registry.Find("a") == replacement.get());
+  CHECK(registry.Load()->at("a") == replacement);
+  CHECK(!old.expired());
+  snapshot.reset();
+  CHECK(old.expired());
+
+  // and so does a removed one
+  auto held = registry.Load();
+  std::weak_ptr<NeuralNetwork> current = replacement;
+  replacement.reset();
+  registry.Remove("a");
+  CHECK(registry.Find("a") == nullptr);
+  CHECK(registry.Load()->empty());
+  CHECK(held->count("a") == 1 && !current.expired());
+  held.reset();
+  CHECK(current.expired());
+
+  // an inactive network is removed without touching the snapshot
+  registry.GetOrCreate("c");
+  auto before = registry.Load();
+  registry.Remove("c");
+  CHECK(registry.Load() == before);
+}
+
+void TestConcurrentReaders()
+{
+  NetworkRegistry registry;
+  registry.GetOrCreate("stable");
+  registry.Activate("stable");
+
+  std::atomic<bool> done{false};
+  std::atomic<bool> consistent{true};
+  std::thread reader([&] {
+    while (!done) {
+      auto snapshot = registry.Load();
+      bool stable = false;
+      for (auto& entry : *snapshot) {
+        if (!entry.second) { consistent = false; }
+        stable |= entry.first == "stable";
+      }
+      if (!stable) { consistent = false; }
+    }
+  });
+
+  for (int i = 0; i < 5000; i++) {
+    const std::string name = "n" + std::to_string(i % 4);
+    registry.GetOrCreate(name);
+    registry.Activate(name);
+    if (i % 3 == 0) { registry.Replace(name, NetworkRegistry::Create()); }
+    registry.Remove(name);
+  }
+  done = true;
+  reader.join();
+  CHECK(consistent);
+  CHECK(registry.Load()->size() == 1);
+}
+
+}  // namespace
+
+int main()
+{
+  TestLifecycle();
+  TestConcurrentReaders();
+  return test::TestResult();
+}
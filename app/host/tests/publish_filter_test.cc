@@ -0,0 +1,93 @@
+// PublishFilter: each of the rules in publish_filter.h (object count, top-1
+// change with debounce, score delta, keep-alive), per model and output, and
+// Forget() after a model swap.
+
+#include <string>
+
+#include "publish_filter.h"
+#include "test_check.h"
+
+namespace {
+
+ClassResult Result(int id, float score)
+{
+  ClassResult result;
+  result.count = 2;
+  result.top[0] = {id, score};
+  result.top[1] = {id + 1, 1.0f - score};
+  return result;
+}
+
+PublishFilter Make(uint64_t debounce_ms)
+{
+  PublishFilter filter;
+  PublishFilter::Settings settings;
+  settings.enabled = true;
+  settings.score_delta = 0.1f;
+  settings.keep_alive_ms = 1000;
+  settings.debounce_ms = debounce_ms;
+  filter.Configure(settings);
+  return filter;
+}
+
+void TestDisabled()
+{
+  PublishFilter filter;
+  const ClassResult a = Result(1, 0.9f);
+  for (uint64_t t = 0; t < 5; t++) { CHECK(filter.Admit("m", 0, &a, 1, t)); }
+}
+
+void TestRules()
+{
+  PublishFilter filter = Make(0);
+  const ClassResult a = Result(1, 0.9f);
+  const ClassResult a_close = Result(1, 0.85f);
+  const ClassResult a_far = Result(1, 0.7f);
+  const ClassResult b = Result(4, 0.9f);
+
+  CHECK(filter.Admit("m", 0, &a, 1, 0));         // first message
+  CHECK(!filter.Admit("m", 0, &a, 1, 10));       // unchanged
+  CHECK(!filter.Admit("m", 0, &a_close, 1, 20));  // within the score delta
+  CHECK(filter.Admit("m", 0, &a_far, 1, 30));    // beyond it
+  CHECK(filter.Admit("m", 0, &b, 1, 40));        // top-1 changed
+  CHECK(filter.Admit("m", 0, nullptr, 0, 50));   // object count changed
+  CHECK(!filter.Admit("m", 0, nullptr, 0, 60));
+  CHECK(filter.Admit("m", 0, nullptr, 0, 1050));  // keep-alive
+  // a pts stepping back starts over
+  CHECK(filter.Admit("m", 0, nullptr, 0, 5));
+
+  // models and outputs are tracked apart
+  CHECK(filter.Admit("m", 1, &a, 1, 60));
+  CHECK(filter.Admit("n", 0, &a, 1, 60));
+  CHECK(!filter.Admit("n", 0, &a, 1, 70));
+  filter.Forget("n");
+  CHECK(filter.Admit("n", 0, &a, 1, 80));
+  CHECK(!filter.Admit("m", 1, &a, 1, 80));
+}
+
+void TestDebounce()
+{
+  PublishFilter filter = Make(100);
+  const ClassResult a = Result(1, 0.9f);
+  const ClassResult b = Result(4, 0.9f);
+  const ClassResult c = Result(6, 0.9f);
+
+  CHECK(filter.Admit("m", 0, &a, 1, 0));
+  CHECK(!filter.Admit("m", 0, &b, 1, 10));   // b shows up
+  CHECK(!filter.Admit("m", 0, &a, 1, 50));   // and goes: the window restarts
+  CHECK(!filter.Admit("m", 0, &b, 1, 60));
+  CHECK(!filter.Admit("m", 0, &c, 1, 100));  // a different newcomer restarts it too
+  CHECK(!filter.Admit("m", 0, &c, 1, 150));
+  CHECK(filter.Admit("m", 0, &c, 1, 200));   // c held for 100 ms
+  CHECK(!filter.Admit("m", 0, &c, 1, 210));
+}
+
+}  // namespace
+
+int main()
+{
+  TestDisabled();
+  TestRules();
+  TestDebounce();
+  return test::TestResult();
+}
@@ -0,0 +1,132 @@
+// TemporalSmoother: pass-through with eNone, the bias-corrected EMA (no pull
+// towards 0 on the first frames, classes dropping out decaying), the window
+// mean with a missing class counting as 0, non-finite scores, and Forget().
+
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include "temporal_smoother.h"
+#include "test_check.h"
+
+namespace {
+
+ClassResult Result(std::initializer_list<TopK::Entry> entries)
+{
+  ClassResult result;
+  for (auto& entry : entries) { result.top[result.count++] = entry; }
+  return result;
+}
+
+TemporalSmoother Make(TemporalSmoother::Type type, float alpha, uint32_t window)
+{
+  TemporalSmoother smoother;
+  TemporalSmoother::Settings settings;
+  settings.type = type;
+  settings.alpha = alpha;
+  settings.window = window;
+  smoother.Configure(settings);
+  return smoother;
+}
+
+void TestFromString()
+{
+  TemporalSmoother::Type type = TemporalSmoother::Type::eEma;
+  CHECK(TemporalSmoother::FromString("", type) && type == TemporalSmoother::Type::eNone);
+  CHECK(TemporalSmoother::FromString("ema", type) && type == TemporalSmoother::Type::eEma);
+  CHECK(TemporalSmoother::FromString("window", type) && type == TemporalSmoother::Type::eWindow);
+  CHECK(!TemporalSmoother::FromString("kalman", type));
+}
+
+void TestNone()
+{
+  TemporalSmoother smoother;
+  const ClassResult frame = Result({{1, 0.9f}});
+  CHECK(smoother.Smooth("m", 0, &frame, 1) == &frame);
+}
+
+void TestEma()
+{
+  TemporalSmoother smoother = Make(TemporalSmoother::Type::eEma, 0.25f, 5);
+  const ClassResult a = Result({{1, 0.8f}, {2, 0.2f}});
+
+  // bias correction: a steady input reads as itself from the first frame
+  for (int i = 0; i < 4; i++) {
+    const ClassResult* out = smoother.Smooth("m", 0, &a, 1);
+    CHECK(out[0].count == 2);
+    CHECK(out[0].top[0].id == 1 && test::Near(out[0].top[0].value, 0.8, 1e-5));
+    CHECK(out[0].top[1].id == 2 && test::Near(out[0].top[1].value, 0.2, 1e-5));
+  }
+
+  // one frame of a different class moves the average by alpha
+  const ClassResult b = Result({{3, 0.9f}, {1, 0.1f}});
+  const ClassResult* out = smoother.Smooth("m", 0, &b, 1);
+  const double weight = 1.0 - std::pow(0.75, 5);
+  CHECK(out[0].top[0].id == 1);
+  CHECK(test::Near(out[0].top[0].value, (0.8 * (1.0 - std::pow(0.75, 4)) * 0.75 + 0.25 * 0.1) / weight, 1e-5));
+  CHECK(out[0].top[1].id == 3);
+  CHECK(test::Near(out[0].top[1].value, 0.25 * 0.9 / weight, 1e-5));
+
+  // a NaN score is left out instead of poisoning the class for good
+  const ClassResult nan = Result({{1, std::numeric_limits<float>::quiet_NaN()}, {2, 0.5f}});
+  out = smoother.Smooth("m", 0, &nan, 1);
+  for (uint32_t k = 0; k < out[0].count; k++) { CHECK(std::isfinite(out[0].top[k].value)); }
+  out = smoother.Smooth("m", 0, &a, 1);
+  CHECK(out[0].top[0].id == 1 && std::isfinite(out[0].top[0].value));
+
+  // Forget() starts the model over: the next frame reads as itself
+  smoother.Forget("m");
+  out = smoother.Smooth("m", 0, &b, 1);
+  CHECK(out[0].top[0].id == 3 && test::Near(out[0].top[0].value, 0.9, 1e-5));
+}
+
+void TestEmaDecay()
+{
+  TemporalSmoother smoother = Make(TemporalSmoother::Type::eEma, 0.5f, 5);
+  const ClassResult a = Result({{1, 1.0f}});
+  const ClassResult b = Result({{2, 1.0f}});
+  smoother.Smooth("m", 0, &a, 1);
+  const ClassResult* out = nullptr;
+  for (int i = 0; i < 30; i++) { out = smoother.Smooth("m", 0, &b, 1); }
+  // class 1 has decayed below the floor and is gone; class 2 is all that is left
+  CHECK(out[0].count == 1 && out[0].top[0].id == 2 && test::Near(out[0].top[0].value, 1.0, 1e-5));
+}
+
+void TestWindow()
+{
+  TemporalSmoother smoother = Make(TemporalSmoother::Type::eWindow, 0.3f, 3);
+  const ClassResult a = Result({{1, 0.9f}, {2, 0.1f}});
+  const ClassResult b = Result({{2, 0.6f}, {3, 0.3f}});
+
+  const ClassResult* out = smoother.Smooth("m", 0, &a, 1);
+  CHECK(out[0].top[0].id == 1 && test::Near(out[0].top[0].value, 0.9, 1e-6));
+  out = smoother.Smooth("m", 0, &b, 1);
+  CHECK(out[0].count == 2);
+  CHECK(out[0].top[0].id == 1 && test::Near(out[0].top[0].value, 0.45, 1e-6));
+  CHECK(out[0].top[1].id == 2 && test::Near(out[0].top[1].value, 0.35, 1e-6));
+  out = smoother.Smooth("m", 0, &b, 1);
+  CHECK(out[0].top[0].id == 2 && test::Near(out[0].top[0].value, 1.3 / 3, 1e-6));
+  // |a| leaves the window
+  out = smoother.Smooth("m", 0, &b, 1);
+  CHECK(out[0].top[0].id == 2 && test::Near(out[0].top[0].value, 0.6, 1e-6));
+  CHECK(out[0].top[1].id == 3 && test::Near(out[0].top[1].value, 0.3, 1e-6));
+
+  // outputs and object counts are tracked apart
+  out = smoother.Smooth("m", 1, &a, 1);
+  CHECK(out[0].top[0].id == 1 && test::Near(out[0].top[0].value, 0.9, 1e-6));
+  const ClassResult two[2] = {a, b};
+  out = smoother.Smooth("m", 0, two, 2);
+  CHECK(out[0].top[0].id == 1 && out[1].top[0].id == 2);
+}
+
+}  // namespace
+
+int main()
+{
+  TestFromString();
+  TestNone();
+  TestEma();
+  TestEmaDecay();
+  TestWindow();
+  return test::TestResult();
+}
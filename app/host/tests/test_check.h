@@ -0,0 +1,33 @@
+#pragma once
+
+// Minimal checks for the host unit tests: a failed CHECK reports where and
+// carries on, and main() returns TestResult() so ctest sees the failure.
+
+#include <cmath>
+#include <cstdio>
+
+namespace test {
+
+inline int& Failures()
+{
+  static int failures = 0;
+  return failures;
+}
+
+inline int TestResult()
+{
+  if (Failures() > 0) { fprintf(stderr, "%d check(s) failed\n", Failures()); }
+  return Failures() > 0 ? 1 : 0;
+}
+
+inline bool Near(double a, double b, double tolerance) { return std::fabs(a - b) <= tolerance; }
+
+}  // namespace test
+
+#define CHECK(condition)                                                             \
+  do {                                                                               \
+    if (!(condition)) {                                                              \
+      fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+      test::Failures()++;                                                            \
+    }                                                                                \
+  } while (0)
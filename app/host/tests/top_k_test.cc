@@ -0,0 +1,105 @@
+// TopK::Select against a full stable sort: float probabilities and logits,
+// widths that do and do not fill the SIMD blocks, ties, NaN, and the
+// quantised (uint8/int8) overloads.
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "test_check.h"
+#include "top_k.h"
+
+namespace {
+
+// best first, earlier index on ties
+template <typename T>
+std::vector<TopK::Entry> Reference(const std::vector<T>& data, size_t k)
+{
+  std::vector<TopK::Entry> all;
+  for (size_t i = 0; i < data.size(); i++) {
+    if (data[i] == data[i]) { all.push_back({static_cast<int>(i), static_cast<float>(data[i])}); }
+  }
+  std::stable_sort(all.begin(), all.end(), [](const TopK::Entry& a, const TopK::Entry& b) { return a.value > b.value; });
+  all.resize(std::min(k, all.size()));
+  return all;
+}
+
+template <typename T>
+void CheckAgainstReference(const std::vector<T>& data, size_t k)
+{
+  std::vector<TopK::Entry> out(k);
+  const size_t n = TopK::Select(data.data(), data.size(), k, out.data());
+  const auto expected = Reference(data, k);
+  CHECK(n == expected.size());
+  for (size_t i = 0; i < std::min(n, expected.size()); i++) {
+    CHECK(out[i].id == expected[i].id);
+    CHECK(out[i].value == expected[i].value);
+  }
+}
+
+void TestSmall()
+{
+  const std::vector<float> data = {0.1f, 0.5f, 0.3f, 0.5f, -1.0f, 0.2f};
+  TopK::Entry out[3];
+  CHECK(TopK::Select(data.data(), data.size(), 3, out) == 3);
+  CHECK(out[0].id == 1 && out[0].value == 0.5f);
+  CHECK(out[1].id == 3 && out[1].value == 0.5f);
+  CHECK(out[2].id == 2 && out[2].value == 0.3f);
+
+  // fewer scores than K
+  TopK::Entry all[8];
+  CHECK(TopK::Select(data.data(), 2, 8, all) == 2);
+  CHECK(all[0].id == 1 && all[1].id == 0);
+}
+
+void TestNaN()
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> data(40, -3.0f);
+  data[0] = nan;
+  data[17] = nan;
+  data[18] = -2.0f;
+  data[39] = -1.0f;
+  TopK::Entry out[2];
+  CHECK(TopK::Select(data.data(), data.size(), 2, out) == 2);
+  CHECK(out[0].id == 39 && out[1].id == 18);
+}
+
+void TestRandom()
+{
+  std::mt19937 rng(7);
+  std::normal_distribution<float> logits(0.0f, 4.0f);
+  std::uniform_int_distribution<int> bytes(0, 255);
+  for (size_t width : {1u, 15u, 16u, 63u, 64u, 65u, 1000u, 1001u}) {
+    std::vector<float> f(width);
+    std::vector<uint8_t> u(width);
+    std::vector<int8_t> s(width);
+    for (size_t i = 0; i < width; i++) {
+      f[i] = logits(rng);
+      u[i] = static_cast<uint8_t>(bytes(rng));
+      s[i] = static_cast<int8_t>(bytes(rng) - 128);
+    }
+    for (size_t k : {1u, 5u, 32u}) {
+      CheckAgainstReference(f, k);
+      CheckAgainstReference(u, k);
+      CheckAgainstReference(s, k);
+    }
+  }
+
+  // heavy ties in the quantised range: earlier index wins
+  std::vector<uint8_t> flat(200, 9);
+  flat[150] = 10;
+  CheckAgainstReference(flat, 5);
+}
+
+}  // namespace
+
+int main()
+{
+  TestSmall();
+  TestNaN();
+  TestRandom();
+  return test::TestResult();
+}
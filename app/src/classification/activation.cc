@@ -0,0 +1,175 @@
+#include "activation.h"
+
+#include <cmath>
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ACTIVATION_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ACTIVATION_SSE2 1
+#endif
+
+using namespace std;
+
+namespace {
+
+// Cephes expf: exp(x) = 2^n * exp(r), |r| <= ln2 / 2, degree-6 polynomial,
+// about 2 ulp over the range used here (x <= 0).
+constexpr float kLog2e = 1.44269504088896341f;
+constexpr float kLn2Hi = 0.693359375f;
+constexpr float kLn2Lo = -2.12194440e-4f;
+constexpr float kExpMin = -87.0f;  // exp() below this is treated as 2^-126
+constexpr float kP0 = 1.9875691500e-4f;
+constexpr float kP1 = 1.3981999507e-3f;
+constexpr float kP2 = 8.3334519073e-3f;
+constexpr float kP3 = 4.1665795894e-2f;
+constexpr float kP4 = 1.6666665459e-1f;
+constexpr float kP5 = 5.0000001201e-1f;
+
+#if defined(ACTIVATION_NEON)
+inline float32x4_t Exp(float32x4_t x)
+{
+  x = vmaxq_f32(x, vdupq_n_f32(kExpMin));
+  const int32x4_t n = vcvtnq_s32_f32(vmulq_n_f32(x, kLog2e));
+  const float32x4_t fn = vcvtq_f32_s32(n);
+  float32x4_t r = vmlsq_n_f32(x, fn, kLn2Hi);
+  r = vmlsq_n_f32(r, fn, kLn2Lo);
+
+  float32x4_t p = vdupq_n_f32(kP0);
+  p = vmlaq_f32(vdupq_n_f32(kP1), p, r);
+  p = vmlaq_f32(vdupq_n_f32(kP2), p, r);
+  p = vmlaq_f32(vdupq_n_f32(kP3), p, r);
+  p = vmlaq_f32(vdupq_n_f32(kP4), p, r);
+  p = vmlaq_f32(vdupq_n_f32(kP5), p, r);
+  p = vmlaq_f32(vaddq_f32(r, vdupq_n_f32(1.0f)), p, vmulq_f32(r, r));
+
+  const int32x4_t scale = vshlq_n_s32(vaddq_s32(n, vdupq_n_s32(127)), 23);
+  return vmulq_f32(p, vreinterpretq_f32_s32(scale));
+}
+#elif defined(ACTIVATION_SSE2)
+inline __m128 Exp(__m128 x)
+{
+  x = _mm_max_ps(x, _mm_set1_ps(kExpMin));
+  const __m128i n = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(kLog2e)));
+  const __m128 fn = _mm_cvtepi32_ps(n);
+  __m128 r = _mm_sub_ps(x, _mm_mul_ps(fn, _mm_set1_ps(kLn2Hi)));
+  r = _mm_sub_ps(r, _mm_mul_ps(fn, _mm_set1_ps(kLn2Lo)));
+
+  __m128 p = _mm_set1_ps(kP0);
+  p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(kP1));
+  p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(kP2));
+  p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(kP3));
+  p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(kP4));
+  p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(kP5));
+  p = _mm_add_ps(_mm_mul_ps(p, _mm_mul_ps(r, r)), _mm_add_ps(r, _mm_set1_ps(1.0f)));
+
+  const __m128i scale = _mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23);
+  return _mm_mul_ps(p, _mm_castsi128_ps(scale));
+}
+#endif
+
+void ApplyToTop(Activation::Type type, float lse, TopK::Entry* top, size_t count)
+{
+  switch (type) {
+    case Activation::Type::eSoftmax:
+      for (size_t i = 0; i < count; i++) { top[i].value = exp(top[i].value - lse); }
+      break;
+    case Activation::Type::eSigmoid:
+      for (size_t i = 0; i < count; i++) { top[i].value = 1.0f / (1.0f + exp(-top[i].value)); }
+      break;
+    case Activation::Type::eNone:
+      break;
+  }
+}
+
+// |offset| maps a stored value to 0..255 (128 for int8, 0 for uint8).
+template <typename T>
+void ApplyQuantized(Activation::Type type, const T* data, size_t width, float scale, int32_t zero_point,
+                    int offset, TopK::Entry* top, size_t count)
+{
+  if (count == 0) { return; }
+
+  float lse = 0.0f;
+  if (type == Activation::Type::eSoftmax) {
+    // at most 256 distinct values: count them, then one exp per value
+    // present; the best entry is the largest, so every exponent is <= 0
+    uint32_t histogram[256] = {};
+    for (size_t i = 0; i < width; i++) { histogram[data[i] + offset]++; }
+    float sum = 0.0f;
+    for (int v = 0; v < 256; v++) {
+      if (histogram[v]) { sum += histogram[v] * exp((v - offset - zero_point) * scale - top[0].value); }
+    }
+    lse = top[0].value + log(sum);
+  }
+  ApplyToTop(type, lse, top, count);
+}
+
+}  // namespace
+
+bool Activation::FromString(const string& name, Type& type)
+{
+  if (name.empty() || name == "none") {
+    type = Type::eNone;
+  } else if (name == "softmax") {
+    type = Type::eSoftmax;
+  } else if (name == "sigmoid") {
+    type = Type::eSigmoid;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+float Activation::LogSumExp(const float* data, size_t width, float max_value)
+{
+  if (width == 0 || !isfinite(max_value)) { return max_value; }
+
+  size_t i = 0;
+  float sum = 0.0f;
+#if defined(ACTIVATION_NEON)
+  const float32x4_t m = vdupq_n_f32(max_value);
+  float32x4_t acc0 = vdupq_n_f32(0.0f);
+  float32x4_t acc1 = vdupq_n_f32(0.0f);
+  for (; i + 8 <= width; i += 8) {
+    acc0 = vaddq_f32(acc0, Exp(vsubq_f32(vld1q_f32(data + i), m)));
+    acc1 = vaddq_f32(acc1, Exp(vsubq_f32(vld1q_f32(data + i + 4), m)));
+  }
+  sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#elif defined(ACTIVATION_SSE2)
+  const __m128 m = _mm_set1_ps(max_value);
+  __m128 acc0 = _mm_setzero_ps();
+  __m128 acc1 = _mm_setzero_ps();
+  for (; i + 8 <= width; i += 8) {
+    acc0 = _mm_add_ps(acc0, Exp(_mm_sub_ps(_mm_loadu_ps(data + i), m)));
+    acc1 = _mm_add_ps(acc1, Exp(_mm_sub_ps(_mm_loadu_ps(data + i + 4), m)));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+  sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+  for (; i < width; i++) {
+    sum += exp(data[i] - max_value);
+  }
+  return max_value + log(sum);
+}
+
+void Activation::Apply(Type type, const float* data, size_t width, TopK::Entry* top, size_t count)
+{
+  if (count == 0) { return; }
+
+  const float lse = type == Type::eSoftmax ? LogSumExp(data, width, top[0].value) : 0.0f;
+  ApplyToTop(type, lse, top, count);
+}
+
+void Activation::Apply(Type type, const uint8_t* data, size_t width, float scale, int32_t zero_point,
+                       TopK::Entry* top, size_t count)
+{
+  ApplyQuantized(type, data, width, scale, zero_point, 0, top, count);
+}
+
+void Activation::Apply(Type type, const int8_t* data, size_t width, float scale, int32_t zero_point,
+                       TopK::Entry* top, size_t count)
+{
+  ApplyQuantized(type, data, width, scale, zero_point, 128, top, count);
+}
@@ -0,0 +1,184 @@
+#include "channel_scheduler.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace chrono;
+
+ChannelScheduler& ChannelScheduler::Instance()
+{
+  static ChannelScheduler scheduler;
+  return scheduler;
+}
+
+ChannelScheduler::~ChannelScheduler()
+{
+  {
+    lock_guard<mutex> lock(mutex_);
+    closed_ = true;
+  }
+  wake_cv_.notify_all();
+  if (worker_.joinable()) { worker_.join(); }
+}
+
+void ChannelScheduler::Join(int channel, uint32_t weight, uint32_t max_fps, Handler handler, Ready ready)
+{
+  lock_guard<mutex> control(control_mutex_);
+  {
+    lock_guard<mutex> lock(mutex_);
+    auto& entry = channels_[channel];
+    entry.weight = max<uint32_t>(1, weight);
+    entry.period = max_fps > 0 ? duration_cast<StageClock::duration>(microseconds(1000000 / max_fps))
+                               : StageClock::duration::zero();
+    entry.handler = move(handler);
+    entry.ready = move(ready);
+    closed_ = false;
+  }
+  wake_cv_.notify_all();
+  if (!worker_.joinable()) { worker_ = thread(&ChannelScheduler::WorkerLoop, this); }
+}
+
+void ChannelScheduler::Leave(int channel)
+{
+  lock_guard<mutex> control(control_mutex_);
+  Blob released;
+  bool stop = false;
+  {
+    unique_lock<mutex> lock(mutex_);
+    auto it = channels_.find(channel);
+    if (it == channels_.end()) { return; }
+    idle_cv_.wait(lock, [&it] { return !it->second.busy; });
+    if (it->second.has_pending) { released = move(it->second.pending); }
+    channels_.erase(it);
+    // the worker goes with the last channel
+    stop = channels_.empty();
+    closed_ = stop;
+  }
+  idle_cv_.notify_all();
+  released.ClearResource();
+  if (stop) {
+    wake_cv_.notify_all();
+    if (worker_.joinable()) { worker_.join(); }
+  }
+}
+
+bool ChannelScheduler::IsJoined(int channel)
+{
+  lock_guard<mutex> lock(mutex_);
+  return channels_.count(channel) > 0;
+}
+
+bool ChannelScheduler::Post(int channel, const Blob& blob, StageClock::time_point arrival)
+{
+  Blob superseded;
+  bool dropped = false;
+  {
+    lock_guard<mutex> lock(mutex_);
+    auto it = channels_.find(channel);
+    if (it == channels_.end()) {
+      superseded = blob;
+      dropped = true;
+    } else {
+      if (it->second.has_pending) {
+        superseded = move(it->second.pending);
+        dropped = true;
+      }
+      it->second.pending = blob;
+      it->second.arrival = arrival;
+      it->second.has_pending = true;
+    }
+  }
+  wake_cv_.notify_one();
+  // hand the old frame back to the stream provider outside the lock
+  superseded.ClearResource();
+  return dropped;
+}
+
+void ChannelScheduler::Drain(int channel)
+{
+  unique_lock<mutex> lock(mutex_);
+  idle_cv_.wait(lock, [this, channel] {
+    auto it = channels_.find(channel);
+    return closed_ || it == channels_.end() || (!it->second.has_pending && !it->second.busy);
+  });
+}
+
+void ChannelScheduler::Wake()
+{
+  // taking the lock orders this after a worker that just found no one ready
+  { lock_guard<mutex> lock(mutex_); }
+  wake_cv_.notify_all();
+}
+
+ChannelScheduler::Channels::iterator ChannelScheduler::Next(StageClock::time_point now, StageClock::time_point& wake)
+{
+  wake = StageClock::time_point::max();
+  if (channels_.empty()) { return channels_.end(); }
+
+  // the channel whose turn it is keeps it while it has credit and frames
+  auto it = channels_.find(current_);
+  if (it != channels_.end() && credit_ > 0 && it->second.has_pending && now >= it->second.next_admit &&
+      (!it->second.ready || it->second.ready())) {
+    return it;
+  }
+
+  // otherwise the next one round the ring with a frame it may take now,
+  // the current channel last
+  it = channels_.upper_bound(current_);
+  for (size_t i = 0; i < channels_.size(); i++, ++it) {
+    if (it == channels_.end()) { it = channels_.begin(); }
+    auto& entry = it->second;
+    if (!entry.has_pending) { continue; }
+    if (now < entry.next_admit) {
+      wake = min(wake, entry.next_admit);
+      continue;
+    }
+    // a channel that isn't ready calls Wake() when it is
+    if (entry.ready && !entry.ready()) { continue; }
+    current_ = it->first;
+    credit_ = entry.weight;
+    return it;
+  }
+  return channels_.end();
+}
+
+void ChannelScheduler::WorkerLoop()
+{
+  unique_lock<mutex> lock(mutex_);
+  while (!closed_) {
+    const auto now = StageClock::now();
+    StageClock::time_point wake;
+    auto it = Next(now, wake);
+    if (it == channels_.end()) {
+      if (wake == StageClock::time_point::max()) {
+        wake_cv_.wait(lock);
+      } else {
+        wake_cv_.wait_until(lock, wake);
+      }
+      continue;
+    }
+
+    auto& entry = it->second;
+    credit_--;
+    if (entry.period != StageClock::duration::zero()) {
+      // keep the long-run rate at max_fps, but don't bank credit across a stall
+      entry.next_admit = (now - entry.next_admit > entry.period) ? now + entry.period : entry.next_admit + entry.period;
+    }
+    Blob blob = move(entry.pending);
+    entry.pending = Blob();
+    const auto arrival = entry.arrival;
+    entry.has_pending = false;
+    entry.busy = true;
+    // Join() may replace the handler meanwhile; Leave() waits for |busy|
+    Handler handler = entry.handler;
+
+    lock.unlock();
+    handler(blob, arrival);
+    blob.ClearResource();
+    lock.lock();
+
+    entry.busy = false;
+    idle_cv_.notify_all();
+  }
+  idle_cv_.notify_all();
+}
@@ -1,6 +1,7 @@
 #include "classification.h"
 
 #include <chrono>
+#include <cmath>
 #include <memory>
 
 #include "data_context.h"
@@ -15,8 +16,6 @@
 #include "i_p_stream_provider_manager_video_raw.h"
 #include "i_p_video_frame_raw.h"
 
-#define MAX_SIZE 4096
-
 using namespace std;
 using namespace chrono;
 
@@ -32,11 +31,18 @@ Classification::Classification(ClassID id, const char *name)
 
 Classification::~Classification()
 {
+  if (auto_load_thread_.joinable()) { auto_load_thread_.join(); }
+  if (swap_thread_.joinable()) { swap_thread_.join(); }
+  StopChannelScheduling();
+  StopFrameMailbox();
+  StopPipeline();
 }
 
 bool Classification::Initialize() {
+  boot_ = StageClock::now();
   run_neural_network_info_list = std::make_shared<RunNeuralNetworkInfoList>(GetStringComponentVersion());
   PrepareAttributes(run_neural_network_info_list.get(), GetObjectName());
+  ApplyMetadataFormat();
   std::string manifest_path = "../../config/app_manifest.json";
   ParseManifest(manifest_path, manifest_);
 
@@ -85,6 +91,11 @@ void Classification::HandleRequest(Event* event) {
 
 bool Classification::Finalize()
 {
+  if (auto_load_thread_.joinable()) { auto_load_thread_.join(); }
+  if (swap_thread_.joinable()) { swap_thread_.join(); }
+  StopChannelScheduling();
+  StopFrameMailbox();
+  StopPipeline();
   UnloadNetwork(relative_model_path);
   return Component::Finalize();
 }
@@ -92,25 +103,41 @@ bool Classification::Finalize()
 void Classification::SetMetaFrameSchema() {
   string app_id = manifest_.app_name;
   string schema = "<xs:complexType name=\"MetadataStream\"><xs:sequence><xs:element><xs:complexType name=\"VideoAnalytics\"><xs:sequence><xs:element><xs:complexType name=\"Frame\"><xs:sequence><xs:element><xs:complexType name=\"Object\"><xs:sequence><xs:element><xs:complexType name=\"Appearance\"><xs:sequence><xs:element><xs:complexType name=\"Class\"><xs:sequence><xs:element><xs:complexType name=\"Type\"><xs:simpleContent><xs:extension base=\"xs:string\"><xs:attribute name=\"Likelihood\" type=\"xs:float\"/></xs:extension></xs:simpleContent></xs:complexType></xs:element></xs:sequence></xs:complexType></xs:element></xs:sequence></xs:complexType></xs:element></xs:sequence><xs:attribute name=\"ObjectId\" type=\"xs:integer\"/><xs:attribute name=\"Parent\" type=\"xs:integer\"/></xs:complexType></xs:element></xs:sequence><xs:attribute name=\"UtcTime\" type=\"xs:dateTime\" use=\"required\"/></xs:complexType></xs:element></xs:sequence></xs:complexType></xs:element></xs:sequence></xs:complexType>";
+  string format = "xml";
+  if (metadata_format_ == MetadataWriter::Format::eJson) {
+    format = "json";
+    schema = "{\"type\":\"object\",\"required\":[\"t\",\"ch\",\"model\",\"objects\"],\"properties\":{"
+             "\"t\":{\"type\":\"integer\",\"description\":\"pts, ms since the epoch (UTC)\"},"
+             "\"ch\":{\"type\":\"integer\"},"
+             "\"model\":{\"type\":\"integer\",\"description\":\"FNV-1a 32-bit hash of the model name\"},"
+             "\"objects\":{\"type\":\"array\",\"items\":{\"type\":\"object\",\"required\":[\"classes\"],\"properties\":{"
+             "\"box\":{\"type\":\"array\",\"items\":{\"type\":\"number\"},\"minItems\":4,\"maxItems\":4,\"description\":\"x, y, width, height normalised to the frame\"},"
+             "\"classes\":{\"type\":\"array\",\"items\":{\"type\":\"array\",\"prefixItems\":[{\"type\":\"integer\"},{\"type\":\"number\"}],\"description\":\"[class id, likelihood], best first\"}}"
+             "}}}}}";
+  } else if (metadata_format_ == MetadataWriter::Format::eBinary) {
+    format = "binary";
+    schema = "{\"encoding\":\"base64\",\"byte_order\":\"little-endian\",\"version\":" + to_string(MetadataWriter::kBinaryVersion) + ","
+             "\"header\":[[\"version\",\"u8\"],[\"channel\",\"u8\"],[\"object_count\",\"u16\"],[\"model_id\",\"u32\"],[\"pts_ms\",\"u64\"]],"
+             "\"object\":[[\"class_count\",\"u8\"],[\"flags\",\"u8\"],[\"reserved\",\"u16\"],"
+             "[\"box\",\"f32[4]\",\"flags & 1\"],[\"classes\",\"{i32 id, f32 likelihood}[class_count]\"]]}";
+  }
   string encoding = "base64"; // base64, UTF-8
 
   auto e = Base64::encode(schema.c_str(), schema.size());
   std::string e_s(e.first.get(), e.second);
 
-  auto d = Base64::decode(e_s.c_str(), e_s.size());
-  std::string d_s(d.first.get(), d.second);
-  printf("[CHECK] Decode Base64\n%s\n", d_s.c_str());
-
   JsonUtility::JsonDocument document(JsonUtility::Type::kObjectType);
   auto alloc = document.GetAllocator();
 
   document.AddMember("AppID", app_id, alloc);
   document.AddMember("Schema", e_s, alloc);
   document.AddMember("Encoding", encoding, alloc);
+  document.AddMember("Format", format, alloc);
 
   std::string str_out;
   getJsonString(document, str_out);
-  printf("Add MetaFrameSchema\n");
+  // sent again on every set_metadata_format, so only to the debug log
+  DebugLog("Add MetaFrameSchema (format: %s, %zu bytes)", format.c_str(), schema.size());
 
   SendNoReplyEvent("Stub::Dispatcher::OpenSDK", static_cast<int32_t>(I_OpenSDKCGIDispatcher::EEventType::eMetaFrameSchema), 0, 
                     new ("Schema") Platform_Std_Refine::SerializableString(str_out.c_str()));
@@ -155,11 +182,14 @@ bool Classification::ProcessAEvent(Event *event)
       if (path_info == "/configuration") {
         if (param->GetMethod() == "POST") {
           auto body = param->GetRequestBody();
+          string response_body;
 
-          result = ParseNpuEvent(body);
+          result = ParseNpuEvent(body, response_body);
           if (!result) {
             param->SetStatusCode(400);
             param->SetResponseBody("request error");
+          } else if (!response_body.empty()) {
+            param->SetResponseBody(response_body);
           }
           printf("<< Classification::ParseNpuEvent END (%s)\n", result ? "Pass" : "Fail");
           break;
@@ -200,38 +230,92 @@ bool Classification::ProcessAEvent(Event *event)
 void Classification::Start()
 {
   base::Start();
+  StartAutoLoad();
 }
 
+void Classification::StartAutoLoad()
+{
+  auto& info = run_neural_network_info_list->app_attribute_info;
+  if (info.auto_load != "on") { return; }
+  DebugLog("Auto Load(model_name: %s)", info.model_name.c_str());
 
-NeuralNetwork* Classification::GetOrCreateNetwork(const string& name) {
-  auto* network = GetNetwork(name);
-
-  if (!network) {
-    network = NeuralNetwork::Create();
-    nn_map_[name].reset(network);
+  // the persisted create_network / create_*_tensor requests, then only the
+  // SDK load and a warm-up run leave this thread
+  JsonUtility::JsonDocument document(JsonUtility::Type::kObjectType);
+  document.Parse("{\"model_name\": \"\", \"input_tensor\": \"\", \"output_tensor\": \"\"}");
+  NeuralNetwork* network = nullptr;
+  if (info.model_name.empty() || !CreateNetwork(nullptr, document) ||
+      !(network = GetNetwork(npu_load_info.model_name_)) || !CreateTensor(network, document, "input_tensor") ||
+      !CreateTensor(network, document, "output_tensor") || npu_load_info.input_tensor_names_.empty() ||
+      npu_load_info.output_tensor_names_.empty()) {
+    DebugLog("Failed: Auto Load failed(model_name: %s)", info.model_name.c_str());
+    auto_load_.state = "failed";
+    if (network) { UnloadNetwork(network); }
+    return;
   }
 
-  return network;
+  auto_load_.state = "loading";
+  auto_load_.model_path = ModelPath(npu_load_info.model_name_);
+  auto_load_.preprocess = MakePreprocess(network);
+  const bool shared = info.model_sharing != "off";
+  auto_load_thread_ = thread([this, network = network_registry_.Get(npu_load_info.model_name_), shared] {
+    const auto load_start = StageClock::now();
+    auto loaded = LoadModel(network, auto_load_.model_path, auto_load_.preprocess, shared);
+    const auto warmup_start = StageClock::now();
+    bool warm = false;
+    if (loaded) {
+      auto lock = ModelCache::Lock(loaded);
+      warm = WarmUp(*loaded);
+    }
+    if (warm) { auto_load_.network = move(loaded); }
+    auto_load_.load_ms = duration_cast<milliseconds>(warmup_start - load_start).count();
+    auto_load_.warmup_ms = duration_cast<milliseconds>(StageClock::now() - warmup_start).count();
+    auto_load_ready_ = true;
+  });
 }
 
-NeuralNetwork* Classification::GetNetwork(const string& name) {
-  auto it = nn_map_.find(name);
-  if (it != nn_map_.end()) {
-    return it->second.get();
+void Classification::FinishAutoLoad()
+{
+  // on the event thread, with the next frame or request: nothing else
+  // touches the network until then
+  if (!auto_load_thread_.joinable()) { return; }
+  auto_load_thread_.join();
+  auto_load_ready_ = false;
+
+  auto* network = GetNetwork(npu_load_info.model_name_);
+  if (!auto_load_.network || !network) {
+    DebugLog("Failed: Auto Load failed(model_name: %s)", npu_load_info.model_name_.c_str());
+    auto_load_.state = "failed";
+    UnloadNetwork(network);
+    return;
   }
+  relative_model_path = auto_load_.model_path;
+  preprocess_[npu_load_info.model_name_] = auto_load_.preprocess;
+  network_registry_.Replace(npu_load_info.model_name_, move(auto_load_.network));
+  network_registry_.Activate(npu_load_info.model_name_);
+  RunNetwork(GetNetwork(npu_load_info.model_name_));
+  auto_load_.state = "done";
+  DebugLog("Auto Loaded(model_name: %s, load %" PRIu64 " ms, warm-up %" PRIu64 " ms)", npu_load_info.model_name_.c_str(),
+           auto_load_.load_ms, auto_load_.warmup_ms);
+}
+
 
-  return nullptr;
+NeuralNetwork* Classification::GetOrCreateNetwork(const string& name) {
+  return network_registry_.GetOrCreate(name);
+}
+
+NeuralNetwork* Classification::GetNetwork(const string& name) {
+  return network_registry_.Find(name);
 }
 
-Classification::NeuralNeworkMap& Classification::GetAllNetworks() { return nn_map_; }
+NetworkRegistry::Snapshot Classification::GetAllNetworks() const { return network_registry_.Load(); }
 
 void Classification::RemoveNetwork(const string& name) {
   Log::Print(">> PObjectDetectorAI::%s() START \n", __func__);
-  auto it = nn_map_.find(name);
-  if (it != nn_map_.end()) {
-    it->second.reset();
-    nn_map_.erase(it);
-  }
+  // unloaded once no frame holds it any more
+  network_registry_.Remove(name);
+  preprocess_.erase(name);
+  network_generation_++;
   Log::Print("<< PObjectDetectorAI::%s() END \n", __func__);
 }
 
@@ -240,24 +324,113 @@ void Classification::ProcessRawVideo(Event* event) {
     return;
   }
 
-  auto& network_map = GetAllNetworks();
-  if (network_map.size() == 0) { return; }
+  if (auto_load_ready_) {
+    lock_guard<mutex> config_lock(config_mutex_);
+    FinishAutoLoad();
+  }
+  if (GetAllNetworks()->empty()) { return; }
+
+  const auto arrival = StageClock::now();
+  stage_stats_.FrameArrived(arrival);
+  stage_stats_.Count(StageStats::Counter::eReceived);
 
   auto blob = event->GetBlobArgument();
   event->ClearBaseObjectArgument(); //detach event data
 
-  std::pair<std::variant<BaseObject*, char*>, uint64_t> ret((char*)blob.GetRawData(), blob.GetSize());
+  switch (frame_policy_) {
+    case FramePolicy::eTargetFps:
+      if (arrival < next_admit_) {
+        stage_stats_.Count(StageStats::Counter::eDropped);
+        blob.ClearResource(); //release raw frame without deserializing
+        return;
+      }
+      // keep the long-run rate at target_fps, but don't bank credit across a stall
+      next_admit_ = (arrival - next_admit_ > admit_period_) ? arrival + admit_period_ : next_admit_ + admit_period_;
+      break;
+    case FramePolicy::eLatest:
+      if (frame_mailbox_.IsRunning()) {
+        if (frame_mailbox_.Post(blob, arrival)) {
+          stage_stats_.Count(StageStats::Counter::eDropped);
+        }
+        return;
+      }
+      break;
+    case FramePolicy::eFair:
+      if (channel_scheduled_) {
+        if (ChannelScheduler::Instance().Post(GetChannel(), blob, arrival)) {
+          stage_stats_.Count(StageStats::Counter::eDropped);
+        }
+        return;
+      }
+      break;
+    default:
+      break;
+  }
+
+  ProcessFrame(blob, arrival);
+}
+
+void Classification::ProcessFrame(Blob& blob, StageClock::time_point arrival) {
+  const auto deserialize_start = StageClock::now();
+  // view the blob in place; the raw frame is released with |frame|
+  RawFrame frame = raw_frame_pool_.Acquire(blob);
+  RawImage* img = frame.Image();
+  if (img == nullptr) {
+    return;
+  }
+  stage_stats_.Record(StageStats::Stage::eDeserialize, deserialize_start);
+
+  shared_ptr<FrameJob::Published> reference;
+  if (run_flag && scene_gate_.Enabled()) {
+    const RawImage* source = stream_selector_.Select(img);
+    shared_ptr<const FrameJob::Published> reused;
+    if (source) {
+      lock_guard<mutex> scene_lock(scene_mutex_);
+      if (scene_gate_.Unchanged(*source)) {
+        reused = scene_reference_;
+      } else {
+        // this frame is the reference now, and its result the one to reuse
+        reference = scene_reference_ = make_shared<FrameJob::Published>();
+      }
+    }
+    if (reused) {
+      if (pipeline_.IsRunning()) {
+        // through the pipeline, so the result goes out in frame order and
+        // after the reference frame's own
+        auto job = std::make_unique<FrameJob>();
+        job->pts = img->pts;
+        job->arrival = arrival;
+        job->reuse = std::move(reused);
+        pipeline_.Submit(std::move(job));
+        return;
+      }
+      raw_pts = img->pts;
+      PublishReused(*reused);
+      frame.Reset(); //release raw frame
+      stage_stats_.Record(StageStats::Stage::eFrameTotal, arrival);
+      return;
+    }
+  }
 
-  IPVideoFrameRaw* raw_frame = new ("GetImage") IPLVideoFrameRaw();
-  raw_frame->DeserializeBaseObject(raw_frame, ret);
+  if (pipeline_.IsRunning()) {
+    if (!run_flag) { return; }
 
-  std::shared_ptr<RawImage> img(raw_frame->GetRawImage());
-  if(img == nullptr) {
+    auto job = std::make_unique<FrameJob>();
+    if (!PrepareSource(img, job->image, job->rgb)) {
+      FinishReference(reference, false);
+      return;
+    }
+    job->pts = img->pts;
+    job->arrival = arrival;
+    job->reference = reference;
+    job->source = std::move(frame); //release raw frame once the NPU stage is done with it
+    if (!pipeline_.Submit(std::move(job))) { FinishReference(reference, false); }
     return;
   }
 
-  Inference(img);
-  blob.ClearResource(); //release raw frame
+  Inference(img, reference);
+  frame.Reset(); //release raw frame
+  stage_stats_.Record(StageStats::Stage::eFrameTotal, arrival);
 }
 
 std::string Classification::TimePointToString(uint64_t timestamp) const {
@@ -274,260 +447,1038 @@ bool Classification::UnloadNetwork(const string& model_path)
   DebugLog(">> Classification::%s:%d Start", __func__, __LINE__);
   auto network = GetNetwork(model_path);
   if (!network) { return false; }
-  network->UnloadNetwork();
   RemoveNetwork(model_path);
   DebugLog("<< Classification::%s:%d End", __func__, __LINE__);
   return true;
 }
 
-void Classification::Inference(shared_ptr<RawImage> img)
+void Classification::Inference(const RawImage* img, const shared_ptr<FrameJob::Published>& reference)
 {
   if (!run_flag) { return; }
 
   if (!img) { DebugLog("return @ %s:%d", __func__, __LINE__); return; }
 
-  const shared_ptr<Tensor> rgb(Tensor::Create());
+  const RawImage* source = nullptr;
+  shared_ptr<Tensor> rgb;
+  if (!PrepareSource(img, source, rgb)) {
+    FinishReference(reference, false);
+    return;
+  }
 
-  int images_cnt = 0;
-  for (auto *image = img.get(); image; image = image->next)
+  raw_pts = img->pts;
+  // the networks run side by side on the shared source, those classifying
+  // detector boxes once the detectors are done; their results go out
+  // afterwards, one network at a time
+  ListNetworks();
+  network_results_.resize(network_order_.size());
+  network_workers_.Run(cascade_begin_, [&](size_t n) {
+    auto& result = network_results_[n];
+    result.name = network_order_[n]->first;
+    auto lock = ModelCache::Lock(network_order_[n]->second);
+    result.ok = InferNetwork(result.name, source, rgb, result.objects, result.parsed);
+  });
+  network_workers_.Run(network_order_.size() - cascade_begin_, [&](size_t i) {
+    auto& result = network_results_[cascade_begin_ + i];
+    result.name = network_order_[cascade_begin_ + i]->first;
+    auto lock = ModelCache::Lock(network_order_[cascade_begin_ + i]->second);
+    result.ok = InferCascade(result.name, source, network_results_, result.crops, result.objects, result.parsed);
+  });
+
+  bool inferred = true;
+  bool parsed = true;
+  bool ran = false;
+  for (auto& result : network_results_)
   {
-    if (image->width != 0 && image->height != 0)
+    if (!result.ok) {
+      // the other networks still publish
+      DebugLog("Failed @ %s (network name: %s)", __func__, result.name.c_str());
+      inferred = false;
+      continue;
+    }
+    ran = true;
+    parsed = parsed && result.parsed;
+    for (uint32_t k = 0; k < result.objects.size(); k++)
     {
-      images_cnt++;
+      if (result.objects[k].empty()) { continue; }
+      RememberResult(reference.get(), result.name, k, result.objects[k].data(), result.objects[k].size());
+      SendMetadata(result.name, k, result.objects[k].data(), result.objects[k].size());
     }
   }
+  ReleaseNetworks();
+  // one verdict per frame, over every network that ran
+  if (ran) { parse_result = parsed; }
+  // a result missing an output is not repeated for the frames that follow
+  FinishReference(reference, inferred && parsed);
+  if (inferred) { stage_stats_.Count(StageStats::Counter::eInferred); }
+}
+
+bool Classification::InferNetwork(const string& model_path, const RawImage* source, const shared_ptr<Tensor>& rgb,
+                                  vector<vector<ClassResult>>& objects, bool& parsed)
+{
+  parsed = true;
+  // detectors always take the whole frame
+  const bool detector = detectors_.count(model_path) > 0;
+  if (!crops_.empty() && !detector) { return ExecuteCrops(model_path, source, crops_, objects, parsed); }
+  if (!PreProcess(model_path, source, rgb) || !Execute(model_path)) { return false; }
+  return detector ? DecodeDetections(model_path, 0, objects) : PostProcess(model_path, objects, parsed);
+}
+
+bool Classification::InferCascade(const string& model_path, const RawImage* source,
+                                  const vector<FrameJob::NetworkResult>& results, vector<CropRect>& crops,
+                                  vector<vector<ClassResult>>& objects, bool& parsed)
+{
+  parsed = true;
+  auto cascade = cascades_.find(model_path);
+  if (cascade == cascades_.end()) { return false; }
+  auto detector = detectors_.find(cascade->second.detector);
+  if (detector == detectors_.end()) { return false; }
 
-  if(images_cnt > 1)
+  for (auto& result : results)
   {
-    for (auto *image = img.get(); image; image = image->next)
+    if (result.name != cascade->second.detector) { continue; }
+    if (!result.ok || result.objects.size() <= detector->second.output) { return false; }
+
+    // the detector decoded with the loosest settings of the networks it
+    // feeds, best first
+    crops.clear();
+    for (auto& box : result.objects[detector->second.output])
     {
-      if (image->width < 3840 && image->height < 2160)
-      {
-        if (image->width <= MAX_SIZE && image->height <= MAX_SIZE){
-          if (rgb->Allocate(*image) == false) { return; }
-          break;
-        }
-      }
+      if (crops.size() == cascade->second.max_boxes || box.top[0].value < cascade->second.min_score) { break; }
+      crops.push_back(box.box);
     }
+    return ExecuteCrops(model_path, source, crops, objects, parsed);
+  }
+  return false;
+}
+
+bool Classification::DecodeDetections(const string& model_path, uint32_t slot, vector<vector<ClassResult>>& objects)
+{
+  auto* network = FrameNetwork(model_path);
+  auto detector = detectors_.find(model_path);
+  if (!network || detector == detectors_.end()) { return false; }
+
+  const uint32_t output = detector->second.output;
+  const shared_ptr<Tensor>& output_tensor(network->GetOutputTensor(output));
+  if (!output_tensor || !output_tensor->VirtAddr()) { return false; }
+
+  // only the boxes of a detector are published
+  objects.resize(network->GetOutputTensorCount());
+  for (auto& boxes : objects) { boxes.clear(); }
+
+  const auto parse_start = StageClock::now();
+  const OutputSpec& spec = GetOutputSpec(model_path, output);
+  bool result = DetectionDecoder::Decode(OutputView::Of(*output_tensor, slot), spec.scale, spec.zero_point,
+                                         detector->second.min_score, detector->second.max_boxes, objects[output]);
+  stage_stats_.Record(StageStats::Stage::eParse, parse_start);
+  if (!result) {
+    DebugLog("Failed: output is not in rows of %d (network name: %s, output: %s)", DetectionDecoder::kRowSize,
+             model_path.c_str(), output_tensor->Name().c_str());
   }
-  else
+  return result;
+}
+
+void Classification::ListNetworks()
+{
+  network_snapshot_ = GetAllNetworks();
+  network_order_.clear();
+  for (auto& item : *network_snapshot_)
   {
-    if (rgb->Allocate(*img) == false) { return; }
+    if (cascades_.count(item.first) == 0) { network_order_.push_back(&item); }
   }
+  cascade_begin_ = network_order_.size();
+  for (auto& item : *network_snapshot_)
+  {
+    if (cascades_.count(item.first) > 0) { network_order_.push_back(&item); }
+  }
+}
 
-  if (!rgb) { return; }
+void Classification::ReleaseNetworks()
+{
+  // a network removed meanwhile is unloaded here, on the frame path
+  network_order_.clear();
+  network_snapshot_.reset();
+}
 
-  raw_pts = img->pts;
-  for (auto& item : GetAllNetworks())
-  {
-    auto name = item.first;
+NeuralNetwork* Classification::FrameNetwork(const string& name) const
+{
+  if (!network_snapshot_) { return nullptr; }
+  auto it = network_snapshot_->find(name);
+  return it != network_snapshot_->end() ? it->second.get() : nullptr;
+}
 
-    bool result = PreProcess(name, const_pointer_cast<Tensor>(rgb)) &&
-                  Execute(name) &&
-                  PostProcess(name, rgb);
-    if (!result) {
-      DebugLog("Failed @ %s (network name: %s)", __func__, name.c_str());
-      break;
-    }
+bool Classification::PrepareSource(const RawImage* img, const RawImage*& source, shared_ptr<Tensor>& rgb)
+{
+  const auto allocate_start = StageClock::now();
+
+  source = stream_selector_.Select(img);
+  if (!source) { return false; }
+
+  // the full-size RGB copy is only needed when a network resizes the whole
+  // frame through the SDK; crops, cascades and fused networks read |source|
+  // directly
+  rgb.reset();
+  bool needs_rgb = false;
+  auto networks = GetAllNetworks();
+  for (auto& item : *networks) {
+    if (cascades_.count(item.first) > 0 || (!crops_.empty() && detectors_.count(item.first) == 0)) { continue; }
+    auto it = preprocess_.find(item.first);
+    needs_rgb |= (it == preprocess_.end() || !(it->second.fused || IsBatched(item.first)));
   }
+  if (needs_rgb) {
+    rgb = source_tensor_pool_.Acquire(*source);
+    if (!rgb) { return false; }
+  }
+  stage_stats_.Record(StageStats::Stage::eAllocate, allocate_start);
+
+  return true;
 }
 
-bool Classification::PreProcess(const string& model_path, shared_ptr<Tensor> rgb)
+bool Classification::ExecuteCrops(const string& model_path, const RawImage* source, const vector<CropRect>& crops,
+                                  vector<vector<ClassResult>>& objects, bool& parsed)
 {
-  auto* network = GetNetwork(model_path);
-  if (!network) { return false; }
+  parsed = true;
+  auto* network = FrameNetwork(model_path);
+  auto pre = preprocess_.find(model_path);
+  if (!network || !source || pre == preprocess_.end()) { return false; }
 
-  const shared_ptr<Tensor> &input_tensor(network->GetInputTensor(0));
+  const shared_ptr<Tensor>& input_tensor(network->GetInputTensor(0));
+  if (!input_tensor) { return false; }
   img_size_t size = {
     .width = input_tensor->Length(0),
     .height = input_tensor->Length(1)
   };
+  // networks compiled with a batch dimension take that many crops per run
+  const size_t batch = SdkAccess::Batch(*input_tensor);
 
-  bool result = rgb->Resize(*input_tensor, size);
+  objects.assign(network->GetOutputTensorCount(), {});
+  for (size_t begin = 0; begin < crops.size(); begin += batch)
+  {
+    const size_t count = min(batch, crops.size() - begin);
 
-  return result;
+    const auto resize_start = StageClock::now();
+    for (size_t i = 0; i < count; i++)
+    {
+      if (!pre->second.cpu.Run(*source, *input_tensor, size, &crops[begin + i], static_cast<uint32_t>(i))) { return false; }
+    }
+    stage_stats_.Record(StageStats::Stage::eResize, resize_start);
+
+    if (!Execute(model_path)) { return false; }
+
+    const auto parse_start = StageClock::now();
+    for (uint32_t k = 0; k < network->GetOutputTensorCount(); k++)
+    {
+      const shared_ptr<Tensor>& output_tensor(network->GetOutputTensor(k));
+      if (!output_tensor || !output_tensor->VirtAddr()) { continue; }
+
+      for (size_t i = 0; i < count; i++)
+      {
+        ClassResult object;
+        object.has_box = true;
+        object.box = crops[begin + i];
+        // a crop whose output did not parse is left out
+        if (ParseResult(OutputView::Of(*output_tensor, static_cast<uint32_t>(i)), GetOutputSpec(model_path, k), object)) {
+          objects[k].push_back(object);
+        } else {
+          parsed = false;
+        }
+      }
+    }
+    stage_stats_.Record(StageStats::Stage::eParse, parse_start);
+  }
+  return true;
 }
 
-bool Classification::Execute(const string& model_path)
+bool Classification::IsBatched(const string& model_path) const
 {
-  auto* network = GetNetwork(model_path);
-  if (!network) { return false; }
-
-  stat_t stat = { 0, };
-  return network->RunNetwork(stat);
-  //return true;
+  auto batch_size = batch_sizes_.find(model_path);
+  return batch_size != batch_sizes_.end() && batch_size->second > 1;
 }
 
-bool Classification::PostProcess(const string& model_path, const shared_ptr<Tensor>& img)
+void Classification::UpdateCrops()
 {
-  auto* network = GetNetwork(model_path);
-  if (!network) { return false; }
+  auto& info = run_neural_network_info_list->app_attribute_info;
+  InvalidateLastResults();
 
-  for (uint32_t k = 0; k < network->GetOutputTensorCount(); k++)
+  crops_.clear();
+  // crops are cut by the CPU pass, which reads the raw frame's pixels
+  if (!SdkAccess::kExtended) { return; }
+  for (auto& roi : info.crop_rois)
   {
-    const shared_ptr<Tensor>& output_tensor(network->GetOutputTensor(k));
-    if (!output_tensor) { continue; }
+    crops_.push_back({strtof(roi.x.c_str(), nullptr), strtof(roi.y.c_str(), nullptr),
+                      strtof(roi.width.c_str(), nullptr), strtof(roi.height.c_str(), nullptr)});
+  }
 
-    auto* result_bin = output_tensor->VirtAddr();
-    if (!result_bin) { continue; }
+  unsigned columns = 0, rows = 0;
+  if (sscanf(info.crop_grid.c_str(), "%ux%u", &columns, &rows) == 2 && columns > 0 && rows > 0) {
+    for (unsigned r = 0; r < rows; r++)
+    {
+      for (unsigned c = 0; c < columns; c++)
+      {
+        crops_.push_back({static_cast<float>(c) / columns, static_cast<float>(r) / rows,
+                          1.0f / columns, 1.0f / rows});
+      }
+    }
+  }
+  DebugLog("Crops: %zu (rois: %zu, grid: %s)", crops_.size(), info.crop_rois.size(),
+           info.crop_grid.empty() ? "none" : info.crop_grid.c_str());
+}
 
-    //parse result_bin for dedicated model
-    int width = output_tensor->Length(0);
-    parse_result = ParseResult(static_cast<float*>(result_bin), width);
-    SendMetadata();
+void Classification::UpdateCascades()
+{
+  auto& settings = run_neural_network_info_list->app_attribute_info.cascade_settings;
+
+  cascades_.clear();
+  detectors_.clear();
+  InvalidateLastResults();
+  // boxes are cropped by the CPU pass, like crops
+  if (!SdkAccess::kExtended) { return; }
+  for (auto& setting : settings)
+  {
+    auto* network = GetNetwork(setting.model_name);
+    auto* detector = GetNetwork(setting.detector);
+    if (!network || !detector || setting.model_name == setting.detector) {
+      DebugLog("Cascade skipped: network not loaded (%s -> %s)", setting.detector.c_str(), setting.model_name.c_str());
+      continue;
+    }
+    uint32_t output = 0;
+    while (output < detector->GetOutputTensorCount() && !setting.output_name.empty() &&
+           detector->GetOutputTensor(output)->Name() != setting.output_name) { output++; }
+    if (output >= detector->GetOutputTensorCount()) {
+      DebugLog("Cascade skipped: no output %s (%s)", setting.output_name.c_str(), setting.detector.c_str());
+      continue;
+    }
+
+    CascadeSpec cascade;
+    cascade.detector = setting.detector;
+    if (!setting.min_score.empty()) { cascade.min_score = strtof(setting.min_score.c_str(), nullptr); }
+    if (!setting.max_boxes.empty()) { cascade.max_boxes = static_cast<size_t>(max(1, atoi(setting.max_boxes.c_str()))); }
+    cascades_[setting.model_name] = cascade;
+
+    // decoded once per frame, loose enough for every network it feeds; the
+    // first entry names the output
+    auto it = detectors_.find(setting.detector);
+    if (it == detectors_.end()) {
+      detectors_[setting.detector] = {output, cascade.min_score, cascade.max_boxes};
+    } else {
+      it->second.min_score = min(it->second.min_score, cascade.min_score);
+      it->second.max_boxes = max(it->second.max_boxes, cascade.max_boxes);
+    }
   }
 
-  return true;
+  // one level deep: a detector itself always runs on the whole frame
+  for (auto it = cascades_.begin(); it != cascades_.end();)
+  {
+    if (detectors_.count(it->first) == 0) { ++it; continue; }
+    DebugLog("Cascade skipped: %s is a detector itself", it->first.c_str());
+    it = cascades_.erase(it);
+  }
+  DebugLog("Cascades: %zu (detectors: %zu)", cascades_.size(), detectors_.size());
 }
 
-bool Classification::ParseResult(float* data, int out_width)
+void Classification::ExecuteBatch(const vector<FrameJob*>& jobs)
 {
-  memset(max_id, 0, sizeof(max_id));
-  memset(max_val, 0, sizeof(max_val));
+  vector<FrameJob*> live;
+  for (auto* job : jobs)
+  {
+    if (!job->reuse) { live.push_back(job); }
+  }
+  if (live.empty()) { return; }
+
+  // every network fills its own slot of each job, so the networks run side
+  // by side and a failure stays with the network it happened in; networks
+  // classifying detector boxes follow once the detectors are done
+  ListNetworks();
+  for (auto* job : live) { job->results.resize(network_order_.size()); }
+  network_workers_.Run(cascade_begin_, [&](size_t n) {
+    auto& item = *network_order_[n];
+    // another channel may share the network, its tensors included
+    auto lock = ModelCache::Lock(item.second);
+    const bool detector = detectors_.count(item.first) > 0;
+    if (!crops_.empty() && !detector) {
+      for (auto* job : live)
+      {
+        auto& result = job->results[n];
+        result.name = item.first;
+        result.ok = ExecuteCrops(result.name, job->image, crops_, result.objects, result.parsed);
+      }
+      return;
+    }
+
+    auto batch_size = batch_sizes_.find(item.first);
+    const size_t batch = batch_size != batch_sizes_.end() ? batch_size->second : 1;
+    auto* network = item.second.get();
+    for (size_t begin = 0; begin < live.size(); begin += batch)
+    {
+      const size_t count = min(batch, live.size() - begin);
+
+      bool ok = true;
+      for (size_t i = 0; i < count && ok; i++)
+      {
+        ok = PreProcess(item.first, live[begin + i]->image, live[begin + i]->rgb, static_cast<uint32_t>(i));
+      }
+      ok = ok && Execute(item.first);
 
-  for (int i = 0; i < out_width; i++) {
-    if (max_val[0] < *(data + i)) {
-      max_val[4] = max_val[3], max_id[4] = max_id[3];
-      max_val[3] = max_val[2], max_id[3] = max_id[2];
-      max_val[2] = max_val[1], max_id[2] = max_id[1];
-      max_val[1] = max_val[0], max_id[1] = max_id[0];
-      max_val[0] = *(data + i), max_id[0] = i;
+      // copy the outputs out so the NPU can take the next frames while these
+      // are parsed; detector boxes are needed right away by the next networks
+      for (size_t i = 0; i < count; i++)
+      {
+        auto& result = live[begin + i]->results[n];
+        result.name = item.first;
+        result.ok = ok;
+        if (detector) {
+          result.ok = ok && DecodeDetections(item.first, static_cast<uint32_t>(i), result.objects);
+          continue;
+        }
+        for (uint32_t k = 0; ok && k < network->GetOutputTensorCount(); k++)
+        {
+          const shared_ptr<Tensor>& output_tensor(network->GetOutputTensor(k));
+          if (!output_tensor || !output_tensor->VirtAddr()) { continue; }
+
+          const OutputView view = OutputView::Of(*output_tensor, static_cast<uint32_t>(i));
+          const auto* data = static_cast<const uint8_t*>(view.data);
+          result.outputs.push_back({view.type, view.width, vector<uint8_t>(data, data + view.Bytes())});
+        }
+      }
     }
-    else if (max_val[1] < *(data + i)) {
-      max_val[4] = max_val[3], max_id[4] = max_id[3];
-      max_val[3] = max_val[2], max_id[3] = max_id[2];
-      max_val[2] = max_val[1], max_id[2] = max_id[1];
-      max_val[1] = *(data + i), max_id[1] = i;
+  });
+  network_workers_.Run(network_order_.size() - cascade_begin_, [&](size_t i) {
+    const size_t n = cascade_begin_ + i;
+    auto lock = ModelCache::Lock(network_order_[n]->second);
+    for (auto* job : live)
+    {
+      auto& result = job->results[n];
+      result.name = network_order_[n]->first;
+      result.ok = InferCascade(result.name, job->image, job->results, result.crops, result.objects, result.parsed);
     }
-    else if (max_val[2] < *(data + i)) {
-      max_val[4] = max_val[3], max_id[4] = max_id[3];
-      max_val[3] = max_val[2], max_id[3] = max_id[2];
-      max_val[2] = *(data + i), max_id[2] = i;
+  });
+  ReleaseNetworks();
+}
+
+void Classification::PublishJob(FrameJob& job)
+{
+  // each stage is a single FIFO thread, so jobs already arrive in order; the
+  // pts is wall-clock and may step back (NTP, stream restart) like the sync path's
+  raw_pts = job.pts;
+  if (job.reuse) {
+    PublishReused(*job.reuse);
+    stage_stats_.Record(StageStats::Stage::eFrameTotal, job.arrival);
+    return;
+  }
+  bool inferred = true;
+  bool parsed = true;
+  bool ran = false;
+  for (auto& result : job.results)
+  {
+    if (!result.ok) {
+      // the other networks still publish
+      DebugLog("Failed @ %s (network name: %s)", __func__, result.name.c_str());
+      inferred = false;
+      continue;
     }
-    else if (max_val[3] < *(data + i)) {
-      max_val[4] = max_val[3], max_id[4] = max_id[3];
-      max_val[3] = *(data + i), max_id[3] = i;
+    ran = true;
+    parsed = parsed && result.parsed;
+    for (uint32_t k = 0; k < result.outputs.size(); k++)
+    {
+      auto& output = result.outputs[k];
+      if (!PublishResult(result.name, k, {output.bytes.data(), output.type, output.width}, job.reference.get())) {
+        parsed = false;
+      }
     }
-    else if (max_val[4] < *(data + i)) {
-      max_val[4] = *(data + i), max_id[4] = i;
+    for (uint32_t k = 0; k < result.objects.size(); k++)
+    {
+      if (result.objects[k].empty()) { continue; }
+      RememberResult(job.reference.get(), result.name, k, result.objects[k].data(), result.objects[k].size());
+      SendMetadata(result.name, k, result.objects[k].data(), result.objects[k].size());
     }
   }
+  // one verdict per frame, over every network that ran
+  if (ran) { parse_result = parsed; }
+  // a result missing an output is not repeated for the frames that follow
+  FinishReference(job.reference, inferred && parsed);
+  if (inferred) { stage_stats_.Count(StageStats::Counter::eInferred); }
+  stage_stats_.Record(StageStats::Stage::eFrameTotal, job.arrival);
+}
 
-  DebugLog("[class, prob] Top 5: [%d, %f] [%d, %f] [%d, %f] [%d, %f] [%d, %f]",
-      max_id[0], max_val[0],
-      max_id[1], max_val[1],
-      max_id[2], max_val[2],
-      max_id[3], max_val[3],
-      max_id[4], max_val[4]);
+void Classification::StartPipeline()
+{
+  auto& info = run_neural_network_info_list->app_attribute_info;
+  if (info.inference_mode != "pipelined" || !run_flag || pipeline_.IsRunning()) { return; }
 
-  for (int i = 0; i < 5 ; i++) {
-    if (max_val[i] < 0.0 || max_val[i] > 1.0) {
-      DebugLog("Failed: False probability! [class, prob]: [%d, %f]", max_id[i], max_val[i]);
-      return false;
-    }
+  size_t depth = 2;
+  if (!info.pipeline_queue_depth.empty()) {
+    depth = static_cast<size_t>(max(1, atoi(info.pipeline_queue_depth.c_str())));
   }
 
-  return true;
+  // frames are gathered for the largest batch, within the tightest wait of
+  // the models that batch; crops already fill the batch within one frame
+  size_t max_batch = 1;
+  int max_wait_ms = -1;
+  batch_sizes_.clear();
+  auto networks = GetAllNetworks();
+  for (auto& item : *networks)
+  {
+    // networks on detector boxes batch the boxes of one frame instead
+    if (cascades_.count(item.first) > 0) { continue; }
+    const shared_ptr<Tensor>& input_tensor(item.second->GetInputTensor(0));
+    size_t batch = input_tensor ? SdkAccess::Batch(*input_tensor) : 1;
+    int wait_ms = 0;
+    for (auto& setting : info.batch_settings)
+    {
+      if (setting.model_name != item.first) { continue; }
+      if (!setting.batch_size.empty()) {
+        batch = min<size_t>(batch, max(1, atoi(setting.batch_size.c_str())));
+      }
+      wait_ms = max(0, atoi(setting.max_wait_ms.c_str()));
+    }
+    batch_sizes_[item.first] = batch;
+    if (batch > 1) {
+      max_batch = max(max_batch, batch);
+      max_wait_ms = max_wait_ms < 0 ? wait_ms : min(max_wait_ms, wait_ms);
+    }
+  }
+  if (!crops_.empty()) { max_batch = 1; }
+  max_wait_ms = max(0, max_wait_ms);
+
+  pipeline_.SetBatching(max_batch, milliseconds(max_wait_ms));
+  pipeline_.Start(depth,
+                  [this](const vector<FrameJob*>& jobs) { ExecuteBatch(jobs); },
+                  [this](FrameJob& job) {
+                    PublishJob(job);
+                    // the job has left the execute queue, so the scheduler may hand this channel another frame
+                    if (channel_scheduled_) { ChannelScheduler::Instance().Wake(); }
+                  });
+  DebugLog("Pipelined inference started (queue depth: %zu, batch: %zu, max wait: %dms)", depth, max_batch, max_wait_ms);
 }
 
-string Classification::GetXml(const int* max_id, const float* max_val, const int64_t timestamp) {
-  string str_time = TimePointToString(timestamp);
-  string str_object_id = "2";
+void Classification::ApplyFramePolicy()
+{
+  auto& info = run_neural_network_info_list->app_attribute_info;
+
+  frame_policy_ = FramePolicy::eEvery;
+  if (info.frame_policy == "latest") {
+    frame_policy_ = FramePolicy::eLatest;
+  } else if (info.frame_policy == "target_fps") {
+    int fps = atoi(info.target_fps.c_str());
+    if (fps > 0) {
+      frame_policy_ = FramePolicy::eTargetFps;
+      admit_period_ = duration_cast<StageClock::duration>(microseconds(1000000 / fps));
+      next_admit_ = StageClock::time_point();
+    }
+  } else if (info.frame_policy == "fair") {
+    frame_policy_ = FramePolicy::eFair;
+  }
 
-  string star_xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
-  string MetadataStream = "<tt:MetadataStream xmlns:tt=\"http://www.onvif.org/ver10/schema\" xmlns:ttr=\"https://www.onvif.org/ver20/analytics/radiometry\" xmlns:wsnt=\"http://docs.oasis-open.org/wsn/b-2\" xmlns:tns1=\"http://www.onvif.org/ver10/topics\" xmlns:tnssamsung=\"http://www.samsungcctv.com/2011/event/topics\" xmlns:fc=\"http://www.onvif.org/ver20/analytics/humanface\" xmlns:bd=\"http://www.onvif.org/ver20/analytics/humanbody\"><tt:VideoAnalytics>";
-  string utc_time = "<tt:Frame UtcTime=\"" + str_time + "\">";
-  string object = "<tt:Object ObjectId=\"" + str_object_id + "\"><tt:Appearance><tt:Class>";
-  string typedata_0 = "<tt:Type Likelihood=\"" + to_string(max_val[0]) + "\">" + to_string(max_id[0]) + "</tt:Type>";
-  string typedata_1 = "<tt:Type Likelihood=\"" + to_string(max_val[1]) + "\">" + to_string(max_id[1]) + "</tt:Type>";
-  string typedata_2 = "<tt:Type Likelihood=\"" + to_string(max_val[2]) + "\">" + to_string(max_id[2]) + "</tt:Type>";
-  string typedata_3 = "<tt:Type Likelihood=\"" + to_string(max_val[3]) + "\">" + to_string(max_id[3]) + "</tt:Type>";
-  string typedata_4 = "<tt:Type Likelihood=\"" + to_string(max_val[4]) + "\">" + to_string(max_id[4]) + "</tt:Type>";
-  string end_xml = "</tt:Class></tt:Appearance></tt:Object></tt:Frame></tt:VideoAnalytics></tt:MetadataStream>";
+  if (frame_policy_ == FramePolicy::eLatest && run_flag) {
+    if (!frame_mailbox_.IsRunning()) {
+      frame_mailbox_.Start([this](Blob& blob, StageClock::time_point arrival) { ProcessFrame(blob, arrival); });
+    }
+  } else {
+    StopFrameMailbox();
+  }
+  if (frame_policy_ == FramePolicy::eFair && run_flag) {
+    // the frames of every channel in the process share one inference thread
+    ChannelScheduler::Instance().Join(GetChannel(), max(1, atoi(info.channel_weight.c_str())),
+                                      max(0, atoi(info.channel_max_fps.c_str())),
+                                      [this](Blob& blob, StageClock::time_point arrival) { ProcessFrame(blob, arrival); },
+                                      // a full pipeline would block every channel; PublishJob wakes it
+                                      [this] { return !pipeline_.IsRunning() || pipeline_.CanSubmit(); });
+    channel_scheduled_ = true;
+  } else {
+    StopChannelScheduling();
+  }
+  DebugLog("Frame policy: %s", info.frame_policy.empty() ? "every" : info.frame_policy.c_str());
+}
 
-  string xml_data = star_xml + MetadataStream + utc_time + object + typedata_0 + typedata_1 + typedata_2 + typedata_3 + typedata_4 + end_xml;
+void Classification::ApplyMetadataFormat()
+{
+  auto& info = run_neural_network_info_list->app_attribute_info;
 
-  return xml_data;
+  if (!MetadataWriter::FromString(info.metadata_format, metadata_format_)) {
+    metadata_format_ = MetadataWriter::Format::eXml;
+  }
+  DebugLog("Metadata format: %s", info.metadata_format.empty() ? "xml" : info.metadata_format.c_str());
 }
 
+void Classification::ApplyPublishPolicy()
+{
+  auto& info = run_neural_network_info_list->app_attribute_info;
+
+  PublishFilter::Settings settings;
+  settings.enabled = info.publish_mode == "on_change";
+  if (!info.publish_score_delta.empty()) { settings.score_delta = strtof(info.publish_score_delta.c_str(), nullptr); }
+  if (!info.publish_keep_alive_ms.empty()) { settings.keep_alive_ms = strtoull(info.publish_keep_alive_ms.c_str(), nullptr, 10); }
+  if (!info.publish_debounce_ms.empty()) { settings.debounce_ms = strtoull(info.publish_debounce_ms.c_str(), nullptr, 10); }
+  publish_filter_.Configure(settings);
+  DebugLog("Publish policy: %s (score delta: %f, keep-alive: %llums, debounce: %llums)",
+           settings.enabled ? "on_change" : "every", settings.score_delta,
+           static_cast<unsigned long long>(settings.keep_alive_ms), static_cast<unsigned long long>(settings.debounce_ms));
+}
 
-void Classification::SendMetadata() {
-  if (GetChannel() == 0) {
-    auto timestamp = raw_pts;
-    auto metadata = StringMetadata(GetChannel(), timestamp);
-    metadata.Set(GetXml(max_id, max_val, timestamp));
+void Classification::ApplySmoothing()
+{
+  auto& info = run_neural_network_info_list->app_attribute_info;
+
+  TemporalSmoother::Settings settings;
+  if (!TemporalSmoother::FromString(info.smoothing, settings.type)) { settings.type = TemporalSmoother::Type::eNone; }
+  if (!info.smoothing_alpha.empty()) { settings.alpha = strtof(info.smoothing_alpha.c_str(), nullptr); }
+  if (!info.smoothing_window.empty()) { settings.window = static_cast<uint32_t>(atoi(info.smoothing_window.c_str())); }
+  smoother_.Configure(settings);
+  DebugLog("Smoothing: %s (alpha: %f, window: %u)", info.smoothing.empty() ? "none" : info.smoothing.c_str(),
+           settings.alpha, settings.window);
+}
 
-    auto req = new ("MetadataRequest") IPMetadataManager::StringMetadataRequest();
-    req->SetStringMetadata(std::move(metadata));
+void Classification::ApplySceneGate()
+{
+  auto& info = run_neural_network_info_list->app_attribute_info;
 
-    SendNoReplyEvent("MetadataManager", static_cast<int32_t>(IMetadataManager::EEventType::eRequestRawMetadata), 0, req);
+  SceneGate::Settings settings;
+  settings.enabled = SdkAccess::kExtended && info.scene_gate == "on";
+  if (!info.scene_threshold.empty()) { settings.threshold = strtof(info.scene_threshold.c_str(), nullptr); }
+  if (!info.scene_refresh_ms.empty()) { settings.refresh_ms = strtoull(info.scene_refresh_ms.c_str(), nullptr, 10); }
+  {
+    lock_guard<mutex> scene_lock(scene_mutex_);
+    scene_gate_.Configure(settings);
   }
+  InvalidateLastResults();
+  DebugLog("Scene gate: %s (threshold: %f, refresh: %llums)", settings.enabled ? "on" : "off", settings.threshold,
+           static_cast<unsigned long long>(settings.refresh_ms));
 }
 
-bool Classification::ParseNpuEvent(const string& body)
+void Classification::ApplyNetworkConcurrency()
 {
-  bool result = true;
+  auto& info = run_neural_network_info_list->app_attribute_info;
+
+  // the calling thread runs one of the networks itself
+  const size_t networks = GetAllNetworks()->size();
+  const bool parallel = info.network_concurrency != "sequential";
+  network_workers_.Resize(parallel && networks > 1 ? networks - 1 : 0);
+  DebugLog("Network concurrency: %s (networks: %zu, worker threads: %zu)", parallel ? "parallel" : "sequential",
+           networks, network_workers_.Size());
+}
 
-  DebugLog(">> Classification::%s START", __func__);
+void Classification::RememberResult(FrameJob::Published* reference, const string& model_path, uint32_t output,
+                                    const ClassResult* objects, size_t count)
+{
+  if (!reference) { return; }
 
-  NeuralNetwork* network = nullptr;
-  if (npu_load_info.model_name_.size() > 0)
+  auto& outputs = reference->results[model_path];
+  if (outputs.size() <= output) { outputs.resize(output + 1); }
+  outputs[output].assign(objects, objects + count);
+}
+
+void Classification::PublishReused(const FrameJob::Published& reference)
+{
+  // the frame it matched failed or was dropped, so there is nothing to repeat
+  if (!reference.ok) {
+    stage_stats_.Count(StageStats::Counter::eDropped);
+    return;
+  }
+  stage_stats_.Count(StageStats::Counter::eReused);
+  for (auto& item : reference.results)
   {
-    network = GetNetwork(npu_load_info.model_name_);
+    for (uint32_t k = 0; k < item.second.size(); k++)
+    {
+      auto& objects = item.second[k];
+      if (!objects.empty()) { SendMetadata(item.first, k, objects.data(), objects.size()); }
+    }
   }
- 
-  JsonUtility::JsonDocument document(JsonUtility::Type::kObjectType);
+}
 
-  document.Parse(body);
-  if (document.HasParseError()) {
-    return false;
+void Classification::FinishReference(const shared_ptr<FrameJob::Published>& reference, bool published)
+{
+  if (!reference) { return; }
+  reference->ok = published;
+  if (published) { return; }
+  // without a complete result to repeat, the next frame is inferred
+  lock_guard<mutex> scene_lock(scene_mutex_);
+  if (scene_reference_ == reference) {
+    scene_gate_.Reset();
+    scene_reference_.reset();
   }
+}
 
-  switch (HashStr(document["mode"].GetString()))
+void Classification::InvalidateLastResults()
+{
+  // the next frame is inferred
+  lock_guard<mutex> scene_lock(scene_mutex_);
+  scene_gate_.Reset();
+  scene_reference_.reset();
+}
+
+void Classification::ForgetSwappedModels()
+{
+  // smoother_ and publish_filter_ belong to the publishing thread, the swap
+  // thread only leaves the names here
+  vector<string> swapped;
   {
-    case HashStr("create_network"):{
-      result = CreateNetwork(network, document);
-      break;
-    }
-    case HashStr("create_input_tensor"):{
-      result = CreateTensor(network, document, "input_tensor");
-      break;
-    }
-    case HashStr("create_output_tensor"):{
-      result = CreateTensor(network, document, "output_tensor");
-      break;
-    }
-    case HashStr("load_network"):{
-      result = LoadNetwork(network);
-      break;
-    }
-    case HashStr("run_network"):{
-      result = RunNetwork(network);
-      break;
-    }
-    case HashStr("check_parse_result"):{
-      result = CheckParseResult(network);
-      break;
-    }
-    case HashStr("unload_network"):{
-      result = UnloadNetwork(network);
-      break;
-    }
-    case HashStr("get_input_tensor_name"):{
-      result = GetTensorName(network, document, "input_tensor");
-      break;
-    }
-    case HashStr("get_output_tensor_name"):{
-      result = GetTensorName(network, document, "output_tensor");
-      break;
-    }
-    case HashStr("get_input_tensor_index"):{
-      result = GetTensorIndex(network, document, "input_tensor");
-      break;
+    lock_guard<mutex> swapped_lock(swapped_models_mutex_);
+    swapped.swap(swapped_models_);
+    has_swapped_models_ = false;
+  }
+  for (auto& model_path : swapped) {
+    smoother_.Forget(model_path);
+    publish_filter_.Forget(model_path);
+  }
+}
+
+void Classification::UpdateStreamRequirement()
+{
+  // one source tensor feeds every network, so it has to cover the largest input
+  StreamSelector::Requirement requirement;
+  auto& overrides = run_neural_network_info_list->app_attribute_info.stream_overrides;
+  auto networks = GetAllNetworks();
+  for (auto& item : *networks)
+  {
+    const shared_ptr<Tensor>& input_tensor(item.second->GetInputTensor(0));
+    if (input_tensor) {
+      requirement.min_width = max(requirement.min_width, input_tensor->Length(0));
+      requirement.min_height = max(requirement.min_height, input_tensor->Length(1));
     }
-    case HashStr("get_output_tensor_index"):{
-      result = GetTensorIndex(network, document, "output_tensor");
-      break;
+
+    for (auto& stream_override : overrides)
+    {
+      if (stream_override.model_name != item.first) { continue; }
+      requirement.min_width = max<uint32_t>(requirement.min_width, atoi(stream_override.min_width.c_str()));
+      requirement.min_height = max<uint32_t>(requirement.min_height, atoi(stream_override.min_height.c_str()));
+      if (requirement.stream_index < 0 && !stream_override.stream_index.empty()) {
+        requirement.stream_index = atoi(stream_override.stream_index.c_str());
+      }
+    }
+  }
+  stream_selector_.SetRequirement(requirement);
+  DebugLog("Stream requirement: %ux%u (stream index: %d)", requirement.min_width, requirement.min_height, requirement.stream_index);
+}
+
+void Classification::StopChannelScheduling()
+{
+  if (!channel_scheduled_) { return; }
+  ChannelScheduler::Instance().Leave(GetChannel());
+  channel_scheduled_ = false;
+}
+
+void Classification::StopFrameMailbox()
+{
+  if (!frame_mailbox_.IsRunning()) { return; }
+  frame_mailbox_.Stop();
+}
+
+void Classification::StopPipeline()
+{
+  if (!pipeline_.IsRunning()) { return; }
+  pipeline_.Stop();
+  batch_sizes_.clear();
+  DebugLog("Pipelined inference stopped");
+}
+
+bool Classification::PreProcess(const string& model_path, const RawImage* source, shared_ptr<Tensor> rgb, uint32_t slot)
+{
+  auto* network = FrameNetwork(model_path);
+  if (!network) { return false; }
+
+  const shared_ptr<Tensor> &input_tensor(network->GetInputTensor(0));
+  img_size_t size = {
+    .width = input_tensor->Length(0),
+    .height = input_tensor->Length(1)
+  };
+
+  const auto resize_start = StageClock::now();
+  bool result = false;
+  auto pre = preprocess_.find(model_path);
+  if (pre != preprocess_.end() && (pre->second.fused || IsBatched(model_path))) {
+    // Tensor::Resize only fills the first image of a batched input
+    result = source && pre->second.cpu.Run(*source, *input_tensor, size, nullptr, slot);
+  } else {
+    // |rgb| is shared by every network and only read, but the SDK does not
+    // promise Tensor::Resize is reentrant, so concurrent networks take turns
+    lock_guard<mutex> lock(sdk_resize_mutex_);
+    result = rgb && rgb->Resize(*input_tensor, size);
+  }
+  stage_stats_.Record(StageStats::Stage::eResize, resize_start);
+
+  return result;
+}
+
+bool Classification::Execute(const string& model_path)
+{
+  auto* network = FrameNetwork(model_path);
+  if (!network) { return false; }
+
+  stat_t stat = { 0, };
+  const auto execute_start = StageClock::now();
+  bool result = network->RunNetwork(stat);
+  stage_stats_.Record(StageStats::Stage::eExecute, execute_start);
+  if (result) {
+    stage_stats_.Record(StageStats::Stage::eNpuPre, stat.pre_time);
+    stage_stats_.Record(StageStats::Stage::eNpuRun, stat.run_time);
+    stage_stats_.Record(StageStats::Stage::eNpuPost, stat.post_time);
+  }
+  return result;
+}
+
+bool Classification::PostProcess(const string& model_path, vector<vector<ClassResult>>& objects, bool& parsed)
+{
+  parsed = true;
+  auto* network = FrameNetwork(model_path);
+  if (!network) { return false; }
+
+  objects.resize(network->GetOutputTensorCount());
+  for (uint32_t k = 0; k < network->GetOutputTensorCount(); k++)
+  {
+    objects[k].clear();
+    const shared_ptr<Tensor>& output_tensor(network->GetOutputTensor(k));
+    if (!output_tensor) { continue; }
+
+    auto* result_bin = output_tensor->VirtAddr();
+    if (!result_bin) { continue; }
+
+    //parse result_bin for dedicated model
+    const auto parse_start = StageClock::now();
+    ClassResult result;
+    const bool ok = ParseResult(OutputView::Of(*output_tensor), GetOutputSpec(model_path, k), result);
+    stage_stats_.Record(StageStats::Stage::eParse, parse_start);
+    // an output that did not parse is left out; the others still publish
+    if (ok) {
+      objects[k].push_back(result);
+    } else {
+      parsed = false;
+    }
+  }
+
+  return true;
+}
+
+bool Classification::PublishResult(const string& model_path, uint32_t output, const OutputView& view,
+                                   FrameJob::Published* reference)
+{
+  const auto parse_start = StageClock::now();
+  ClassResult result;
+  const bool parsed = ParseResult(view, GetOutputSpec(model_path, output), result);
+  stage_stats_.Record(StageStats::Stage::eParse, parse_start);
+  // an empty or non-finite output is neither sent nor repeated
+  if (!parsed) { return false; }
+  RememberResult(reference, model_path, output, &result, 1);
+  SendMetadata(model_path, output, &result, 1);
+  return true;
+}
+
+template <typename T>
+uint32_t Classification::SelectQuantized(const T* data, size_t width, const OutputSpec& spec, TopK::Entry* top)
+{
+  // a positive scale keeps the order, so only the winners are dequantised
+  const size_t count = TopK::Select(data, width, spec.top_k, top);
+  for (size_t i = 0; i < count; i++) {
+    top[i].value = (top[i].value - spec.zero_point) * spec.scale;
+  }
+  Activation::Apply(spec.activation, data, width, spec.scale, spec.zero_point, top, count);
+  return static_cast<uint32_t>(count);
+}
+
+const Classification::OutputSpec& Classification::GetOutputSpec(const string& model_path, uint32_t output) const
+{
+  static const OutputSpec default_spec;
+  auto specs = output_specs_.find(model_path);
+  if (specs == output_specs_.end() || output >= specs->second.size()) { return default_spec; }
+  return specs->second[output];
+}
+
+void Classification::UpdateOutputSpecs()
+{
+  auto& settings = run_neural_network_info_list->app_attribute_info.output_settings;
+
+  output_specs_.clear();
+  InvalidateLastResults();
+  auto networks = GetAllNetworks();
+  for (auto& item : *networks)
+  {
+    auto& specs = output_specs_[item.first];
+    specs.resize(item.second->GetOutputTensorCount());
+    for (uint32_t k = 0; k < specs.size(); k++)
+    {
+      const shared_ptr<Tensor>& output_tensor(item.second->GetOutputTensor(k));
+      // fields set for a named output win over those set for the whole model
+      for (bool named : {false, true})
+      {
+        for (auto& setting : settings)
+        {
+          if (setting.model_name != item.first || setting.output_name.empty() == named) { continue; }
+          if (named && (!output_tensor || output_tensor->Name() != setting.output_name)) { continue; }
+          if (!setting.top_k.empty()) {
+            specs[k].top_k = min<uint32_t>(ClassResult::kMaxTopK, max(1, atoi(setting.top_k.c_str())));
+          }
+          if (!setting.activation.empty()) {
+            Activation::FromString(setting.activation, specs[k].activation);
+          }
+          if (!setting.scale.empty()) {
+            specs[k].scale = strtof(setting.scale.c_str(), nullptr);
+          }
+          if (!setting.zero_point.empty()) {
+            specs[k].zero_point = atoi(setting.zero_point.c_str());
+          }
+        }
+      }
+    }
+  }
+}
+
+bool Classification::ParseResult(const OutputView& output, const OutputSpec& spec, ClassResult& result)
+{
+  const size_t width = max(0, output.width);
+  switch (output.type) {
+    case ElementType::eUint8:
+      result.count = SelectQuantized(static_cast<const uint8_t*>(output.data), width, spec, result.top);
+      break;
+    case ElementType::eInt8:
+      result.count = SelectQuantized(static_cast<const int8_t*>(output.data), width, spec, result.top);
+      break;
+    default: {
+      const auto* data = static_cast<const float*>(output.data);
+      result.count = static_cast<uint32_t>(TopK::Select(data, width, spec.top_k, result.top));
+      Activation::Apply(spec.activation, data, width, result.top, result.count);
+      break;
+    }
+  }
+  if (result.count == 0) {
+    DebugLog("Failed: empty output");
+    return false;
+  }
+
+  DebugLog("[class, score] Top %u: [%d, %f] ...", result.count, result.top[0].id, result.top[0].value);
+
+  // logits may be negative, but never NaN or infinite
+  for (uint32_t i = 0; i < result.count; i++) {
+    if (!isfinite(result.top[i].value)) {
+      DebugLog("Failed: False score! [class, score]: [%d, %f]", result.top[i].id, result.top[i].value);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void Classification::SendMetadata(const string& model_path, uint32_t output, const ClassResult* objects, size_t count) {
+  // only channel 0 publishes, as it always has, unless the channels are
+  // scheduled together ("fair"), where each is a stream of its own
+  if (GetChannel() != 0 && !channel_scheduled_) { return; }
+  auto timestamp = raw_pts;
+  if (has_swapped_models_) { ForgetSwappedModels(); }
+  objects = smoother_.Smooth(model_path, output, objects, count);
+  if (!publish_filter_.Admit(model_path, output, objects, count, timestamp)) {
+    stage_stats_.Count(StageStats::Counter::eSuppressed);
+    return;
+  }
+  auto start = StageClock::now();
+  auto metadata = StringMetadata(GetChannel(), timestamp);
+  metadata.Set(metadata_writer_.Write(metadata_format_, MetadataWriter::ModelId(model_path), GetChannel(),
+                                      objects, count, timestamp));
+  start = stage_stats_.Record(StageStats::Stage::eBuildXml, start);
+
+  auto req = new ("MetadataRequest") IPMetadataManager::StringMetadataRequest();
+  req->SetStringMetadata(std::move(metadata));
+
+  SendNoReplyEvent("MetadataManager", static_cast<int32_t>(IMetadataManager::EEventType::eRequestRawMetadata), 0, req);
+  start = stage_stats_.Record(StageStats::Stage::eSend, start);
+  if (first_metadata_ms_ < 0) {
+    first_metadata_ms_ = duration_cast<milliseconds>(start - boot_).count();
+    DebugLog("First metadata %" PRId64 " ms after boot", static_cast<int64_t>(first_metadata_ms_));
+  }
+}
+
+bool Classification::ParseNpuEvent(const string& body, string& response_body)
+{
+  bool result = true;
+
+  DebugLog(">> Classification::%s START", __func__);
+
+  JsonUtility::JsonDocument document(JsonUtility::Type::kObjectType);
+
+  document.Parse(body);
+  if (document.HasParseError()) {
+    return false;
+  }
+
+  // status requests are answered as things stand, without waiting for the
+  // frames in flight or for an auto-load still running
+  switch (HashStr(document["mode"].GetString()))
+  {
+    case HashStr("get_stats"):{
+      // "drain": true counts the frames in flight too, like any other request
+      bool drain = false;
+      JsonUtility::get(document, "drain", drain);
+      if (!drain) { return GetStats(document, response_body); }
+      break;
+    }
+    case HashStr("get_swap_status"):{
+      lock_guard<mutex> config_lock(config_mutex_);
+      return GetSwapStatus(response_body);
+    }
+    case HashStr("get_startup_status"):{
+      lock_guard<mutex> config_lock(config_mutex_);
+      return GetStartupStatus(response_body);
+    }
+    default:
+      break;
+  }
+
+  lock_guard<mutex> config_lock(config_mutex_);
+  // waits for an auto-load still running, and finishes it
+  FinishAutoLoad();
+  // configuration changes happen between frames: let in-flight frames finish
+  // before networks or tensors are touched
+  ChannelScheduler::Instance().Drain(GetChannel());
+  frame_mailbox_.Drain();
+  pipeline_.Drain();
+
+  NeuralNetwork* network = nullptr;
+  if (npu_load_info.model_name_.size() > 0)
+  {
+    network = GetNetwork(npu_load_info.model_name_);
+  }
+
+  switch (HashStr(document["mode"].GetString()))
+  {
+    case HashStr("create_network"):{
+      result = CreateNetwork(network, document);
+      break;
+    }
+    case HashStr("create_input_tensor"):{
+      result = CreateTensor(network, document, "input_tensor");
+      break;
+    }
+    case HashStr("create_output_tensor"):{
+      result = CreateTensor(network, document, "output_tensor");
+      break;
+    }
+    case HashStr("load_network"):{
+      result = LoadNetwork(network);
+      break;
+    }
+    case HashStr("run_network"):{
+      result = RunNetwork(network);
+      break;
+    }
+    case HashStr("check_parse_result"):{
+      result = CheckParseResult(network);
+      break;
+    }
+    case HashStr("unload_network"):{
+      result = UnloadNetwork(network);
+      break;
+    }
+    case HashStr("get_input_tensor_name"):{
+      result = GetTensorName(network, document, "input_tensor");
+      break;
+    }
+    case HashStr("get_output_tensor_name"):{
+      result = GetTensorName(network, document, "output_tensor");
+      break;
+    }
+    case HashStr("get_input_tensor_index"):{
+      result = GetTensorIndex(network, document, "input_tensor");
+      break;
+    }
+    case HashStr("get_output_tensor_index"):{
+      result = GetTensorIndex(network, document, "output_tensor");
+      break;
     }
     case HashStr("get_all_input_tensors"):{
       result = GetAllTensor(network, "input_tensor");
@@ -545,6 +1496,74 @@ bool Classification::ParseNpuEvent(const string& body)
       result = GetTensorCount(network, "output_tensor");
       break;
     }
+    case HashStr("get_stats"):{
+      result = GetStats(document, response_body);
+      break;
+    }
+    case HashStr("set_inference_mode"):{
+      result = SetInferenceMode(document);
+      break;
+    }
+    case HashStr("set_frame_policy"):{
+      result = SetFramePolicy(document);
+      break;
+    }
+    case HashStr("set_stream_selection"):{
+      result = SetStreamSelection(document);
+      break;
+    }
+    case HashStr("set_preprocess"):{
+      result = SetPreprocess(document);
+      break;
+    }
+    case HashStr("set_crops"):{
+      result = SetCrops(document);
+      break;
+    }
+    case HashStr("set_output"):{
+      result = SetOutput(document);
+      break;
+    }
+    case HashStr("set_batching"):{
+      result = SetBatching(document);
+      break;
+    }
+    case HashStr("set_metadata_format"):{
+      result = SetMetadataFormat(document);
+      break;
+    }
+    case HashStr("set_publish_policy"):{
+      result = SetPublishPolicy(document);
+      break;
+    }
+    case HashStr("set_smoothing"):{
+      result = SetSmoothing(document);
+      break;
+    }
+    case HashStr("set_scene_gate"):{
+      result = SetSceneGate(document);
+      break;
+    }
+    case HashStr("set_network_concurrency"):{
+      result = SetNetworkConcurrency(document);
+      break;
+    }
+    case HashStr("set_cascade"):{
+      result = SetCascade(document);
+      break;
+    }
+    case HashStr("swap_model"):{
+      result = SwapModel(document);
+      break;
+    }
+    case HashStr("set_auto_load"):{
+      result = SetAutoLoad(document);
+      break;
+    }
+    case HashStr("set_model_sharing"):{
+      result = SetModelSharing(document);
+      break;
+    }
     default:{
       result = false;
       break;
@@ -557,14 +1576,22 @@ bool Classification::ParseNpuEvent(const string& body)
 bool Classification::CreateNetwork(NeuralNetwork* network, JsonUtility::JsonDocument& document)
 {
   DebugLog("Create Network");
-  if (network) {
-    DebugLog("Failed: Network already exists (Model name: %s)", npu_load_info.model_name_.c_str());
+  // several networks can be loaded side by side, each model once; requests
+  // that follow go to the newest one
+  string model_name = run_neural_network_info_list->app_attribute_info.model_name;
+  if (document["model_name"].GetString() != string("")) { model_name = document["model_name"].GetString(); }
+  if (GetNetwork(model_name)) {
+    DebugLog("Failed: Network already exists (Model name: %s)", model_name.c_str());
     return false;
   }
 
-  if (document["model_name"].GetString() != string("")) { run_neural_network_info_list->app_attribute_info.model_name = document["model_name"].GetString(); }
+  auto& info = run_neural_network_info_list->app_attribute_info;
+  if (info.model_name != model_name) { info.model_file.clear(); }
+  info.model_name = model_name;
   WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
-  npu_load_info.model_name_ = run_neural_network_info_list->app_attribute_info.model_name;
+  npu_load_info.model_name_ = model_name;
+  npu_load_info.input_tensor_names_.clear();
+  npu_load_info.output_tensor_names_.clear();
 
   network = GetOrCreateNetwork(npu_load_info.model_name_);
   if (!network) {
@@ -621,26 +1648,89 @@ bool Classification::LoadNetwork(NeuralNetwork* network)
   DebugLog("Load Network");
   if (!network || npu_load_info.input_tensor_names_.empty() || npu_load_info.output_tensor_names_.empty()) { return false; }
     
-  const String open_sdk_path = "../res/ai_bin/";
-  relative_model_path = open_sdk_path + npu_load_info.model_name_;
+  relative_model_path = ModelPath(npu_load_info.model_name_);
+  const NetworkPreprocess& preprocess = preprocess_[npu_load_info.model_name_] = MakePreprocess(network);
 
-  auto mean = std::vector<float>{123.68, 116.779, 103.939};
-  auto scale = std::vector<float>{1.0, 1.0, 1.0};
-
-  if (!network->LoadNetwork(relative_model_path, mean, scale)) {
+  auto loaded = LoadModel(network_registry_.Get(npu_load_info.model_name_), relative_model_path, preprocess,
+                          run_neural_network_info_list->app_attribute_info.model_sharing != "off");
+  if (!loaded) {
+    preprocess_.erase(npu_load_info.model_name_);
     DebugLog("Failed: Load Network failed(model_name: %s)", npu_load_info.model_name_.c_str());
     return false;
   }
+  // frames only see a network from here on
+  network_registry_.Replace(npu_load_info.model_name_, move(loaded));
+  network_registry_.Activate(npu_load_info.model_name_);
 
   return true;
 }
 
+string Classification::ModelPath(const string& model_name, const string& model_file) const
+{
+  const String open_sdk_path = "../res/ai_bin/";
+  if (!model_file.empty()) { return open_sdk_path + model_file; }
+  // a file swapped in stays in place across restarts
+  const auto& info = run_neural_network_info_list->app_attribute_info;
+  return open_sdk_path + (model_name == info.model_name && !info.model_file.empty() ? info.model_file : model_name);
+}
+
+Classification::NetworkPreprocess Classification::MakePreprocess(NeuralNetwork* network) const
+{
+  NetworkPreprocess preprocess;
+  preprocess.mean = std::vector<float>{123.68, 116.779, 103.939};
+  preprocess.scale = std::vector<float>{1.0, 1.0, 1.0};
+
+  // the CPU pass is also used for crops, where it leaves normalisation to
+  // the SDK unless the network runs fused
+  if (SdkAccess::kExtended && run_neural_network_info_list->app_attribute_info.preprocess == "fused") {
+    const shared_ptr<Tensor>& input_tensor(network->GetInputTensor(0));
+    preprocess.fused = true;
+    if (input_tensor && SdkAccess::Type(*input_tensor) == ElementType::eFloat32) {
+      // normalise on the CPU pass instead of in the SDK
+      preprocess.cpu.SetNormalization(preprocess.mean, preprocess.scale);
+      preprocess.mean = std::vector<float>{0.0, 0.0, 0.0};
+      preprocess.scale = std::vector<float>{1.0, 1.0, 1.0};
+    }
+  }
+  return preprocess;
+}
+
+shared_ptr<NeuralNetwork> Classification::LoadModel(shared_ptr<NeuralNetwork> network, const string& model_path,
+                                                   const NetworkPreprocess& preprocess, bool shared)
+{
+  if (!network) { return nullptr; }
+  auto load = [&]() -> shared_ptr<NeuralNetwork> {
+    return network->LoadNetwork(model_path, preprocess.mean, preprocess.scale) ? network : nullptr;
+  };
+  if (!shared) { return load(); }
+  return ModelCache::Instance().Acquire(ModelCache::Key(model_path, *network, preprocess.mean, preprocess.scale), load);
+}
+
+bool Classification::WarmUp(NeuralNetwork& network)
+{
+  // the first run pays for whatever the SDK sets up lazily, off the frame path
+  stat_t stat = { 0, };
+  return network.RunNetwork(stat);
+}
+
 bool Classification::RunNetwork(NeuralNetwork* network)
 {
   DebugLog("Run Network");
   if (!network || npu_load_info.input_tensor_names_.empty() || npu_load_info.output_tensor_names_.empty()) { return false; }
 
   run_flag = 1;
+  UpdateStreamRequirement();
+  UpdateCrops();
+  UpdateOutputSpecs();
+  UpdateCascades();
+  // restarted so the batch sizes cover a network added since
+  StopPipeline();
+  StartPipeline();
+  ApplyFramePolicy();
+  ApplyPublishPolicy();
+  ApplySmoothing();
+  ApplySceneGate();
+  ApplyNetworkConcurrency();
   return true;
 }
 
@@ -661,12 +1751,17 @@ bool Classification::UnloadNetwork(NeuralNetwork* network)
   DebugLog("Unload Network");
   if (!network) { return false; }
 
-  network->UnloadNetwork();
+  StopChannelScheduling();
+  StopFrameMailbox();
+  StopPipeline();
+  source_tensor_pool_.Clear();
   RemoveNetwork(npu_load_info.model_name_);
   npu_load_info.model_name_.clear();
   npu_load_info.input_tensor_names_.clear();
   npu_load_info.output_tensor_names_.clear();
   run_flag = 0;
+  UpdateCascades();
+  ApplyNetworkConcurrency();
 
   return true;
 }
@@ -783,6 +1878,653 @@ bool Classification::GetTensorCount(NeuralNetwork* network, const string& reques
   return true;
 }
 
+bool Classification::GetStats(JsonUtility::JsonDocument& document, string& response_body)
+{
+  DebugLog("Get Stats");
+  response_body = stage_stats_.ToJson();
+
+  bool reset = false;
+  JsonUtility::get(document, "reset", reset);
+  if (reset) {
+    stage_stats_.Reset();
+  }
+  return true;
+}
+
+bool Classification::SetInferenceMode(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Set Inference Mode");
+  auto& info = run_neural_network_info_list->app_attribute_info;
+
+  string mode;
+  if (JsonUtility::get(document, "inference_mode", mode) && !mode.empty()) {
+    if (mode != "sync" && mode != "pipelined") {
+      DebugLog("Failed: inference mode is not supported(inference_mode: %s)", mode.c_str());
+      return false;
+    }
+    info.inference_mode = mode;
+  }
+  string depth;
+  if (JsonUtility::get(document, "queue_depth", depth) && !depth.empty()) {
+    if (atoi(depth.c_str()) < 1) {
+      DebugLog("Failed: invalid queue depth(queue_depth: %s)", depth.c_str());
+      return false;
+    }
+    info.pipeline_queue_depth = depth;
+  }
+  WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+
+  StopPipeline();
+  StartPipeline();
+  return true;
+}
+
+bool Classification::SetFramePolicy(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Set Frame Policy");
+  auto& info = run_neural_network_info_list->app_attribute_info;
+
+  string policy;
+  if (JsonUtility::get(document, "frame_policy", policy) && !policy.empty()) {
+    if (policy != "every" && policy != "latest" && policy != "target_fps" && policy != "fair") {
+      DebugLog("Failed: frame policy is not supported(frame_policy: %s)", policy.c_str());
+      return false;
+    }
+    info.frame_policy = policy;
+  }
+  string fps;
+  if (JsonUtility::get(document, "target_fps", fps) && !fps.empty()) {
+    if (atoi(fps.c_str()) < 1) {
+      DebugLog("Failed: invalid target fps(target_fps: %s)", fps.c_str());
+      return false;
+    }
+    info.target_fps = fps;
+  }
+  string weight;
+  if (JsonUtility::get(document, "channel_weight", weight) && !weight.empty()) {
+    if (atoi(weight.c_str()) < 1) {
+      DebugLog("Failed: invalid channel weight(channel_weight: %s)", weight.c_str());
+      return false;
+    }
+    info.channel_weight = weight;
+  }
+  string max_fps;
+  if (JsonUtility::get(document, "channel_max_fps", max_fps) && !max_fps.empty()) {
+    if (atoi(max_fps.c_str()) < 0) {
+      DebugLog("Failed: invalid channel max fps(channel_max_fps: %s)", max_fps.c_str());
+      return false;
+    }
+    info.channel_max_fps = max_fps;
+  }
+  if (info.frame_policy == "target_fps" && atoi(info.target_fps.c_str()) < 1) {
+    DebugLog("Failed: target_fps policy needs target_fps");
+    return false;
+  }
+  WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+
+  ApplyFramePolicy();
+  return true;
+}
+
+bool Classification::SetModelSharing(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Set Model Sharing");
+  auto& info = run_neural_network_info_list->app_attribute_info;
+
+  string sharing;
+  if (JsonUtility::get(document, "model_sharing", sharing) && !sharing.empty()) {
+    if (sharing != "on" && sharing != "off") {
+      DebugLog("Failed: model sharing is not supported(model_sharing: %s)", sharing.c_str());
+      return false;
+    }
+    info.model_sharing = sharing;
+  }
+  // takes effect with the next load_network
+  WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+  return true;
+}
+
+bool Classification::SetAutoLoad(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Set Auto Load");
+  auto& info = run_neural_network_info_list->app_attribute_info;
+
+  string auto_load;
+  if (JsonUtility::get(document, "auto_load", auto_load) && !auto_load.empty()) {
+    if (auto_load != "on" && auto_load != "off") {
+      DebugLog("Failed: auto load is not supported(auto_load: %s)", auto_load.c_str());
+      return false;
+    }
+    info.auto_load = auto_load;
+  }
+  // takes effect with the next start
+  WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+  return true;
+}
+
+bool Classification::GetStartupStatus(string& response_body)
+{
+  DebugLog("Get Startup Status");
+  JsonUtility::JsonDocument document(JsonUtility::Type::kObjectType);
+  auto& alloc = document.GetAllocator();
+  // the times are the auto-load thread's until it is done
+  const bool loaded = !auto_load_thread_.joinable() || auto_load_ready_;
+  JsonUtility::set(document, "auto_load", auto_load_.state, alloc);
+  JsonUtility::set(document, "load_ms", loaded ? auto_load_.load_ms : 0, alloc);
+  JsonUtility::set(document, "warmup_ms", loaded ? auto_load_.warmup_ms : 0, alloc);
+  // -1 until the first metadata
+  JsonUtility::set(document, "first_metadata_ms", static_cast<int64_t>(first_metadata_ms_), alloc);
+  getJsonString(document, response_body);
+  return true;
+}
+
+bool Classification::SwapModel(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Swap Model");
+  if (swap_busy_) {
+    DebugLog("Failed: a model swap is in progress(model_name: %s)", model_swap_.model_name.c_str());
+    return false;
+  }
+  // done with config_mutex_, so this returns at once
+  if (swap_thread_.joinable()) { swap_thread_.join(); }
+
+  ModelSwap swap;
+  JsonUtility::get(document, "model_name", swap.model_name);
+  if (swap.model_name.empty()) { swap.model_name = npu_load_info.model_name_; }
+  JsonUtility::get(document, "model_file", swap.model_file);
+  // without one, the model file was updated in place
+  if (swap.model_file.empty()) { swap.model_file = swap.model_name; }
+
+  auto networks = GetAllNetworks();
+  auto network = networks->find(swap.model_name);
+  auto preprocess = preprocess_.find(swap.model_name);
+  if (network == networks->end() || preprocess == preprocess_.end()) {
+    DebugLog("Failed: Network is not loaded(model_name: %s)", swap.model_name.c_str());
+    return false;
+  }
+  for (auto& tensor : network->second->GetAllInputTensors()) { swap.input_names.push_back(tensor->Name()); }
+  for (auto& tensor : network->second->GetAllOutputTensors()) { swap.output_names.push_back(tensor->Name()); }
+  // loaded as load_network would; frames keep the preprocessing made for the
+  // network being replaced, so the new one is loaded with the same
+  swap.model_path = ModelPath(swap.model_name, swap.model_file);
+  swap.preprocess = preprocess->second;
+  swap.shared = run_neural_network_info_list->app_attribute_info.model_sharing != "off";
+  swap.generation = network_generation_;
+  swap.state = "loading";
+
+  // the old network keeps serving frames meanwhile; the request returns now
+  // and get_swap_status follows the swap
+  model_swap_ = swap;
+  swap_busy_ = true;
+  swap_thread_ = thread(&Classification::RunModelSwap, this, move(swap));
+  return true;
+}
+
+void Classification::RunModelSwap(ModelSwap swap)
+{
+  const auto load_start = StageClock::now();
+  auto created = NetworkRegistry::Create();
+  bool ready = created != nullptr;
+  for (auto& name : swap.input_names) { ready = ready && created->CreateInputTensor(name); }
+  for (auto& name : swap.output_names) { ready = ready && created->CreateOutputTensor(name); }
+  // with model_sharing this is the cache's lease, which the registry then holds
+  auto network = ready ? LoadModel(move(created), swap.model_path, swap.preprocess, swap.shared) : nullptr;
+  const auto warmup_start = StageClock::now();
+  bool loaded = false;
+  if (network) {
+    auto lock = ModelCache::Lock(network);
+    loaded = WarmUp(*network);
+  }
+  const auto warmup_end = StageClock::now();
+
+  lock_guard<mutex> config_lock(config_mutex_);
+  const char* error = nullptr;
+  if (!loaded) {
+    error = "load failed";
+  } else if (swap.generation != network_generation_) {
+    error = "the network was unloaded meanwhile";
+  } else {
+    // batching, the source tensors and the preprocessing carry over, so the
+    // inputs have to match
+    auto networks = GetAllNetworks();
+    auto old = networks->find(swap.model_name);
+    if (old == networks->end()) {
+      error = "the network was unloaded meanwhile";
+    } else {
+      for (size_t i = 0; i < swap.input_names.size() && !error; i++) {
+        const auto& a = old->second->GetInputTensor(i);
+        const auto& b = network->GetInputTensor(i);
+        if (!a || !b || !SdkAccess::SameShape(*a, *b)) { error = "input tensors differ"; }
+      }
+    }
+  }
+  // frames pick the new network up with their next snapshot; the old one is
+  // unloaded once the frames still running on it are done
+  if (!error && !network_registry_.Replace(swap.model_name, network)) { error = "the network was unloaded meanwhile"; }
+
+  model_swap_.state = error ? "failed" : "done";
+  model_swap_.load_ms = duration_cast<milliseconds>(warmup_start - load_start).count();
+  model_swap_.warmup_ms = duration_cast<milliseconds>(warmup_end - warmup_start).count();
+  if (error) {
+    DebugLog("Failed: Model swap failed(model_name: %s, model_file: %s): %s", swap.model_name.c_str(),
+             swap.model_file.c_str(), error);
+  } else {
+    // nothing the old model produced is repeated or averaged into the new one's results
+    InvalidateLastResults();
+    {
+      lock_guard<mutex> swapped_lock(swapped_models_mutex_);
+      swapped_models_.push_back(swap.model_name);
+      has_swapped_models_ = true;
+    }
+    auto& info = run_neural_network_info_list->app_attribute_info;
+    if (info.model_name == swap.model_name) {
+      info.model_file = swap.model_file == swap.model_name ? "" : swap.model_file;
+      WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+    }
+    DebugLog("Model swapped(model_name: %s, model_file: %s, load %" PRIu64 " ms, warm-up %" PRIu64 " ms)",
+             swap.model_name.c_str(), swap.model_file.c_str(), model_swap_.load_ms, model_swap_.warmup_ms);
+  }
+  swap_busy_ = false;
+}
+
+bool Classification::GetSwapStatus(string& response_body)
+{
+  DebugLog("Get Swap Status");
+  JsonUtility::JsonDocument document(JsonUtility::Type::kObjectType);
+  auto& alloc = document.GetAllocator();
+  JsonUtility::set(document, "model_name", model_swap_.model_name, alloc);
+  JsonUtility::set(document, "model_file", model_swap_.model_file, alloc);
+  JsonUtility::set(document, "state", model_swap_.state, alloc);
+  JsonUtility::set(document, "load_ms", model_swap_.load_ms, alloc);
+  JsonUtility::set(document, "warmup_ms", model_swap_.warmup_ms, alloc);
+  getJsonString(document, response_body);
+  return true;
+}
+
+bool Classification::SetCascade(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Set Cascade");
+  auto& settings = run_neural_network_info_list->app_attribute_info.cascade_settings;
+
+  CascadeSetting item;
+  JsonUtility::get(document, "model_name", item.model_name);
+  if (item.model_name.empty()) { item.model_name = npu_load_info.model_name_; }
+  if (item.model_name.empty()) {
+    DebugLog("Failed: model name is empty");
+    return false;
+  }
+  JsonUtility::get(document, "detector", item.detector);
+  JsonUtility::get(document, "output_name", item.output_name);
+  JsonUtility::get(document, "min_score", item.min_score);
+  JsonUtility::get(document, "max_boxes", item.max_boxes);
+  if (item.detector == item.model_name) {
+    DebugLog("Failed: a network cannot take its own boxes(model_name: %s)", item.model_name.c_str());
+    return false;
+  }
+  if (!item.detector.empty() && !SdkAccess::kExtended) {
+    DebugLog("Failed: cascades need CPU access to the raw frame");
+    return false;
+  }
+  char* end = nullptr;
+  if (!item.min_score.empty() && (!isfinite(strtof(item.min_score.c_str(), &end)) || end == item.min_score.c_str() || *end != '\0')) {
+    DebugLog("Failed: invalid min_score(min_score: %s)", item.min_score.c_str());
+    return false;
+  }
+  if (!item.max_boxes.empty() && atoi(item.max_boxes.c_str()) < 1) {
+    DebugLog("Failed: invalid max_boxes(max_boxes: %s)", item.max_boxes.c_str());
+    return false;
+  }
+
+  settings.erase(remove_if(settings.begin(), settings.end(),
+                           [&item](const CascadeSetting& o) { return o.model_name == item.model_name; }),
+                 settings.end());
+  // a request without a detector puts the model back on the whole frame
+  if (!item.detector.empty()) {
+    settings.push_back(item);
+  }
+  WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+
+  UpdateCascades();
+  StopPipeline();
+  StartPipeline();
+  return true;
+}
+
+bool Classification::SetNetworkConcurrency(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Set Network Concurrency");
+  auto& info = run_neural_network_info_list->app_attribute_info;
+
+  string concurrency;
+  if (JsonUtility::get(document, "network_concurrency", concurrency) && !concurrency.empty()) {
+    if (concurrency != "parallel" && concurrency != "sequential") {
+      DebugLog("Failed: network concurrency is not supported(network_concurrency: %s)", concurrency.c_str());
+      return false;
+    }
+    info.network_concurrency = concurrency;
+  }
+  WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+
+  ApplyNetworkConcurrency();
+  return true;
+}
+
+bool Classification::SetSceneGate(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Set Scene Gate");
+  auto& info = run_neural_network_info_list->app_attribute_info;
+
+  string gate, threshold, refresh_ms;
+  JsonUtility::get(document, "scene_gate", gate);
+  JsonUtility::get(document, "threshold", threshold);
+  JsonUtility::get(document, "refresh_ms", refresh_ms);
+
+  if ((!gate.empty() && gate != "on" && gate != "off") || (gate == "on" && !SdkAccess::kExtended)) {
+    DebugLog("Failed: scene gate is not supported(scene_gate: %s)", gate.c_str());
+    return false;
+  }
+  char* end = nullptr;
+  if (!threshold.empty() && (strtof(threshold.c_str(), &end) < 0.0f || end == threshold.c_str() || *end != '\0')) {
+    DebugLog("Failed: invalid threshold(threshold: %s)", threshold.c_str());
+    return false;
+  }
+  if (!refresh_ms.empty() && (strtoll(refresh_ms.c_str(), &end, 10) < 0 || end == refresh_ms.c_str() || *end != '\0')) {
+    DebugLog("Failed: invalid refresh interval(refresh_ms: %s)", refresh_ms.c_str());
+    return false;
+  }
+
+  // fields left out keep their current value
+  if (!gate.empty()) { info.scene_gate = gate; }
+  if (!threshold.empty()) { info.scene_threshold = threshold; }
+  if (!refresh_ms.empty()) { info.scene_refresh_ms = refresh_ms; }
+  WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+
+  ApplySceneGate();
+  return true;
+}
+
+bool Classification::SetSmoothing(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Set Smoothing");
+  auto& info = run_neural_network_info_list->app_attribute_info;
+
+  string smoothing, alpha, window;
+  JsonUtility::get(document, "smoothing", smoothing);
+  JsonUtility::get(document, "alpha", alpha);
+  JsonUtility::get(document, "window", window);
+
+  TemporalSmoother::Type type;
+  if (!smoothing.empty() && !TemporalSmoother::FromString(smoothing, type)) {
+    DebugLog("Failed: smoothing is not supported(smoothing: %s)", smoothing.c_str());
+    return false;
+  }
+  if (!alpha.empty()) {
+    char* end = nullptr;
+    float v = strtof(alpha.c_str(), &end);
+    if (end == alpha.c_str() || *end != '\0' || !(v > 0.0f && v <= 1.0f)) {
+      DebugLog("Failed: invalid alpha(alpha: %s)", alpha.c_str());
+      return false;
+    }
+  }
+  if (!window.empty()) {
+    int v = atoi(window.c_str());
+    if (v < 1 || v > static_cast<int>(TemporalSmoother::kMaxWindow)) {
+      DebugLog("Failed: invalid window(window: %s, max: %u)", window.c_str(), TemporalSmoother::kMaxWindow);
+      return false;
+    }
+  }
+
+  // fields left out keep their current value
+  if (!smoothing.empty()) { info.smoothing = smoothing; }
+  if (!alpha.empty()) { info.smoothing_alpha = alpha; }
+  if (!window.empty()) { info.smoothing_window = window; }
+  WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+
+  ApplySmoothing();
+  return true;
+}
+
+bool Classification::SetPublishPolicy(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Set Publish Policy");
+  auto& info = run_neural_network_info_list->app_attribute_info;
+
+  auto non_negative = [](const string& value, bool integer) {
+    char* end = nullptr;
+    double v = integer ? static_cast<double>(strtoll(value.c_str(), &end, 10)) : strtod(value.c_str(), &end);
+    return end != value.c_str() && *end == '\0' && v >= 0;
+  };
+
+  string mode;
+  if (JsonUtility::get(document, "publish_mode", mode) && !mode.empty()) {
+    if (mode != "every" && mode != "on_change") {
+      DebugLog("Failed: publish mode is not supported(publish_mode: %s)", mode.c_str());
+      return false;
+    }
+  }
+  string delta, keep_alive, debounce;
+  JsonUtility::get(document, "score_delta", delta);
+  JsonUtility::get(document, "keep_alive_ms", keep_alive);
+  JsonUtility::get(document, "debounce_ms", debounce);
+  if ((!delta.empty() && !non_negative(delta, false)) || (!keep_alive.empty() && !non_negative(keep_alive, true)) ||
+      (!debounce.empty() && !non_negative(debounce, true))) {
+    DebugLog("Failed: invalid publish policy(score_delta: %s, keep_alive_ms: %s, debounce_ms: %s)",
+             delta.c_str(), keep_alive.c_str(), debounce.c_str());
+    return false;
+  }
+
+  // fields left out keep their current value
+  if (!mode.empty()) { info.publish_mode = mode; }
+  if (!delta.empty()) { info.publish_score_delta = delta; }
+  if (!keep_alive.empty()) { info.publish_keep_alive_ms = keep_alive; }
+  if (!debounce.empty()) { info.publish_debounce_ms = debounce; }
+  WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+
+  ApplyPublishPolicy();
+  return true;
+}
+
+bool Classification::SetMetadataFormat(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Set Metadata Format");
+  auto& info = run_neural_network_info_list->app_attribute_info;
+
+  string format;
+  JsonUtility::get(document, "metadata_format", format);
+  MetadataWriter::Format parsed;
+  if (!MetadataWriter::FromString(format, parsed)) {
+    DebugLog("Failed: metadata format is not supported(metadata_format: %s)", format.c_str());
+    return false;
+  }
+  info.metadata_format = format;
+  WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+
+  ApplyMetadataFormat();
+  if (GetChannel() == 0) { SetMetaFrameSchema(); }
+  return true;
+}
+
+bool Classification::SetOutput(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Set Output");
+  auto& settings = run_neural_network_info_list->app_attribute_info.output_settings;
+
+  OutputSetting item;
+  JsonUtility::get(document, "model_name", item.model_name);
+  if (item.model_name.empty()) { item.model_name = npu_load_info.model_name_; }
+  if (item.model_name.empty()) {
+    DebugLog("Failed: model name is empty");
+    return false;
+  }
+  JsonUtility::get(document, "output_name", item.output_name);
+  JsonUtility::get(document, "top_k", item.top_k);
+  JsonUtility::get(document, "activation", item.activation);
+  JsonUtility::get(document, "scale", item.scale);
+  JsonUtility::get(document, "zero_point", item.zero_point);
+  if (!item.top_k.empty() && (atoi(item.top_k.c_str()) < 1 || atoi(item.top_k.c_str()) > static_cast<int>(ClassResult::kMaxTopK))) {
+    DebugLog("Failed: invalid top_k(top_k: %s, max: %u)", item.top_k.c_str(), ClassResult::kMaxTopK);
+    return false;
+  }
+  Activation::Type activation;
+  if (!Activation::FromString(item.activation, activation)) {
+    DebugLog("Failed: invalid activation(activation: %s)", item.activation.c_str());
+    return false;
+  }
+  // a non-positive scale would reverse or flatten the order top-k relies on
+  if (!item.scale.empty() && !(strtof(item.scale.c_str(), nullptr) > 0.0f)) {
+    DebugLog("Failed: invalid scale(scale: %s)", item.scale.c_str());
+    return false;
+  }
+
+  settings.erase(remove_if(settings.begin(), settings.end(),
+                           [&item](const OutputSetting& o) { return o.model_name == item.model_name && o.output_name == item.output_name; }),
+                 settings.end());
+  // a request without any field clears the setting for the output
+  if (!item.top_k.empty() || !item.activation.empty() || !item.scale.empty() || !item.zero_point.empty()) {
+    settings.push_back(item);
+  }
+  WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+
+  UpdateOutputSpecs();
+  return true;
+}
+
+bool Classification::SetBatching(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Set Batching");
+  auto& settings = run_neural_network_info_list->app_attribute_info.batch_settings;
+
+  BatchSetting item;
+  JsonUtility::get(document, "model_name", item.model_name);
+  if (item.model_name.empty()) { item.model_name = npu_load_info.model_name_; }
+  if (item.model_name.empty()) {
+    DebugLog("Failed: model name is empty");
+    return false;
+  }
+  JsonUtility::get(document, "batch_size", item.batch_size);
+  JsonUtility::get(document, "max_wait_ms", item.max_wait_ms);
+  if ((!item.batch_size.empty() && atoi(item.batch_size.c_str()) < 1) || atoi(item.max_wait_ms.c_str()) < 0) {
+    DebugLog("Failed: invalid batching(batch_size: %s, max_wait_ms: %s)", item.batch_size.c_str(), item.max_wait_ms.c_str());
+    return false;
+  }
+
+  settings.erase(remove_if(settings.begin(), settings.end(),
+                           [&item](const BatchSetting& o) { return o.model_name == item.model_name; }),
+                 settings.end());
+  // a request without any field goes back to the network's own batch size
+  if (!item.batch_size.empty() || !item.max_wait_ms.empty()) {
+    settings.push_back(item);
+  }
+  WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+
+  StopPipeline();
+  StartPipeline();
+  return true;
+}
+
+bool Classification::SetCrops(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Set Crops");
+  auto& info = run_neural_network_info_list->app_attribute_info;
+
+  auto in_unit = [](const string& value, bool positive) {
+    char* end = nullptr;
+    float v = strtof(value.c_str(), &end);
+    return end != value.c_str() && *end == '\0' && v <= 1.0f && (positive ? v > 0.0f : v >= 0.0f);
+  };
+
+  vector<CropInfo> rois;
+  auto rois_itr = document.FindMember("rois");
+  if (rois_itr != document.MemberEnd() && rois_itr->value.IsArray()) {
+    for (JsonUtility::ValueType& roi_itr : rois_itr->value.GetArray()) {
+      CropInfo roi;
+      JsonUtility::get(roi_itr, "x", roi.x);
+      JsonUtility::get(roi_itr, "y", roi.y);
+      JsonUtility::get(roi_itr, "width", roi.width);
+      JsonUtility::get(roi_itr, "height", roi.height);
+      if (!in_unit(roi.x, false) || !in_unit(roi.y, false) || !in_unit(roi.width, true) || !in_unit(roi.height, true)) {
+        DebugLog("Failed: invalid roi(x: %s, y: %s, width: %s, height: %s)", roi.x.c_str(), roi.y.c_str(), roi.width.c_str(), roi.height.c_str());
+        return false;
+      }
+      rois.push_back(roi);
+    }
+  }
+
+  string grid;
+  JsonUtility::get(document, "grid", grid);
+  unsigned columns = 0, rows = 0;
+  if (!grid.empty() && (sscanf(grid.c_str(), "%ux%u", &columns, &rows) != 2 ||
+                        columns < 1 || rows < 1 || columns > 8 || rows > 8)) {
+    DebugLog("Failed: invalid grid(grid: %s)", grid.c_str());
+    return false;
+  }
+
+  if ((!rois.empty() || !grid.empty()) && !SdkAccess::kExtended) {
+    DebugLog("Failed: crops need CPU access to the raw frame");
+    return false;
+  }
+
+  // a request without rois or grid goes back to full-frame inference
+  info.crop_rois = rois;
+  info.crop_grid = grid;
+  WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+
+  UpdateCrops();
+  return true;
+}
+
+bool Classification::SetPreprocess(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Set Preprocess");
+  auto& info = run_neural_network_info_list->app_attribute_info;
+
+  string preprocess;
+  JsonUtility::get(document, "preprocess", preprocess);
+  if ((preprocess != "sdk" && preprocess != "fused") || (preprocess == "fused" && !SdkAccess::kExtended)) {
+    DebugLog("Failed: preprocess is not supported(preprocess: %s)", preprocess.c_str());
+    return false;
+  }
+  info.preprocess = preprocess;
+  WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+
+  // the mean/scale split between CPU and SDK is fixed when the network is loaded
+  DebugLog("Preprocess: %s (applied at the next load_network)", preprocess.c_str());
+  return true;
+}
+
+bool Classification::SetStreamSelection(JsonUtility::JsonDocument& document)
+{
+  DebugLog("Set Stream Selection");
+  auto& overrides = run_neural_network_info_list->app_attribute_info.stream_overrides;
+
+  StreamOverride item;
+  JsonUtility::get(document, "model_name", item.model_name);
+  if (item.model_name.empty()) { item.model_name = npu_load_info.model_name_; }
+  if (item.model_name.empty()) {
+    DebugLog("Failed: model name is empty");
+    return false;
+  }
+  JsonUtility::get(document, "min_width", item.min_width);
+  JsonUtility::get(document, "min_height", item.min_height);
+  JsonUtility::get(document, "stream_index", item.stream_index);
+  if (atoi(item.min_width.c_str()) < 0 || atoi(item.min_height.c_str()) < 0 || atoi(item.stream_index.c_str()) < 0) {
+    DebugLog("Failed: invalid stream selection");
+    return false;
+  }
+
+  overrides.erase(remove_if(overrides.begin(), overrides.end(),
+                            [&item](const StreamOverride& o) { return o.model_name == item.model_name; }),
+                  overrides.end());
+  // a request without any field clears the override for the model
+  if (!item.min_width.empty() || !item.min_height.empty() || !item.stream_index.empty()) {
+    overrides.push_back(item);
+  }
+  WriteAttributes(run_neural_network_info_list.get(), this->GetObjectName());
+
+  UpdateStreamRequirement();
+  return true;
+}
+
 bool Classification::InsertNpuLoadInfo(string& target, string recv_value)
 {
   if (target.empty()) {
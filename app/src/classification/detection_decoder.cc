@@ -0,0 +1,57 @@
+#include "detection_decoder.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+float Value(const OutputView& output, size_t index, float scale, int32_t zero_point)
+{
+  switch (output.type) {
+    case ElementType::eUint8:
+      return (static_cast<const uint8_t*>(output.data)[index] - zero_point) * scale;
+    case ElementType::eInt8:
+      return (static_cast<const int8_t*>(output.data)[index] - zero_point) * scale;
+    default:
+      return static_cast<const float*>(output.data)[index];
+  }
+}
+
+}  // namespace
+
+bool DetectionDecoder::Decode(const OutputView& output, float scale, int32_t zero_point, float min_score,
+                              size_t max_boxes, vector<ClassResult>& boxes)
+{
+  boxes.clear();
+  if (!output.data || output.width <= 0 || output.width % kRowSize != 0) { return false; }
+
+  const size_t rows = static_cast<size_t>(output.width) / kRowSize;
+  for (size_t row = 0; row < rows; row++) {
+    const size_t base = row * kRowSize;
+    const float score = Value(output, base + 4, scale, zero_point);
+    if (!(score >= min_score)) { continue; }
+
+    // clip to the frame; a box with nothing left inside it is dropped
+    const float x = Value(output, base + 0, scale, zero_point);
+    const float y = Value(output, base + 1, scale, zero_point);
+    const float x0 = min(max(x, 0.0f), 1.0f);
+    const float y0 = min(max(y, 0.0f), 1.0f);
+    const float x1 = min(max(x + Value(output, base + 2, scale, zero_point), 0.0f), 1.0f);
+    const float y1 = min(max(y + Value(output, base + 3, scale, zero_point), 0.0f), 1.0f);
+    if (!(x1 > x0 && y1 > y0)) { continue; }
+
+    ClassResult box;
+    box.count = 1;
+    box.top[0] = {static_cast<int>(lround(Value(output, base + 5, scale, zero_point))), score};
+    box.has_box = true;
+    box.box = {x0, y0, x1 - x0, y1 - y0};
+    boxes.push_back(box);
+  }
+
+  stable_sort(boxes.begin(), boxes.end(),
+              [](const ClassResult& a, const ClassResult& b) { return a.top[0].value > b.top[0].value; });
+  if (boxes.size() > max_boxes) { boxes.resize(max_boxes); }
+  return true;
+}
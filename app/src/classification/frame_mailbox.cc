@@ -0,0 +1,86 @@
+#include "frame_mailbox.h"
+
+using namespace std;
+
+bool FrameMailbox::Start(Handler handler)
+{
+  if (running_) { return false; }
+
+  handler_ = move(handler);
+  {
+    lock_guard<mutex> lock(mutex_);
+    closed_ = false;
+  }
+  running_ = true;
+  worker_ = thread(&FrameMailbox::WorkerLoop, this);
+  return true;
+}
+
+void FrameMailbox::Stop()
+{
+  if (!running_) { return; }
+
+  {
+    lock_guard<mutex> lock(mutex_);
+    closed_ = true;
+    if (has_pending_) {
+      pending_.ClearResource();
+      has_pending_ = false;
+    }
+  }
+  wake_cv_.notify_all();
+  if (worker_.joinable()) { worker_.join(); }
+  running_ = false;
+  idle_cv_.notify_all();
+}
+
+bool FrameMailbox::Post(const Blob& blob, StageClock::time_point arrival)
+{
+  Blob superseded;
+  bool dropped = false;
+  {
+    lock_guard<mutex> lock(mutex_);
+    if (has_pending_) {
+      superseded = move(pending_);
+      dropped = true;
+    }
+    pending_ = blob;
+    pending_arrival_ = arrival;
+    has_pending_ = true;
+  }
+  wake_cv_.notify_one();
+  // hand the old frame back to the stream provider outside the lock
+  superseded.ClearResource();
+  return dropped;
+}
+
+void FrameMailbox::Drain()
+{
+  unique_lock<mutex> lock(mutex_);
+  idle_cv_.wait(lock, [this] { return closed_ || (!has_pending_ && !busy_); });
+}
+
+void FrameMailbox::WorkerLoop()
+{
+  unique_lock<mutex> lock(mutex_);
+  while (true) {
+    wake_cv_.wait(lock, [this] { return closed_ || has_pending_; });
+    if (closed_) { break; }
+
+    Blob blob = move(pending_);
+    pending_ = Blob();
+    auto arrival = pending_arrival_;
+    has_pending_ = false;
+    busy_ = true;
+
+    lock.unlock();
+    handler_(blob, arrival);
+    blob.ClearResource();
+    lock.lock();
+
+    busy_ = false;
+    idle_cv_.notify_all();
+  }
+  busy_ = false;
+  idle_cv_.notify_all();
+}
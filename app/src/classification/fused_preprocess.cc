@@ -0,0 +1,239 @@
+#include "fused_preprocess.h"
+
+#include <algorithm>
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FUSED_PREPROCESS_NEON 1
+#endif
+
+using namespace std;
+
+namespace {
+
+// BT.601 limited range, same coefficients as the SDK's NV12 -> RGB888
+constexpr float kLuma = 298.0f / 256.0f;
+constexpr float kRV = 409.0f / 256.0f;
+constexpr float kGU = 100.0f / 256.0f;
+constexpr float kGV = 208.0f / 256.0f;
+constexpr float kBU = 516.0f / 256.0f;
+
+inline float Clamp255(float v) { return v < 0.0f ? 0.0f : (v > 255.0f ? 255.0f : v); }
+
+void BuildAxis(uint32_t offset, uint32_t src, uint32_t dst, vector<uint32_t>& i0, vector<uint32_t>& i1, vector<float>& w)
+{
+  i0.resize(dst);
+  i1.resize(dst);
+  w.resize(dst);
+  const float f = static_cast<float>(src) / dst;
+  for (uint32_t i = 0; i < dst; i++) {
+    float s = max(0.0f, (i + 0.5f) * f - 0.5f);
+    uint32_t a = min(static_cast<uint32_t>(s), src - 1);
+    w[i] = s - a;
+    i0[i] = offset + a;
+    i1[i] = offset + min(a + 1, src - 1);
+  }
+}
+
+}  // namespace
+
+FusedPreprocessor::FusedPreprocessor()
+{
+  SetNormalization({}, {});
+}
+
+bool FusedPreprocessor::Supports(PixelLayout layout)
+{
+  return layout == PixelLayout::eNV12 || layout == PixelLayout::eRGB888;
+}
+
+void FusedPreprocessor::SetNormalization(const vector<float>& mean, const vector<float>& scale)
+{
+  for (int c = 0; c < 3; c++) {
+    mean_[c] = c < static_cast<int>(mean.size()) ? mean[c] : 0.0f;
+    scale_[c] = c < static_cast<int>(scale.size()) ? scale[c] : 1.0f;
+  }
+}
+
+FusedPreprocessor::Region FusedPreprocessor::ToPixels(const RawImage& src, const CropRect* crop)
+{
+  if (!crop) { return {0, 0, src.width, src.height}; }
+
+  auto to_pixels = [](float v, uint32_t length) {
+    return static_cast<uint32_t>(min(max(v, 0.0f), 1.0f) * length + 0.5f);
+  };
+  Region region;
+  region.x = min(to_pixels(crop->x, src.width), src.width - 1);
+  region.y = min(to_pixels(crop->y, src.height), src.height - 1);
+  region.width = max(1u, min(to_pixels(crop->x + crop->width, src.width), src.width) - region.x);
+  region.height = max(1u, min(to_pixels(crop->y + crop->height, src.height), src.height) - region.y);
+  return region;
+}
+
+void FusedPreprocessor::PrepareTables(const Region& region, const img_size_t& size)
+{
+  if (region.x == region_.x && region.y == region_.y && region.width == region_.width &&
+      region.height == region_.height && size.width == size_.width && size.height == size_.height) {
+    return;
+  }
+  region_ = region;
+  size_ = size;
+  BuildAxis(region.x, region.width, size.width, x0_, x1_, wx_);
+  BuildAxis(region.y, region.height, size.height, y0_, y1_, wy_);
+  rows_.resize(static_cast<size_t>(size.width) * 6);
+}
+
+void FusedPreprocessor::ResampleRows(const RawImage& src, uint32_t y0, uint32_t y1)
+{
+  const uint32_t width = size_.width;
+  const uint8_t* base = SdkAccess::Pixels(src);
+  float* out[6];
+  for (int i = 0; i < 6; i++) { out[i] = &rows_[static_cast<size_t>(i) * width]; }
+
+  if (SdkAccess::Layout(src) == PixelLayout::eRGB888) {
+    const uint32_t stride = SdkAccess::Stride(src) ? SdkAccess::Stride(src) : src.width * 3;
+    const uint32_t ys[2] = {y0, y1};
+    for (int r = 0; r < 2; r++) {
+      const uint8_t* row = base + static_cast<size_t>(ys[r]) * stride;
+      for (uint32_t x = 0; x < width; x++) {
+        const uint8_t* p0 = row + x0_[x] * 3;
+        const uint8_t* p1 = row + x1_[x] * 3;
+        const float w = wx_[x];
+        for (int c = 0; c < 3; c++) {
+          out[r * 3 + c][x] = p0[c] + (p1[c] - p0[c]) * w;
+        }
+      }
+    }
+    return;
+  }
+
+  // NV12: full-size Y plane followed by interleaved, half-size UV
+  const uint32_t stride = SdkAccess::Stride(src) ? SdkAccess::Stride(src) : src.width;
+  const uint8_t* uv_plane = base + static_cast<size_t>(stride) * src.height;
+  const uint32_t ys[2] = {y0, y1};
+  for (int r = 0; r < 2; r++) {
+    const uint8_t* y_row = base + static_cast<size_t>(ys[r]) * stride;
+    const uint8_t* uv_row = uv_plane + static_cast<size_t>(ys[r] / 2) * stride;
+    float* out_y = out[r * 3 + 0];
+    float* out_u = out[r * 3 + 1];
+    float* out_v = out[r * 3 + 2];
+    for (uint32_t x = 0; x < width; x++) {
+      const uint32_t a = x0_[x];
+      const uint32_t b = x1_[x];
+      const float w = wx_[x];
+      out_y[x] = y_row[a] + (y_row[b] - y_row[a]) * w;
+      // each source pixel takes the chroma of its 2x2 block, as the
+      // full-size conversion does
+      const uint8_t* uv_a = uv_row + (a & ~1u);
+      const uint8_t* uv_b = uv_row + (b & ~1u);
+      out_u[x] = uv_a[0] + (uv_b[0] - uv_a[0]) * w;
+      out_v[x] = uv_a[1] + (uv_b[1] - uv_a[1]) * w;
+    }
+  }
+}
+
+void FusedPreprocessor::StoreRow(Tensor& dst, uint32_t slot, uint32_t y, float wy, bool yuv)
+{
+  const uint32_t width = size_.width;
+  const float* r0[3] = {&rows_[0], &rows_[width], &rows_[2 * width]};
+  const float* r1[3] = {&rows_[3 * width], &rows_[4 * width], &rows_[5 * width]};
+
+  if (SdkAccess::Type(dst) != ElementType::eFloat32) {
+    const size_t image = static_cast<size_t>(dst.Length(0)) * dst.Length(1) * 3;
+    auto* out = static_cast<uint8_t*>(dst.VirtAddr()) + slot * image + static_cast<size_t>(y) * dst.Length(0) * 3;
+    for (uint32_t x = 0; x < width; x++) {
+      float a = r0[0][x] + (r1[0][x] - r0[0][x]) * wy;
+      float b = r0[1][x] + (r1[1][x] - r0[1][x]) * wy;
+      float c = r0[2][x] + (r1[2][x] - r0[2][x]) * wy;
+      float rgb[3] = {a, b, c};
+      if (yuv) {
+        const float l = (a - 16.0f) * kLuma;
+        const float d = b - 128.0f;
+        const float e = c - 128.0f;
+        rgb[0] = l + kRV * e;
+        rgb[1] = l - kGU * d - kGV * e;
+        rgb[2] = l + kBU * d;
+      }
+      for (int k = 0; k < 3; k++) {
+        out[x * 3 + k] = static_cast<uint8_t>(Clamp255(rgb[k]) + 0.5f);
+      }
+    }
+    return;
+  }
+
+  const size_t plane = static_cast<size_t>(dst.Length(0)) * dst.Length(1);
+  auto* base = static_cast<float*>(dst.VirtAddr()) + slot * plane * 3 + static_cast<size_t>(y) * dst.Length(0);
+  float* out[3] = {base, base + plane, base + 2 * plane};
+
+  uint32_t x = 0;
+#ifdef FUSED_PREPROCESS_NEON
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const float32x4_t full = vdupq_n_f32(255.0f);
+  const float32x4_t bias_y = vdupq_n_f32(16.0f);
+  const float32x4_t bias_c = vdupq_n_f32(128.0f);
+  for (; x + 4 <= width; x += 4) {
+    float32x4_t a0 = vld1q_f32(r0[0] + x);
+    float32x4_t b0 = vld1q_f32(r0[1] + x);
+    float32x4_t c0 = vld1q_f32(r0[2] + x);
+    float32x4_t a = vmlaq_n_f32(a0, vsubq_f32(vld1q_f32(r1[0] + x), a0), wy);
+    float32x4_t b = vmlaq_n_f32(b0, vsubq_f32(vld1q_f32(r1[1] + x), b0), wy);
+    float32x4_t c = vmlaq_n_f32(c0, vsubq_f32(vld1q_f32(r1[2] + x), c0), wy);
+    float32x4_t rgb[3] = {a, b, c};
+    if (yuv) {
+      const float32x4_t l = vmulq_n_f32(vsubq_f32(a, bias_y), kLuma);
+      const float32x4_t d = vsubq_f32(b, bias_c);
+      const float32x4_t e = vsubq_f32(c, bias_c);
+      rgb[0] = vmlaq_n_f32(l, e, kRV);
+      rgb[1] = vmlsq_n_f32(vmlsq_n_f32(l, d, kGU), e, kGV);
+      rgb[2] = vmlaq_n_f32(l, d, kBU);
+    }
+    for (int k = 0; k < 3; k++) {
+      float32x4_t v = vminq_f32(vmaxq_f32(rgb[k], zero), full);
+      v = vmulq_n_f32(vsubq_f32(v, vdupq_n_f32(mean_[k])), scale_[k]);
+      vst1q_f32(out[k] + x, v);
+    }
+  }
+#endif
+  for (; x < width; x++) {
+    float a = r0[0][x] + (r1[0][x] - r0[0][x]) * wy;
+    float b = r0[1][x] + (r1[1][x] - r0[1][x]) * wy;
+    float c = r0[2][x] + (r1[2][x] - r0[2][x]) * wy;
+    float rgb[3] = {a, b, c};
+    if (yuv) {
+      const float l = (a - 16.0f) * kLuma;
+      const float d = b - 128.0f;
+      const float e = c - 128.0f;
+      rgb[0] = l + kRV * e;
+      rgb[1] = l - kGU * d - kGV * e;
+      rgb[2] = l + kBU * d;
+    }
+    for (int k = 0; k < 3; k++) {
+      out[k][x] = (Clamp255(rgb[k]) - mean_[k]) * scale_[k];
+    }
+  }
+}
+
+bool FusedPreprocessor::Run(const RawImage& src, Tensor& dst, const img_size_t& size, const CropRect* crop, uint32_t slot)
+{
+  const PixelLayout layout = SdkAccess::Layout(src);
+  if (!Supports(layout) || src.width == 0 || src.height == 0 || SdkAccess::Pixels(src) == nullptr) { return false; }
+  if (size.width == 0 || size.height == 0 || dst.Length(0) < size.width || dst.Length(1) < size.height) { return false; }
+  if (SdkAccess::Type(dst) != ElementType::eFloat32 && SdkAccess::Length(dst, 2) != 3) { return false; }
+  if (!dst.VirtAddr() || slot >= SdkAccess::Batch(dst)) { return false; }
+
+  PrepareTables(ToPixels(src, crop), size);
+
+  const bool yuv = layout == PixelLayout::eNV12;
+  uint32_t loaded_y0 = UINT32_MAX;
+  uint32_t loaded_y1 = UINT32_MAX;
+  for (uint32_t y = 0; y < size.height; y++) {
+    // neighbouring output rows often share source rows when upscaling
+    if (y0_[y] != loaded_y0 || y1_[y] != loaded_y1) {
+      ResampleRows(src, y0_[y], y1_[y]);
+      loaded_y0 = y0_[y];
+      loaded_y1 = y1_[y];
+    }
+    StoreRow(dst, slot, y, wy_[y], yuv);
+  }
+  return true;
+}
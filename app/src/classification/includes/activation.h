@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "top_k.h"
+
+/**
+ * @brief Output activation for networks that emit raw logits.
+ *        Softmax and sigmoid are both monotonic, so top-k is selected on the
+ *        logits and only the selected entries are turned into probabilities:
+ *        softmax needs one vectorised log-sum-exp pass over the output,
+ *        sigmoid nothing beyond the K entries.
+ */
+class Activation {
+ public:
+  enum class Type {
+    eNone = 0,
+    eSoftmax,
+    eSigmoid
+  };
+
+  // "" and "none" map to eNone.
+  static bool FromString(const std::string& name, Type& type);
+
+  // log(sum(exp(data[i]))), computed against |max_value| (the largest score)
+  // so large logits cannot overflow.
+  static float LogSumExp(const float* data, size_t width, float max_value);
+
+  // Rewrites the |count| entries selected from |data| (best first) as
+  // probabilities of |type|.
+  static void Apply(Type type, const float* data, size_t width, TopK::Entry* top, size_t count);
+  // Quantised outputs, real = (q - |zero_point|) * |scale|, with |top|
+  // already dequantised. The log-sum-exp goes through a 256-bin histogram
+  // of the stored values, so the output is never converted to float.
+  static void Apply(Type type, const uint8_t* data, size_t width, float scale, int32_t zero_point,
+                    TopK::Entry* top, size_t count);
+  static void Apply(Type type, const int8_t* data, size_t width, float scale, int32_t zero_point,
+                    TopK::Entry* top, size_t count);
+};
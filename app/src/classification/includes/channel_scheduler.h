@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "i_pl_video_frame_raw.h"
+#include "stage_stats.h"
+
+/**
+ * @brief One inference thread for the frames of every channel in the
+ *        process, taken in weighted round-robin so a busy channel cannot
+ *        starve the others ("fair" frame policy).
+ *        Each channel keeps its latest frame only, as FrameMailbox does. A
+ *        channel with a frame waiting is served |weight| frames in a row
+ *        when its turn comes, and no more often than |max_fps|. A channel
+ *        over its quota keeps its frame until the quota allows it, while the
+ *        others are served.
+ *        A channel whose |ready| check fails (its pipeline queue is full) is
+ *        passed over the same way until it calls Wake(), so the one thread
+ *        never blocks on a single channel.
+ */
+class ChannelScheduler {
+ public:
+  using Handler = std::function<void(Blob& blob, StageClock::time_point arrival)>;
+  using Ready = std::function<bool()>;
+
+  static ChannelScheduler& Instance();
+  ~ChannelScheduler();
+
+  // Adds |channel|, or updates its share; max_fps 0 for no quota. |ready|,
+  // if set, must hold before |handler| is given a frame; it is called with
+  // the scheduler locked, so it must not call back into it.
+  void Join(int channel, uint32_t weight, uint32_t max_fps, Handler handler, Ready ready = nullptr);
+  // Releases a frame left waiting and waits for one being handled.
+  void Leave(int channel);
+  bool IsJoined(int channel);
+
+  // Returns true when a waiting frame was superseded.
+  bool Post(int channel, const Blob& blob, StageClock::time_point arrival);
+  // Waits until |channel| has no frame waiting or being handled.
+  void Drain(int channel);
+  // Re-runs the |ready| checks, e.g. once a channel's pipeline has room.
+  void Wake();
+
+ private:
+  struct Channel {
+    uint32_t weight = 1;
+    StageClock::duration period{};  // 1 / max_fps, zero for no quota
+    StageClock::time_point next_admit;
+    Handler handler;
+    Ready ready;
+    Blob pending;
+    StageClock::time_point arrival;
+    bool has_pending = false;
+    bool busy = false;
+  };
+  using Channels = std::map<int, Channel>;
+
+  ChannelScheduler() = default;
+  void WorkerLoop();
+  // The channel to serve now, or channels_.end() with |wake| set to when one
+  // comes off its quota (max() when none is waiting).
+  Channels::iterator Next(StageClock::time_point now, StageClock::time_point& wake);
+
+  std::mutex control_mutex_;  // Join/Leave, which start and stop the worker
+  std::thread worker_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_cv_;
+  std::condition_variable idle_cv_;
+  Channels channels_;
+  int current_ = -1;      // channel whose turn it is
+  uint32_t credit_ = 0;   // frames it may still take this turn
+  bool closed_ = false;
+};
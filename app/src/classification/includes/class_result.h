@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+#include "fused_preprocess.h"
+#include "sdk_access.h"
+#include "top_k.h"
+
+/**
+ * @brief One image's scores in an output tensor, in the tensor's own data
+ *        type (float32, or uint8/int8 when the network output is quantised).
+ */
+struct OutputView {
+  const void* data = nullptr;
+  ElementType type = ElementType::eFloat32;
+  int width = 0;
+
+  // Output |slot| of a tensor with dims {classes, N}.
+  static OutputView Of(const Tensor& tensor, uint32_t slot = 0) {
+    OutputView view;
+    view.type = SdkAccess::Type(tensor);
+    view.width = static_cast<int>(tensor.Length(0));
+    if (tensor.VirtAddr()) {
+      view.data = static_cast<const uint8_t*>(tensor.VirtAddr()) + static_cast<size_t>(slot) * view.Bytes();
+    }
+    return view;
+  }
+  size_t Bytes() const { return static_cast<size_t>(width) * SdkAccess::ElementSize(type); }
+};
+
+/**
+ * @brief Top-K classification of one network output, optionally tied to the
+ *        crop of the frame it was computed on.
+ */
+struct ClassResult {
+  static constexpr uint32_t kMaxTopK = 32;
+
+  TopK::Entry top[kMaxTopK];  // best first
+  uint32_t count = 0;
+  bool has_box = false;
+  CropRect box = {0, 0, 1, 1};
+};
@@ -2,6 +2,7 @@
 
 #include "i_pl_video_frame_raw.h"
 #include <mutex>
+#include <thread>
 #include "dispatcher_serialize.h"
 #include "i_app_dispatcher.h"
 #include "neural_network.h"
@@ -10,6 +11,24 @@
 #include "i_analytics_detector.h"
 #include "typedef_analytics_detector.h"
 #include "i_log_manager.h"
+#include "activation.h"
+#include "channel_scheduler.h"
+#include "class_result.h"
+#include "detection_decoder.h"
+#include "frame_mailbox.h"
+#include "metadata_writer.h"
+#include "model_cache.h"
+#include "publish_filter.h"
+#include "scene_gate.h"
+#include "fused_preprocess.h"
+#include "inference_pipeline.h"
+#include "network_registry.h"
+#include "network_workers.h"
+#include "source_tensor_pool.h"
+#include "sdk_access.h"
+#include "stream_selector.h"
+#include "temporal_smoother.h"
+#include "stage_stats.h"
 constexpr ClassID kComponentId =
     static_cast<ClassID>(_ELayer_Analytics_Detector::_eObjectDetectorAI);
 
@@ -22,9 +41,47 @@ class Classification : public Component {
     std::string version;
     std::vector<std::string> permissions;
   };
+  struct StreamOverride {
+   public:
+    std::string model_name;
+    std::string min_width;     // minimum source stream size for this model
+    std::string min_height;
+    std::string stream_index;  // pins a position in the RawImage chain
+  };
+  struct OutputSetting {
+   public:
+    std::string model_name;
+    std::string output_name;  // empty for every output of the model
+    std::string top_k;        // classes reported per output, default 5
+    std::string activation;   // "none" (default), "softmax" or "sigmoid" for logit outputs
+    std::string scale;        // quantised (uint8/int8) outputs: real = (q - zero_point) * scale
+    std::string zero_point;
+  };
+  struct BatchSetting {
+   public:
+    std::string model_name;
+    std::string batch_size;   // frames per RunNetwork, capped by the network's batch dimension
+    std::string max_wait_ms;  // how long the first frame may wait for the rest
+  };
+  struct CascadeSetting {
+   public:
+    std::string model_name;   // runs on the boxes found by |detector| instead of the whole frame
+    std::string detector;
+    std::string output_name;  // detector output with the box rows, empty for the first
+    std::string min_score;    // boxes scoring lower are not classified
+    std::string max_boxes;    // crops classified per frame at most
+  };
+  struct CropInfo {
+   public:
+    std::string x;  // normalised to the frame, [0, 1]
+    std::string y;
+    std::string width;
+    std::string height;
+  };
   struct AppAttributeInfo {
    public:
     std::string model_name;
+    std::string model_file;  // loaded for model_name when swap_model put another file in its place
     std::string input_tensor_names;
     std::string output_tensor_names;
 
@@ -33,14 +90,84 @@ class Classification : public Component {
     std::string get_name_input_index;
     std::string get_name_output_index;
 
+    std::string inference_mode;        // "sync" (default) or "pipelined"
+    std::string pipeline_queue_depth;  // frames buffered between pipeline stages
+
+    std::string frame_policy;  // "every" (default), "latest", "target_fps" or "fair"
+    std::string target_fps;
+    std::string channel_weight;   // fair: frames per round-robin turn, default 1
+    std::string channel_max_fps;  // fair: quota, 0 (default) for none
+
+    std::vector<StreamOverride> stream_overrides;
+
+    std::string preprocess;  // "sdk" (default) or "fused"
+
+    std::vector<OutputSetting> output_settings;
+
+    std::vector<BatchSetting> batch_settings;
+
+    std::vector<CropInfo> crop_rois;
+    std::string crop_grid;  // "<columns>x<rows>" tiles, empty for none
+
+    std::string metadata_format;  // "xml" (default, ONVIF), "json" or "binary"
+
+    std::string publish_mode;           // "every" (default) or "on_change"
+    std::string publish_score_delta;    // on_change: score move that republishes
+    std::string publish_keep_alive_ms;  // on_change: longest silence, 0 for none
+    std::string publish_debounce_ms;    // on_change: how long a new top-1 must hold
+
+    std::string smoothing;         // "none" (default), "ema" or "window"
+    std::string smoothing_alpha;   // ema: weight of the newest frame, (0, 1]
+    std::string smoothing_window;  // window: frames averaged
+
+    std::string scene_gate;        // "off" (default) or "on"
+    std::string scene_threshold;   // mean absolute luma change that re-runs the networks
+    std::string scene_refresh_ms;  // longest a result is reused, 0 for no limit
+
+    std::string network_concurrency;  // "parallel" (default) or "sequential"
+
+    std::vector<CascadeSetting> cascade_settings;
+
+    std::string auto_load;  // "off" (default) or "on": load model_name at start, no /configuration needed
+
+    std::string model_sharing;  // "on" (default): channels loading the same model share it, or "off"
+
     void reset() {
       model_name.clear();
+      model_file.clear();
       input_tensor_names.clear();
       output_tensor_names.clear();
       get_index_input_name.clear();
       get_index_output_name.clear();
       get_name_input_index.clear();
       get_name_output_index.clear();
+      inference_mode.clear();
+      pipeline_queue_depth.clear();
+      frame_policy.clear();
+      target_fps.clear();
+      channel_weight.clear();
+      channel_max_fps.clear();
+      stream_overrides.clear();
+      preprocess.clear();
+      output_settings.clear();
+      batch_settings.clear();
+      crop_rois.clear();
+      crop_grid.clear();
+      metadata_format.clear();
+      publish_mode.clear();
+      publish_score_delta.clear();
+      publish_keep_alive_ms.clear();
+      publish_debounce_ms.clear();
+      smoothing.clear();
+      smoothing_alpha.clear();
+      smoothing_window.clear();
+      scene_gate.clear();
+      scene_threshold.clear();
+      scene_refresh_ms.clear();
+      network_concurrency.clear();
+      cascade_settings.clear();
+      auto_load.clear();
+      model_sharing.clear();
     }
 
     AppAttributeInfo() { reset(); }
@@ -72,6 +199,7 @@ class Classification : public Component {
       app_info.SetObject();
 
       JsonUtility::set(app_info, "model_name", app_attribute_info.model_name, alloc);
+      JsonUtility::set(app_info, "model_file", app_attribute_info.model_file, alloc);
       JsonUtility::set(app_info, "input_tensor_names", app_attribute_info.input_tensor_names, alloc);
       JsonUtility::set(app_info, "output_tensor_names", app_attribute_info.output_tensor_names, alloc);
 
@@ -80,6 +208,95 @@ class Classification : public Component {
       JsonUtility::set(app_info, "get_name_input_index", app_attribute_info.get_name_input_index, alloc);
       JsonUtility::set(app_info, "get_name_output_index", app_attribute_info.get_name_output_index, alloc);
 
+      JsonUtility::set(app_info, "inference_mode", app_attribute_info.inference_mode, alloc);
+      JsonUtility::set(app_info, "pipeline_queue_depth", app_attribute_info.pipeline_queue_depth, alloc);
+
+      JsonUtility::set(app_info, "frame_policy", app_attribute_info.frame_policy, alloc);
+      JsonUtility::set(app_info, "target_fps", app_attribute_info.target_fps, alloc);
+      JsonUtility::set(app_info, "channel_weight", app_attribute_info.channel_weight, alloc);
+      JsonUtility::set(app_info, "channel_max_fps", app_attribute_info.channel_max_fps, alloc);
+
+      JsonUtility::ValueType stream_overrides(rapidjson::kArrayType);
+      for (auto& item : app_attribute_info.stream_overrides) {
+        JsonUtility::ValueType stream_override(rapidjson::kObjectType);
+        JsonUtility::set(stream_override, "model_name", item.model_name, alloc);
+        JsonUtility::set(stream_override, "min_width", item.min_width, alloc);
+        JsonUtility::set(stream_override, "min_height", item.min_height, alloc);
+        JsonUtility::set(stream_override, "stream_index", item.stream_index, alloc);
+        stream_overrides.PushBack(stream_override, alloc);
+      }
+      app_info.AddMember(JsonUtility::ValueType("stream_overrides", alloc), stream_overrides, alloc);
+
+      JsonUtility::set(app_info, "preprocess", app_attribute_info.preprocess, alloc);
+
+      JsonUtility::ValueType output_settings(rapidjson::kArrayType);
+      for (auto& item : app_attribute_info.output_settings) {
+        JsonUtility::ValueType output_setting(rapidjson::kObjectType);
+        JsonUtility::set(output_setting, "model_name", item.model_name, alloc);
+        JsonUtility::set(output_setting, "output_name", item.output_name, alloc);
+        JsonUtility::set(output_setting, "top_k", item.top_k, alloc);
+        JsonUtility::set(output_setting, "activation", item.activation, alloc);
+        JsonUtility::set(output_setting, "scale", item.scale, alloc);
+        JsonUtility::set(output_setting, "zero_point", item.zero_point, alloc);
+        output_settings.PushBack(output_setting, alloc);
+      }
+      app_info.AddMember(JsonUtility::ValueType("output_settings", alloc), output_settings, alloc);
+
+      JsonUtility::ValueType batch_settings(rapidjson::kArrayType);
+      for (auto& item : app_attribute_info.batch_settings) {
+        JsonUtility::ValueType batch_setting(rapidjson::kObjectType);
+        JsonUtility::set(batch_setting, "model_name", item.model_name, alloc);
+        JsonUtility::set(batch_setting, "batch_size", item.batch_size, alloc);
+        JsonUtility::set(batch_setting, "max_wait_ms", item.max_wait_ms, alloc);
+        batch_settings.PushBack(batch_setting, alloc);
+      }
+      app_info.AddMember(JsonUtility::ValueType("batch_settings", alloc), batch_settings, alloc);
+
+      JsonUtility::ValueType crop_rois(rapidjson::kArrayType);
+      for (auto& item : app_attribute_info.crop_rois) {
+        JsonUtility::ValueType crop_roi(rapidjson::kObjectType);
+        JsonUtility::set(crop_roi, "x", item.x, alloc);
+        JsonUtility::set(crop_roi, "y", item.y, alloc);
+        JsonUtility::set(crop_roi, "width", item.width, alloc);
+        JsonUtility::set(crop_roi, "height", item.height, alloc);
+        crop_rois.PushBack(crop_roi, alloc);
+      }
+      app_info.AddMember(JsonUtility::ValueType("crop_rois", alloc), crop_rois, alloc);
+      JsonUtility::set(app_info, "crop_grid", app_attribute_info.crop_grid, alloc);
+
+      JsonUtility::set(app_info, "metadata_format", app_attribute_info.metadata_format, alloc);
+
+      JsonUtility::set(app_info, "publish_mode", app_attribute_info.publish_mode, alloc);
+      JsonUtility::set(app_info, "publish_score_delta", app_attribute_info.publish_score_delta, alloc);
+      JsonUtility::set(app_info, "publish_keep_alive_ms", app_attribute_info.publish_keep_alive_ms, alloc);
+      JsonUtility::set(app_info, "publish_debounce_ms", app_attribute_info.publish_debounce_ms, alloc);
+
+      JsonUtility::set(app_info, "smoothing", app_attribute_info.smoothing, alloc);
+      JsonUtility::set(app_info, "smoothing_alpha", app_attribute_info.smoothing_alpha, alloc);
+      JsonUtility::set(app_info, "smoothing_window", app_attribute_info.smoothing_window, alloc);
+
+      JsonUtility::set(app_info, "scene_gate", app_attribute_info.scene_gate, alloc);
+      JsonUtility::set(app_info, "scene_threshold", app_attribute_info.scene_threshold, alloc);
+      JsonUtility::set(app_info, "scene_refresh_ms", app_attribute_info.scene_refresh_ms, alloc);
+
+      JsonUtility::set(app_info, "network_concurrency", app_attribute_info.network_concurrency, alloc);
+
+      JsonUtility::ValueType cascade_settings(rapidjson::kArrayType);
+      for (auto& item : app_attribute_info.cascade_settings) {
+        JsonUtility::ValueType cascade_setting(rapidjson::kObjectType);
+        JsonUtility::set(cascade_setting, "model_name", item.model_name, alloc);
+        JsonUtility::set(cascade_setting, "detector", item.detector, alloc);
+        JsonUtility::set(cascade_setting, "output_name", item.output_name, alloc);
+        JsonUtility::set(cascade_setting, "min_score", item.min_score, alloc);
+        JsonUtility::set(cascade_setting, "max_boxes", item.max_boxes, alloc);
+        cascade_settings.PushBack(cascade_setting, alloc);
+      }
+      app_info.AddMember(JsonUtility::ValueType("cascade_settings", alloc), cascade_settings, alloc);
+
+      JsonUtility::set(app_info, "auto_load", app_attribute_info.auto_load, alloc);
+
+      JsonUtility::set(app_info, "model_sharing", app_attribute_info.model_sharing, alloc);
+
       attributes_info.PushBack(app_info, alloc);
 
       document.AddMember(JsonUtility::ValueType("Attributes", alloc), attributes_info, alloc);
@@ -117,6 +334,7 @@ class Classification : public Component {
             AppAttributeInfo app_info;
 
             JsonUtility::get(arrayItr, "model_name", app_info.model_name);
+            JsonUtility::get(arrayItr, "model_file", app_info.model_file);
             JsonUtility::get(arrayItr, "input_tensor_names", app_info.input_tensor_names);
             JsonUtility::get(arrayItr, "output_tensor_names", app_info.output_tensor_names);
 
@@ -125,6 +343,100 @@ class Classification : public Component {
             JsonUtility::get(arrayItr, "get_index_output_name", app_info.get_index_output_name);
             JsonUtility::get(arrayItr, "get_name_output_index", app_info.get_name_output_index);
 
+            JsonUtility::get(arrayItr, "inference_mode", app_info.inference_mode);
+            JsonUtility::get(arrayItr, "pipeline_queue_depth", app_info.pipeline_queue_depth);
+
+            JsonUtility::get(arrayItr, "frame_policy", app_info.frame_policy);
+            JsonUtility::get(arrayItr, "target_fps", app_info.target_fps);
+            JsonUtility::get(arrayItr, "channel_weight", app_info.channel_weight);
+            JsonUtility::get(arrayItr, "channel_max_fps", app_info.channel_max_fps);
+
+            auto stream_overrides = arrayItr.FindMember("stream_overrides");
+            if (stream_overrides != arrayItr.MemberEnd() && stream_overrides->value.IsArray()) {
+              for (JsonUtility::ValueType& overrideItr : stream_overrides->value.GetArray()) {
+                StreamOverride item;
+                JsonUtility::get(overrideItr, "model_name", item.model_name);
+                JsonUtility::get(overrideItr, "min_width", item.min_width);
+                JsonUtility::get(overrideItr, "min_height", item.min_height);
+                JsonUtility::get(overrideItr, "stream_index", item.stream_index);
+                app_info.stream_overrides.push_back(item);
+              }
+            }
+
+            JsonUtility::get(arrayItr, "preprocess", app_info.preprocess);
+
+            auto output_settings = arrayItr.FindMember("output_settings");
+            if (output_settings != arrayItr.MemberEnd() && output_settings->value.IsArray()) {
+              for (JsonUtility::ValueType& settingItr : output_settings->value.GetArray()) {
+                OutputSetting item;
+                JsonUtility::get(settingItr, "model_name", item.model_name);
+                JsonUtility::get(settingItr, "output_name", item.output_name);
+                JsonUtility::get(settingItr, "top_k", item.top_k);
+                JsonUtility::get(settingItr, "activation", item.activation);
+                JsonUtility::get(settingItr, "scale", item.scale);
+                JsonUtility::get(settingItr, "zero_point", item.zero_point);
+                app_info.output_settings.push_back(item);
+              }
+            }
+
+            auto batch_settings = arrayItr.FindMember("batch_settings");
+            if (batch_settings != arrayItr.MemberEnd() && batch_settings->value.IsArray()) {
+              for (JsonUtility::ValueType& settingItr : batch_settings->value.GetArray()) {
+                BatchSetting item;
+                JsonUtility::get(settingItr, "model_name", item.model_name);
+                JsonUtility::get(settingItr, "batch_size", item.batch_size);
+                JsonUtility::get(settingItr, "max_wait_ms", item.max_wait_ms);
+                app_info.batch_settings.push_back(item);
+              }
+            }
+
+            auto crop_rois = arrayItr.FindMember("crop_rois");
+            if (crop_rois != arrayItr.MemberEnd() && crop_rois->value.IsArray()) {
+              for (JsonUtility::ValueType& roiItr : crop_rois->value.GetArray()) {
+                CropInfo item;
+                JsonUtility::get(roiItr, "x", item.x);
+                JsonUtility::get(roiItr, "y", item.y);
+                JsonUtility::get(roiItr, "width", item.width);
+                JsonUtility::get(roiItr, "height", item.height);
+                app_info.crop_rois.push_back(item);
+              }
+            }
+            JsonUtility::get(arrayItr, "crop_grid", app_info.crop_grid);
+
+            JsonUtility::get(arrayItr, "metadata_format", app_info.metadata_format);
+
+            JsonUtility::get(arrayItr, "publish_mode", app_info.publish_mode);
+            JsonUtility::get(arrayItr, "publish_score_delta", app_info.publish_score_delta);
+            JsonUtility::get(arrayItr, "publish_keep_alive_ms", app_info.publish_keep_alive_ms);
+            JsonUtility::get(arrayItr, "publish_debounce_ms", app_info.publish_debounce_ms);
+
+            JsonUtility::get(arrayItr, "smoothing", app_info.smoothing);
+            JsonUtility::get(arrayItr, "smoothing_alpha", app_info.smoothing_alpha);
+            JsonUtility::get(arrayItr, "smoothing_window", app_info.smoothing_window);
+
+            JsonUtility::get(arrayItr, "scene_gate", app_info.scene_gate);
+            JsonUtility::get(arrayItr, "scene_threshold", app_info.scene_threshold);
+            JsonUtility::get(arrayItr, "scene_refresh_ms", app_info.scene_refresh_ms);
+
+            JsonUtility::get(arrayItr, "network_concurrency", app_info.network_concurrency);
+
+            auto cascade_settings = arrayItr.FindMember("cascade_settings");
+            if (cascade_settings != arrayItr.MemberEnd() && cascade_settings->value.IsArray()) {
+              for (JsonUtility::ValueType& settingItr : cascade_settings->value.GetArray()) {
+                CascadeSetting item;
+                JsonUtility::get(settingItr, "model_name", item.model_name);
+                JsonUtility::get(settingItr, "detector", item.detector);
+                JsonUtility::get(settingItr, "output_name", item.output_name);
+                JsonUtility::get(settingItr, "min_score", item.min_score);
+                JsonUtility::get(settingItr, "max_boxes", item.max_boxes);
+                app_info.cascade_settings.push_back(item);
+              }
+            }
+
+            JsonUtility::get(arrayItr, "auto_load", app_info.auto_load);
+
+            JsonUtility::get(arrayItr, "model_sharing", app_info.model_sharing);
+
             app_attribute_info = app_info;
           }
         }
@@ -158,7 +470,7 @@ class Classification : public Component {
   };
  public:
   using base = Component;
-  using NeuralNeworkMap = std::unordered_map<std::string, std::unique_ptr<NeuralNetwork>>;
+  using NeuralNeworkMap = NetworkRegistry::Map;
 
  public:
   Classification();
@@ -172,19 +484,19 @@ class Classification : public Component {
   bool Finalize() override;
 
   bool UnloadNetwork(const std::string& model_path);
-  bool PreProcess(const std::string& model_path, std::shared_ptr<Tensor> rgb);
+  bool PreProcess(const std::string& model_path, const RawImage* source, std::shared_ptr<Tensor> rgb, uint32_t slot = 0);
   void HandleRequest(Event* event);
   bool Execute(const std::string& model_path);
-  bool PostProcess(const std::string& model_path, const std::shared_ptr<Tensor>& img);
+  // |parsed| turns false when an output did not parse; that output is left out.
+  bool PostProcess(const std::string& model_path, std::vector<std::vector<ClassResult>>& objects, bool& parsed);
 
   virtual void RegisterOpenAPIURI();
-  bool ParseNpuEvent(const std::string& event_body);
+  bool ParseNpuEvent(const std::string& event_body, std::string& response_body);
   bool InsertNpuLoadInfo(std::string& target, std::string recv_value);
   bool ParseManifest(const std::string& manifest_path, ManifestInfo& info);
   void SetMetaFrameSchema();
   void SetMetaFrameCapabilitySchema();
-  void SendMetadata();  
-  std::string GetXml(const int* max_id, const float* max_val, const int64_t timestamp);
+  void SendMetadata(const std::string& model_path, uint32_t output, const ClassResult* objects, size_t count);
   Vector<String> Split(String line, char seperator);
 
   bool CreateNetwork(NeuralNetwork* network, JsonUtility::JsonDocument& document);
@@ -197,12 +509,102 @@ class Classification : public Component {
   bool GetTensorIndex(NeuralNetwork* network, JsonUtility::JsonDocument& document, const std::string& request);
   bool GetAllTensor(NeuralNetwork* network, const std::string& mod);
   bool GetTensorCount(NeuralNetwork* network, const std::string& mod);
+  bool GetStats(JsonUtility::JsonDocument& document, std::string& response_body);
+  bool SetInferenceMode(JsonUtility::JsonDocument& document);
+  bool SetFramePolicy(JsonUtility::JsonDocument& document);
+  bool SetStreamSelection(JsonUtility::JsonDocument& document);
+  bool SetPreprocess(JsonUtility::JsonDocument& document);
+  bool SetCrops(JsonUtility::JsonDocument& document);
+  bool SetBatching(JsonUtility::JsonDocument& document);
+  bool SetOutput(JsonUtility::JsonDocument& document);
+  bool SetMetadataFormat(JsonUtility::JsonDocument& document);
+  bool SetPublishPolicy(JsonUtility::JsonDocument& document);
+  bool SetSmoothing(JsonUtility::JsonDocument& document);
+  bool SetSceneGate(JsonUtility::JsonDocument& document);
+  bool SetNetworkConcurrency(JsonUtility::JsonDocument& document);
+  bool SetCascade(JsonUtility::JsonDocument& document);
+  bool SwapModel(JsonUtility::JsonDocument& document);
+  bool GetSwapStatus(std::string& response_body);
+  bool SetAutoLoad(JsonUtility::JsonDocument& document);
+  bool GetStartupStatus(std::string& response_body);
+  bool SetModelSharing(JsonUtility::JsonDocument& document);
   std::string TimePointToString(uint64_t timestamp) const;
 
  private:
-  void Inference(std::shared_ptr<RawImage> img);
-  bool ParseResult(float* data, int out_width);
+  void Inference(const RawImage* img, const std::shared_ptr<FrameJob::Published>& reference);
+  bool InferNetwork(const std::string& model_path, const RawImage* source, const std::shared_ptr<Tensor>& rgb,
+                    std::vector<std::vector<ClassResult>>& objects, bool& parsed);
+  void ListNetworks();
+  void ReleaseNetworks();
+  NeuralNetwork* FrameNetwork(const std::string& name) const;
+  bool InferCascade(const std::string& model_path, const RawImage* source,
+                    const std::vector<FrameJob::NetworkResult>& results, std::vector<CropRect>& crops,
+                    std::vector<std::vector<ClassResult>>& objects, bool& parsed);
+  bool DecodeDetections(const std::string& model_path, uint32_t slot, std::vector<std::vector<ClassResult>>& objects);
+  void UpdateCascades();
+  struct NetworkPreprocess {
+    FusedPreprocessor cpu;
+    bool fused = false;  // whole-frame input also goes through |cpu|
+    std::vector<float> mean;   // normalisation left to the SDK
+    std::vector<float> scale;
+  };
+  struct ModelSwap {
+    std::string model_name;  // network being replaced, keeps its name and settings
+    std::string model_file;
+    std::string model_path;
+    std::vector<std::string> input_names;
+    std::vector<std::string> output_names;
+    NetworkPreprocess preprocess;
+    bool shared = true;        // model_sharing when requested
+    uint64_t generation = 0;   // network_generation_ when requested
+    std::string state = "none";  // "loading", "done" or "failed"
+    uint64_t load_ms = 0;
+    uint64_t warmup_ms = 0;
+  };
+  void RunModelSwap(ModelSwap swap);
+  static bool WarmUp(NeuralNetwork& network);
+  void StartAutoLoad();
+  void FinishAutoLoad();
+  bool PrepareSource(const RawImage* img, const RawImage*& source, std::shared_ptr<Tensor>& rgb);
+  // False when the output did not parse; nothing is published then.
+  bool PublishResult(const std::string& model_path, uint32_t output, const OutputView& view,
+                     FrameJob::Published* reference);
+  void ExecuteBatch(const std::vector<FrameJob*>& jobs);
+  void PublishJob(FrameJob& job);
+  void StartPipeline();
+  void StopPipeline();
+  void ApplyFramePolicy();
+  void StopFrameMailbox();
+  void StopChannelScheduling();
+  void UpdateStreamRequirement();
+  void ApplyMetadataFormat();
+  void ApplyPublishPolicy();
+  void ApplySmoothing();
+  void ApplySceneGate();
+  void ApplyNetworkConcurrency();
+  static void RememberResult(FrameJob::Published* reference, const std::string& model_path, uint32_t output,
+                             const ClassResult* objects, size_t count);
+  void PublishReused(const FrameJob::Published& reference);
+  void FinishReference(const std::shared_ptr<FrameJob::Published>& reference, bool published);
+  void InvalidateLastResults();
+  void ForgetSwappedModels();
+  struct OutputSpec {
+    uint32_t top_k = 5;
+    Activation::Type activation = Activation::Type::eNone;
+    float scale = 1.0f;
+    int32_t zero_point = 0;
+  };
+  const OutputSpec& GetOutputSpec(const std::string& model_path, uint32_t output) const;
+  void UpdateOutputSpecs();
+  bool ParseResult(const OutputView& output, const OutputSpec& spec, ClassResult& result);
+  template <typename T>
+  static uint32_t SelectQuantized(const T* data, size_t width, const OutputSpec& spec, TopK::Entry* top);
+  bool ExecuteCrops(const std::string& model_path, const RawImage* source, const std::vector<CropRect>& crops,
+                    std::vector<std::vector<ClassResult>>& objects, bool& parsed);
+  void UpdateCrops();
+  bool IsBatched(const std::string& model_path) const;
   void ProcessRawVideo(Event* event);
+  void ProcessFrame(Blob& blob, StageClock::time_point arrival);
   void DebugLog(const char* format, ...)
   {
     char buffer[1024] = {};
@@ -229,20 +631,102 @@ class Classification : public Component {
 
   std::string relative_model_path;
 
-  int max_id[5];
-  float max_val[5];
   uint64_t raw_pts = 0;
-  bool parse_result = true;
+  std::atomic<bool> parse_result{true};
 
   bool run_flag = 0;
+  StageStats stage_stats_;
+
+  enum class FramePolicy { eEvery, eLatest, eTargetFps, eFair };
+  FramePolicy frame_policy_ = FramePolicy::eEvery;
+  StageClock::duration admit_period_{};
+  StageClock::time_point next_admit_;
+  std::atomic<bool> channel_scheduled_{false};  // frames go through ChannelScheduler
   std::shared_ptr<RunNeuralNetworkInfoList> run_neural_network_info_list;
   ManifestInfo manifest_;
 
 protected:
   NeuralNetwork* GetOrCreateNetwork(const std::string& name);
   NeuralNetwork* GetNetwork(const std::string& name);
-  NeuralNeworkMap& GetAllNetworks();
+  // Hold on to the snapshot while iterating it.
+  NetworkRegistry::Snapshot GetAllNetworks() const;
   void RemoveNetwork(const std::string& name);
 
-  NeuralNeworkMap nn_map_;
+  NetworkRegistry network_registry_;
+  // one /configuration request, or the commit of a model swap, at a time;
+  // frames never take it
+  std::mutex config_mutex_;
+  uint64_t network_generation_ = 0;  // bumped whenever a network is removed
+  ModelSwap model_swap_;             // the latest swap_model, under config_mutex_
+  std::atomic<bool> swap_busy_{false};
+  std::thread swap_thread_;
+  // swapped networks whose smoothing and publish history the publishing
+  // thread drops before its next message
+  std::mutex swapped_models_mutex_;
+  std::vector<std::string> swapped_models_;
+  std::atomic<bool> has_swapped_models_{false};
+
+ private:
+  // outlives the frames held by pipeline_ and frame_mailbox_
+  RawFramePool raw_frame_pool_;
+  SourceTensorPool source_tensor_pool_;
+  StreamSelector stream_selector_;
+  std::map<std::string, NetworkPreprocess> preprocess_;
+  NetworkPreprocess MakePreprocess(NeuralNetwork* network) const;
+  // |model_file| in place of the one persisted for |model_name|, when given
+  std::string ModelPath(const std::string& model_name, const std::string& model_file = "") const;
+  // loads |network|, or with |shared| takes the same model already loaded by
+  // any channel instead; nullptr when loading fails
+  static std::shared_ptr<NeuralNetwork> LoadModel(std::shared_ptr<NeuralNetwork> network, const std::string& model_path,
+                                                  const NetworkPreprocess& preprocess, bool shared);
+  struct AutoLoad {
+    std::string state = "off";  // "loading", "done" or "failed"
+    std::string model_path;
+    NetworkPreprocess preprocess;
+    std::shared_ptr<NeuralNetwork> network;  // loaded by auto_load_thread_, read once it is joined
+    uint64_t load_ms = 0;
+    uint64_t warmup_ms = 0;
+  };
+  AutoLoad auto_load_;
+  std::atomic<bool> auto_load_ready_{false};  // auto_load_thread_ is done, FinishAutoLoad() takes over
+  std::thread auto_load_thread_;
+  StageClock::time_point boot_;
+  std::atomic<int64_t> first_metadata_ms_{-1};  // since boot_
+  std::vector<CropRect> crops_;
+  struct CascadeSpec {
+    std::string detector;
+    float min_score = 0.5f;
+    size_t max_boxes = 16;
+  };
+  std::map<std::string, CascadeSpec> cascades_;  // per network classifying a detector's boxes
+  struct DetectorSpec {
+    uint32_t output = 0;  // output tensor with the box rows
+    float min_score;      // loosest of the networks it feeds
+    size_t max_boxes;
+  };
+  std::map<std::string, DetectorSpec> detectors_;
+  std::map<std::string, size_t> batch_sizes_;  // per network while pipelined
+  std::map<std::string, std::vector<OutputSpec>> output_specs_;  // per network, per output tensor
+  MetadataWriter::Format metadata_format_ = MetadataWriter::Format::eXml;
+  MetadataWriter metadata_writer_;  // used by whichever thread publishes
+  PublishFilter publish_filter_;    // likewise
+  TemporalSmoother smoother_;       // likewise
+  // frames are gated on the frame thread, a failed reference is dropped on
+  // the publishing one
+  std::mutex scene_mutex_;
+  SceneGate scene_gate_;
+  std::shared_ptr<FrameJob::Published> scene_reference_;  // result of the gate's reference frame
+  // the frame being inferred works from one snapshot of the registry
+  NetworkRegistry::Snapshot network_snapshot_;
+  std::vector<const NeuralNeworkMap::value_type*> network_order_;  // network_snapshot_ by index, see ListNetworks()
+  size_t cascade_begin_ = 0;  // network_order_ from here on runs on detector boxes
+  std::vector<FrameJob::NetworkResult> network_results_;    // sync path, one per network
+  std::mutex sdk_resize_mutex_;
+  // runs networks for the sync path and the pipeline's execute stage
+  NetworkWorkers network_workers_;
+  // its worker threads call back into the members above; ~Classification()
+  // stops it, and the frame sources feeding it, before any member goes
+  InferencePipeline pipeline_;
+  // feeds pipeline_, so it is destroyed first
+  FrameMailbox frame_mailbox_;
 };
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "class_result.h"
+
+/**
+ * @brief Boxes from a detector output, the first stage of a cascade
+ *        (detector -> crop -> classifier).
+ *        The output holds fixed-size rows of [x, y, width, height, score,
+ *        class], the box normalised to the frame with (x, y) its top-left
+ *        corner; rows left unused carry a score of 0. Overlapping boxes are
+ *        expected to have been suppressed by the network already.
+ *        Quantised outputs are read as real = (q - zero_point) * scale.
+ */
+class DetectionDecoder {
+ public:
+  static constexpr int kRowSize = 6;
+
+  // Replaces |boxes| with the rows scoring at least |min_score|, best first
+  // (earlier row on ties), at most |max_boxes|, clipped to the frame. Each
+  // box becomes a ClassResult with the detected class as its only entry.
+  // False when the output does not hold whole rows.
+  static bool Decode(const OutputView& output, float scale, int32_t zero_point, float min_score, size_t max_boxes,
+                     std::vector<ClassResult>& boxes);
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "i_pl_video_frame_raw.h"
+#include "stage_stats.h"
+
+/**
+ * @brief Single-slot hand-off for raw video frames ("latest frame wins").
+ *        Post() never blocks: a frame still waiting in the slot is released
+ *        untouched and replaced by the new one. A worker thread takes frames
+ *        out of the slot one at a time and passes them to the handler.
+ */
+class FrameMailbox {
+ public:
+  using Handler = std::function<void(Blob& blob, StageClock::time_point arrival)>;
+
+  FrameMailbox() = default;
+  ~FrameMailbox() { Stop(); }
+
+  bool Start(Handler handler);
+  // Releases a frame left in the slot.
+  void Stop();
+  bool IsRunning() const { return running_; }
+
+  // Returns true when a pending frame was superseded.
+  bool Post(const Blob& blob, StageClock::time_point arrival);
+  // Waits until the slot is empty and the handler is idle.
+  void Drain();
+
+ private:
+  void WorkerLoop();
+
+  bool running_ = false;
+  Handler handler_;
+  std::thread worker_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_cv_;
+  std::condition_variable idle_cv_;
+  Blob pending_;
+  StageClock::time_point pending_arrival_;
+  bool has_pending_ = false;
+  bool busy_ = false;
+  bool closed_ = false;
+};
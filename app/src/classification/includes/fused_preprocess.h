@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "sdk_access.h"
+
+/**
+ * @brief Region of a frame, normalised to [0, 1] of its width and height.
+ */
+struct CropRect {
+  float x;
+  float y;
+  float width;
+  float height;
+};
+
+/**
+ * @brief One-pass CPU preprocessing from a raw frame to a network input.
+ *        Bilinear resize, BT.601 NV12 -> RGB conversion, (v - mean) * scale
+ *        and HWC -> CHW are done together per output row, so the full-size
+ *        RGB copy built by Tensor::Allocate() is never needed. The vertical
+ *        blend / colour / normalisation pass is NEON on aarch64 and plain
+ *        (auto-vectorisable) C++ elsewhere.
+ *
+ *        Float32 inputs are written CHW and normalised here, so the network
+ *        has to be loaded with an identity mean/scale. Uint8 inputs are
+ *        written as packed RGB and left for the SDK to normalise.
+ */
+class FusedPreprocessor {
+ public:
+  FusedPreprocessor();
+
+  static bool Supports(PixelLayout layout);
+
+  void SetNormalization(const std::vector<float>& mean, const std::vector<float>& scale);
+  // Fills the top-left |size| region of |dst| from |src|, or from the
+  // |crop| part of it. |slot| selects the image in a batched input tensor
+  // (dims {w, h, 3, N}).
+  bool Run(const RawImage& src, Tensor& dst, const img_size_t& size,
+           const CropRect* crop = nullptr, uint32_t slot = 0);
+
+ private:
+  struct Region {
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+  };
+
+  static Region ToPixels(const RawImage& src, const CropRect* crop);
+  void PrepareTables(const Region& region, const img_size_t& size);
+  void ResampleRows(const RawImage& src, uint32_t y0, uint32_t y1);
+  void StoreRow(Tensor& dst, uint32_t slot, uint32_t y, float wy, bool yuv);
+
+  float mean_[3];
+  float scale_[3];
+
+  // sampling tables, rebuilt only when the source region or output size changes
+  Region region_ = {0, 0, 0, 0};
+  img_size_t size_ = {0, 0};
+  std::vector<uint32_t> x0_;
+  std::vector<uint32_t> x1_;
+  std::vector<float> wx_;
+  std::vector<uint32_t> y0_;
+  std::vector<uint32_t> y1_;
+  std::vector<float> wy_;
+
+  // six horizontally resampled rows: channel 0..2 at y0, then at y1
+  // (Y, U, V for NV12 sources, R, G, B for RGB888)
+  std::vector<float> rows_;
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "class_result.h"
+#include "raw_frame_pool.h"
+#include "stage_stats.h"
+#include "tensor.h"
+
+/**
+ * @brief One frame travelling through the pipelined inference path.
+ *        Output tensors are copied out right after RunNetwork so the NPU can
+ *        start on the next frame while this one is parsed and published.
+ */
+struct FrameJob {
+  struct NetworkResult {
+    struct Output {
+      ElementType type;
+      int width;
+      std::vector<uint8_t> bytes;  // as the tensor stores them, quantised or not
+    };
+
+    std::string name;
+    bool ok = false;
+    bool parsed = true;  // every output parsed; one that did not is left out of |objects|
+    std::vector<Output> outputs;  // one per output tensor
+    std::vector<std::vector<ClassResult>> objects;  // per output tensor, one per crop
+    std::vector<CropRect> crops;  // cascade: the detector boxes this network ran on
+  };
+
+  // What a frame that changed the scene published, for the frames found
+  // unchanged against it; filled on the publishing thread, which gets to
+  // those frames only after this one.
+  struct Published {
+    std::map<std::string, std::vector<std::vector<ClassResult>>> results;  // per network, per output
+    bool ok = false;  // every network published
+  };
+
+  uint64_t pts = 0;
+  StageClock::time_point arrival;
+  std::shared_ptr<const Published> reuse;  // scene unchanged: publish this again
+  std::shared_ptr<Published> reference;    // scene changed: this frame's result, for the frames reusing it
+  const RawImage* image = nullptr;  // selected stream, points into source
+  std::shared_ptr<Tensor> rgb;     // null when every network preprocesses from image
+  RawFrame source;  // the raw frame rgb was built from
+  std::vector<NetworkResult> results;
+};
+
+/**
+ * @brief Three-stage frame pipeline.
+ *        The caller (scheduler thread) prepares jobs and Submit()s them; an
+ *        execute thread runs the networks and a publish thread parses and
+ *        sends the results. Each stage is a single thread fed by a bounded
+ *        FIFO, so jobs leave in the order they were submitted.
+ *
+ *        The execute stage hands out up to |max_batch| consecutive jobs at a
+ *        time, waiting at most |max_wait| after the first one for the rest.
+ */
+class InferencePipeline {
+ public:
+  using StageFunc = std::function<void(FrameJob&)>;
+  using BatchFunc = std::function<void(const std::vector<FrameJob*>&)>;
+
+  InferencePipeline() = default;
+  ~InferencePipeline() { Stop(); }
+
+  bool Start(size_t queue_depth, BatchFunc execute, StageFunc publish);
+  // Takes effect on the next Start().
+  void SetBatching(size_t max_batch, StageClock::duration max_wait);
+  void Stop();
+  bool IsRunning() const { return running_; }
+
+  // Blocks while the execute queue is full.
+  bool Submit(std::unique_ptr<FrameJob> job);
+  // True when Submit() would not block; exact only for the one submitting thread.
+  bool CanSubmit() const;
+  // Waits until every submitted job has been published.
+  void Drain();
+
+ private:
+  void ExecuteLoop();
+  void PublishLoop();
+  void JobDone();
+
+  std::atomic<bool> running_{false};
+  BatchFunc execute_;
+  StageFunc publish_;
+  size_t max_batch_ = 1;
+  StageClock::duration max_wait_ = StageClock::duration::zero();
+  BoundedQueue<std::unique_ptr<FrameJob>> execute_queue_;
+  BoundedQueue<std::unique_ptr<FrameJob>> publish_queue_;
+  std::thread execute_thread_;
+  std::thread publish_thread_;
+
+  std::mutex pending_mutex_;
+  std::condition_variable pending_cv_;
+  size_t pending_ = 0;
+};
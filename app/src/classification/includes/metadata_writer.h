@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "class_result.h"
+
+/**
+ * @brief Serializer for the metadata sent per classification result.
+ *        eXml is the ONVIF MetadataStream document. eJson and eBinary are
+ *        compact encodings for consumers that do not need ONVIF:
+ *
+ *          json   {"t":<pts ms>,"ch":<channel>,"model":<model id>,
+ *                  "objects":[{"box":[x,y,w,h],"classes":[[id,score],...]}]}
+ *                 ("box" only for crop results, normalised to the frame)
+ *          binary version 1 record, little-endian, base64 encoded:
+ *                   u8 version, u8 channel, u16 object count,
+ *                   u32 model id, u64 pts ms
+ *                 then per object:
+ *                   u8 class count, u8 flags (bit 0: box), u16 0,
+ *                   [f32 x, y, w, h if boxed], count x {i32 id, f32 score}
+ *
+ *        Writes into reused buffers: constants are copied, numbers are
+ *        formatted in place (to_chars, and a fixed 6-digit formatter that
+ *        matches std::to_string(float)), and the "YYYY-MM-DDTHH:MM:SS." part
+ *        of the XML timestamp is cached per UTC second. Once the buffers have
+ *        reached the size of the largest document, Write() does not allocate.
+ */
+class MetadataWriter {
+ public:
+  enum class Format {
+    eXml = 0,
+    eJson,
+    eBinary
+  };
+
+  static constexpr uint8_t kBinaryVersion = 1;
+
+  MetadataWriter();
+
+  // "" and "xml" map to eXml.
+  static bool FromString(const std::string& name, Format& format);
+  // Stable id of a model in the compact formats: FNV-1a (32 bit) of its name.
+  static uint32_t ModelId(const std::string& model_name);
+
+  // The returned document stays valid until the next Write(). |model_id|
+  // and |channel| are only carried by the compact formats.
+  const std::string& Write(Format format, uint32_t model_id, int channel, const ClassResult* objects, size_t count,
+                           uint64_t timestamp_ms);
+
+ private:
+  void WriteXml(const ClassResult* objects, size_t count, uint64_t timestamp_ms);
+  void WriteJson(uint32_t model_id, int channel, const ClassResult* objects, size_t count, uint64_t timestamp_ms);
+  void WriteBinary(uint32_t model_id, int channel, const ClassResult* objects, size_t count, uint64_t timestamp_ms);
+
+  void Append(const char* text, size_t length) { buffer_.append(text, length); }
+  template <size_t N>
+  void Append(const char (&text)[N]) { buffer_.append(text, N - 1); }
+  void AppendInt(int64_t value);
+  void AppendFixed(float value);
+  void AppendTime(uint64_t timestamp_ms);
+  void AppendRecord(uint64_t value, size_t bytes);  // little-endian into record_
+  void AppendRecord(float value);
+
+  std::string buffer_;
+  std::string record_;  // binary record before base64
+  int64_t cached_second_ = INT64_MIN;
+  char second_prefix_[32] = {};
+  size_t second_prefix_length_ = 0;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "neural_network.h"
+
+/**
+ * @brief Loaded networks shared by every channel of the process, so the
+ *        channels running one model hold one copy of its weights (and one
+ *        NPU context) between them.
+ *        A network is shared by the channels that load the same model file
+ *        (path, size and modification time) with the same tensors and
+ *        normalisation. Each gets its own reference, and the network is
+ *        unloaded with the last one. The tensors are shared too, so a
+ *        channel uses a shared network, from filling its inputs to reading
+ *        its outputs, under Lock().
+ */
+class ModelCache {
+ public:
+  static ModelCache& Instance();
+
+  static std::string Key(const std::string& model_path, const NeuralNetwork& network, const std::vector<float>& mean,
+                         const std::vector<float>& scale);
+
+  // The network loaded for |key| by any channel, or else the one |load|
+  // returns; nullptr when that fails.
+  std::shared_ptr<NeuralNetwork> Acquire(const std::string& key,
+                                         const std::function<std::shared_ptr<NeuralNetwork>()>& load);
+
+  // Held while a shared network is used; an empty lock for any other network.
+  static std::unique_lock<std::mutex> Lock(const std::shared_ptr<NeuralNetwork>& network);
+
+ private:
+  struct Entry {
+    std::shared_ptr<NeuralNetwork> network;
+    std::mutex run_mutex;
+  };
+  // deleter of the references handed out: the entry goes with the last one
+  struct Lease {
+    std::shared_ptr<Entry> entry;
+    void operator()(NeuralNetwork*) { entry.reset(); }
+  };
+
+  // a model being loaded has |loading| set, so it is loaded once while the
+  // other models stay available
+  struct Slot {
+    std::weak_ptr<Entry> entry;
+    std::shared_future<std::shared_ptr<Entry>> loading;
+  };
+
+  static std::shared_ptr<NeuralNetwork> MakeLease(std::shared_ptr<Entry> entry);
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Slot> entries_;
+};
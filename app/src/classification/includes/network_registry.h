@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "neural_network.h"
+
+/**
+ * @brief Networks by model name. Frames see the loaded ones through
+ *        immutable snapshots (read-copy-update): a reader takes a snapshot
+ *        and uses it without further locking for as long as it holds it,
+ *        while /configuration copies the current map, changes the copy and
+ *        swaps it in. A network being created and given tensors is not in
+ *        any snapshot until Activate(). A removed network is unloaded and
+ *        freed with the last snapshot that still holds it, so frames already
+ *        running on it finish first.
+ */
+class NetworkRegistry {
+ public:
+  using Map = std::unordered_map<std::string, std::shared_ptr<NeuralNetwork>>;
+  using Snapshot = std::shared_ptr<const Map>;
+
+  NetworkRegistry() : snapshot_(std::make_shared<const Map>()) {}
+
+  // The active networks.
+  Snapshot Load() const { return std::atomic_load(&snapshot_); }
+
+  // An unregistered network, released like a registered one; see Replace().
+  static std::shared_ptr<NeuralNetwork> Create();
+
+  // Any registered network, active or not; for the configuration side. The
+  // pointer stays valid until Remove().
+  NeuralNetwork* Find(const std::string& name) const;
+  NeuralNetwork* GetOrCreate(const std::string& name);
+  std::shared_ptr<NeuralNetwork> Get(const std::string& name) const;
+  // Publishes a loaded network to the frame path.
+  bool Activate(const std::string& name);
+  // Puts |network| in the place of |name|, e.g. a hot swap: when active,
+  // frames pick it up with their next snapshot. The old network goes as a
+  // removed one would. False when |name| is not registered.
+  bool Replace(const std::string& name, std::shared_ptr<NeuralNetwork> network);
+  void Remove(const std::string& name);
+
+ private:
+  void Publish(std::shared_ptr<Map> next);
+
+  mutable std::mutex write_mutex_;  // guards networks_, one writer at a time
+  Map networks_;                    // every registered network
+  Snapshot snapshot_;
+};
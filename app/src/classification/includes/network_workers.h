@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fork-join workers that run the loaded networks side by side.
+ *        Run(count, task) calls task(0) .. task(count - 1) once each, spread
+ *        over the worker threads and the caller, and returns once every call
+ *        has finished. Tasks report failure through their own results, so
+ *        one network failing never holds the others back.
+ */
+class NetworkWorkers {
+ public:
+  using Task = std::function<void(size_t index)>;
+
+  NetworkWorkers() = default;
+  ~NetworkWorkers() { Resize(0); }
+
+  // Keeps |threads| workers besides the caller; 0 runs every task inline.
+  // Not to be called while Run() is in progress.
+  void Resize(size_t threads);
+  size_t Size() const { return threads_.size(); }
+
+  void Run(size_t count, const Task& task);
+
+ private:
+  void WorkerLoop();
+  // Runs tasks of the current Run() until none are left; |lock| is held on
+  // entry and on return.
+  void RunTasks(std::unique_lock<std::mutex>& lock);
+
+  std::vector<std::thread> threads_;
+  std::mutex run_mutex_;  // one Run() at a time
+
+  std::mutex mutex_;
+  std::condition_variable wake_cv_;
+  std::condition_variable done_cv_;
+  const Task* task_ = nullptr;
+  size_t count_ = 0;
+  size_t next_ = 0;
+  size_t finished_ = 0;
+  bool closed_ = false;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "class_result.h"
+
+/**
+ * @brief Change-only publishing: decides whether a metadata message is
+ *        worth sending, per model output, by comparing it with the last one
+ *        that was sent. A message goes out when
+ *          - the number of objects changes,
+ *          - the top-1 class of an object changes and the new class has
+ *            stayed top-1 for the debounce window (so classes flickering
+ *            in and out do not each cause a message),
+ *          - with the top-1 unchanged, the score of a published class moves
+ *            by more than the score delta,
+ *          - or the keep-alive interval has passed since the last message.
+ *        Times are frame pts in milliseconds. Called from one thread at a
+ *        time (the one that publishes).
+ */
+class PublishFilter {
+ public:
+  struct Settings {
+    bool enabled = false;  // off: every message is published
+    float score_delta = 0.1f;
+    uint64_t keep_alive_ms = 1000;  // 0: no keep-alive
+    uint64_t debounce_ms = 0;
+  };
+
+  // Also forgets what was published.
+  void Configure(const Settings& settings);
+  void Reset() { tracks_.clear(); }
+  // Forgets the history of one network, e.g. once a new model replaced it.
+  void Forget(const std::string& model_path) { tracks_.erase(model_path); }
+
+  // Returns true when |objects| should be published; the caller sends it.
+  bool Admit(const std::string& model_path, uint32_t output, const ClassResult* objects, size_t count,
+             uint64_t pts_ms);
+
+ private:
+  struct Candidate {
+    bool pending = false;
+    int id = -1;         // top-1 class different from the published one
+    uint64_t since = 0;  // pts it first showed up
+  };
+  struct Track {
+    bool valid = false;
+    uint64_t published_pts = 0;
+    std::vector<ClassResult> published;
+    std::vector<Candidate> candidates;  // per object
+  };
+
+  bool Changed(Track& track, const ClassResult* objects, size_t count, uint64_t pts_ms);
+
+  Settings settings_;
+  std::map<std::string, std::vector<Track>> tracks_;  // per network, per output
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "pl_video_frame_raw.h"
+
+class RawFramePool;
+
+/**
+ * @brief Move-only lease on a raw video frame viewed in place.
+ *        Holds the event blob and the frame object whose RawImage chain
+ *        points into it; Reset() or the destructor destroys the frame object,
+ *        which frees the chain, and then releases the blob, so the RawImage
+ *        chain is valid exactly as long as the lease.
+ */
+class RawFrame {
+ public:
+  RawFrame() = default;
+  RawFrame(RawFrame&& other) noexcept { *this = std::move(other); }
+  RawFrame& operator=(RawFrame&& other) noexcept;
+  RawFrame(const RawFrame&) = delete;
+  RawFrame& operator=(const RawFrame&) = delete;
+  ~RawFrame() { Reset(); }
+
+  RawImage* Image() const;
+  explicit operator bool() const { return slot_ != nullptr; }
+  void Reset();
+
+ private:
+  friend class RawFramePool;
+  struct Slot {
+    std::unique_ptr<IPLVideoFrameRaw> frame;
+    Blob blob;
+  };
+
+  RawFrame(RawFramePool* pool, Slot* slot) : pool_(pool), slot_(slot) {}
+
+  RawFramePool* pool_ = nullptr;
+  Slot* slot_ = nullptr;
+};
+
+/**
+ * @brief Hands out RawFrame leases and recycles their slots.
+ *        A slot is created only when every existing one is leased (bounded
+ *        by the frames in flight). The frame object itself is created per
+ *        frame, since the SDK frees a RawImage chain only with the object
+ *        that produced it. Must outlive every lease it hands out.
+ */
+class RawFramePool {
+ public:
+  RawFramePool() = default;
+  RawFramePool(const RawFramePool&) = delete;
+  RawFramePool& operator=(const RawFramePool&) = delete;
+
+  // Deserializes |blob| into a new frame object without copying the image
+  // planes. The lease takes over the blob; on failure the blob is released
+  // and an empty lease is returned.
+  RawFrame Acquire(Blob& blob);
+
+  size_t Capacity() const;
+  size_t InUse() const;
+
+ private:
+  friend class RawFrame;
+  void Release(RawFrame::Slot* slot);
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<RawFrame::Slot>> slots_;
+  std::vector<RawFrame::Slot*> free_;
+};
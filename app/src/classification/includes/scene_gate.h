@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensor.h"
+
+/**
+ * @brief Scene-change gate in front of preprocessing.
+ *        A frame is summarised as a kGrid x kGrid signature of mean luma
+ *        (kSamples x kSamples pixels read per cell, so a few thousand loads
+ *        whatever the stream size; G stands in for luma on RGB888 streams)
+ *        and compared with the signature of the last frame that was
+ *        inferred. When the mean absolute difference stays under the
+ *        threshold, the frame can reuse the previous result; a frame is
+ *        still inferred once the refresh interval has passed.
+ */
+class SceneGate {
+ public:
+  static constexpr uint32_t kGrid = 16;
+  static constexpr uint32_t kSamples = 4;
+
+  struct Settings {
+    bool enabled = false;
+    float threshold = 2.0f;     // mean absolute luma difference, 0..255
+    uint64_t refresh_ms = 1000; // longest run of reused results (pts), 0 for none
+  };
+
+  // Also forgets the reference frame.
+  void Configure(const Settings& settings);
+  bool Enabled() const { return settings_.enabled; }
+  // The next frame is inferred.
+  void Reset() { has_reference_ = false; }
+
+  // True when |image| is close enough to the last inferred frame to reuse
+  // its result; otherwise |image| becomes the reference and false is
+  // returned. Always false while disabled.
+  bool Unchanged(const RawImage& image);
+
+  // Difference of the last frame looked at, for logging.
+  float LastDifference() const { return last_difference_; }
+
+ private:
+  bool Signature(const RawImage& image, uint8_t* signature) const;
+
+  Settings settings_;
+  bool has_reference_ = false;
+  uint32_t reference_width_ = 0;
+  uint32_t reference_height_ = 0;
+  uint64_t reference_pts_ = 0;
+  uint8_t reference_[kGrid * kGrid] = {};
+  uint8_t current_[kGrid * kGrid] = {};
+  float last_difference_ = 0.0f;
+};
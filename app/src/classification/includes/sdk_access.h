@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "tensor.h"
+
+// Element type of a network tensor, as this component reads it.
+enum class ElementType : uint8_t {
+  eFloat32 = 0,
+  eUint8,
+  eInt8
+};
+
+// Pixel layout of a RawImage; eUnknown when the SDK does not say.
+enum class PixelLayout : uint8_t {
+  eUnknown = 0,
+  eNV12,
+  eRGB888
+};
+
+/**
+ * @brief Everything this component reads from the SDK beyond what the
+ *        original sample uses (RawImage width/height/pts/next; Tensor
+ *        Create/Allocate/Resize/Length(0..1)/VirtAddr/Name) goes through
+ *        here: the plane pointer, stride and format of a RawImage, and the
+ *        element type and dimensions of a Tensor.
+ *        They are only read where SDK_EXTENDED_API is defined, which the
+ *        host stand-in (app/host) does. Elsewhere the accessors answer what
+ *        the sample assumed (float32 outputs, no batch dimension, no CPU
+ *        access to the pixels) and the features built on them are refused
+ *        (fused preprocessing, crops, cascades, the scene gate), so a
+ *        firmware build stays on the sample's calls until these members
+ *        are checked against the vendor headers.
+ */
+namespace SdkAccess {
+
+#if defined(SDK_EXTENDED_API)
+constexpr bool kExtended = true;
+
+inline const uint8_t* Pixels(const RawImage& image) { return static_cast<const uint8_t*>(image.virt_addr); }
+// Bytes per row of the first plane, 0 when packed.
+inline uint32_t Stride(const RawImage& image) { return image.stride; }
+inline PixelLayout Layout(const RawImage& image)
+{
+  switch (image.format) {
+    case ePixelFormatNV12: return PixelLayout::eNV12;
+    case ePixelFormatRGB888: return PixelLayout::eRGB888;
+    default: return PixelLayout::eUnknown;
+  }
+}
+
+inline ElementType Type(const Tensor& tensor)
+{
+  switch (tensor.DataType()) {
+    case eTensorUint8: return ElementType::eUint8;
+    case eTensorInt8: return ElementType::eInt8;
+    default: return ElementType::eFloat32;
+  }
+}
+inline size_t Rank(const Tensor& tensor) { return tensor.Dims(); }
+#else
+constexpr bool kExtended = false;
+
+inline const uint8_t* Pixels(const RawImage&) { return nullptr; }
+inline uint32_t Stride(const RawImage&) { return 0; }
+inline PixelLayout Layout(const RawImage&) { return PixelLayout::eUnknown; }
+
+inline ElementType Type(const Tensor&) { return ElementType::eFloat32; }
+// width and height, the two axes the sample reads
+inline size_t Rank(const Tensor&) { return 2; }
+#endif
+
+inline uint32_t Length(const Tensor& tensor, size_t axis) { return axis < Rank(tensor) ? tensor.Length(axis) : 1; }
+// Images per run: the fourth dimension of an input tensor, 1 without one.
+inline uint32_t Batch(const Tensor& tensor) { return std::max<uint32_t>(1, Length(tensor, 3)); }
+inline size_t ElementSize(ElementType type) { return type == ElementType::eFloat32 ? sizeof(float) : 1; }
+
+// Same element type and dimensions.
+inline bool SameShape(const Tensor& a, const Tensor& b)
+{
+  if (Type(a) != Type(b) || Rank(a) != Rank(b)) { return false; }
+  for (size_t axis = 0; axis < Rank(a); axis++) {
+    if (a.Length(axis) != b.Length(axis)) { return false; }
+  }
+  return true;
+}
+
+// Element type and dimensions as text, e.g. "0x224x224x3".
+inline std::string ShapeKey(const Tensor& tensor)
+{
+  std::string key = std::to_string(static_cast<int>(Type(tensor)));
+  for (size_t axis = 0; axis < Rank(tensor); axis++) { key += 'x' + std::to_string(tensor.Length(axis)); }
+  return key;
+}
+
+}  // namespace SdkAccess
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "sdk_access.h"
+
+/**
+ * @brief Source (RGB) tensors recycled between frames, keyed by the
+ *        width/height/format of the RawImage they are filled from.
+ *        A tensor is handed out again once every shared_ptr returned for it
+ *        has been dropped, so Tensor::Allocate() overwrites a buffer that
+ *        already has the right geometry instead of allocating a new one.
+ *        Tensors of a previous geometry are freed on the first miss.
+ */
+class SourceTensorPool {
+ public:
+  // Fills a pooled tensor from |image|; nullptr if the conversion fails.
+  std::shared_ptr<Tensor> Acquire(const RawImage& image);
+  // Drops every tensor not currently in use.
+  void Clear();
+  size_t Size() const;
+
+ private:
+  struct Entry {
+    uint32_t width;
+    uint32_t height;
+    PixelLayout layout;
+    std::shared_ptr<Tensor> tensor;
+  };
+
+  mutable std::mutex mutex_;
+  std::vector<Entry> entries_;
+};
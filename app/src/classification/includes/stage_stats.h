@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "dispatcher_serialize.h"
+
+using StageClock = std::chrono::steady_clock;
+
+/**
+ * @brief Lock-free latency histogram in microseconds.
+ *        Log-linear buckets (16 per power of two) keep percentiles within
+ *        ~6% of the true value; recording is a handful of relaxed atomics so
+ *        it can run on the frame path while /configuration reads it.
+ */
+class LatencyHistogram {
+ public:
+  struct Summary {
+    uint64_t count;
+    uint64_t p50;
+    uint64_t p95;
+    uint64_t p99;
+    uint64_t max;
+    uint64_t mean;
+  };
+
+  LatencyHistogram() { Reset(); }
+
+  void Record(uint64_t usec);
+  Summary Summarize() const;
+  void Reset();
+
+ private:
+  static constexpr int kSubBucketBits = 4;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kBuckets = kSubBuckets * (64 - kSubBucketBits + 1);
+
+  static int BucketIndex(uint64_t usec);
+  static uint64_t BucketValue(int index);
+
+  std::atomic<uint64_t> buckets_[kBuckets];
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> max_;
+};
+
+/**
+ * @brief Per-stage latency of the frame inference path, plus frame admission
+ *        counters (received / dropped by policy / inferred).
+ */
+class StageStats {
+ public:
+  enum class Counter : int {
+    eReceived = 0,  // eVideoRawData events with a network loaded
+    eDropped,       // released by the frame policy without being deserialized
+    eInferred,      // frames that went through every network
+    eSuppressed,    // metadata messages held back by the publish policy
+    eReused,        // frames answered with the previous result (scene unchanged)
+    eCount
+  };
+
+  enum class Stage : int {
+    eFrameInterval = 0,  // arrival to arrival of eVideoRawData
+    eDeserialize,        // blob -> RawImage
+    eAllocate,           // stream selection + source tensor allocation
+    eResize,             // PreProcess
+    eExecute,            // RunNetwork wall time
+    eNpuPre,             // stat_t.pre_time
+    eNpuRun,             // stat_t.run_time
+    eNpuPost,            // stat_t.post_time
+    eParse,              // top-k parse
+    eBuildXml,           // metadata document
+    eSend,               // hand-off to MetadataManager
+    eFrameTotal,         // arrival to end of ProcessRawVideo
+    eCount
+  };
+
+  static const char* StageName(Stage stage);
+  static const char* CounterName(Counter counter);
+
+  void Record(Stage stage, uint64_t usec) { histograms_[static_cast<int>(stage)].Record(usec); }
+  // Records the time elapsed since |start| and returns the current time, so
+  // consecutive stages can be chained.
+  StageClock::time_point Record(Stage stage, StageClock::time_point start);
+  // Marks a frame arrival and records the interval to the previous one.
+  void FrameArrived(StageClock::time_point arrival);
+  void Count(Counter counter) { counters_[static_cast<int>(counter)].fetch_add(1, std::memory_order_relaxed); }
+  uint64_t Get(Counter counter) const { return counters_[static_cast<int>(counter)].load(std::memory_order_relaxed); }
+
+  void Reset();
+  std::string ToJson() const;
+
+ private:
+  LatencyHistogram histograms_[static_cast<int>(Stage::eCount)];
+  std::atomic<uint64_t> counters_[static_cast<int>(Counter::eCount)] = {};
+  std::atomic<int64_t> last_arrival_ns_{0};
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+#include "sdk_access.h"
+
+/**
+ * @brief Picks the source image out of a multi-resolution RawImage chain.
+ *        The default is the smallest stream that is at least the required
+ *        size (the network input), falling back to the largest usable one.
+ *        The choice is cached by chain position and only re-evaluated when
+ *        the main stream or the cached stream changes geometry, or when the
+ *        requirement changes.
+ */
+class StreamSelector {
+ public:
+  struct Requirement {
+    uint32_t min_width = 0;
+    uint32_t min_height = 0;
+    int stream_index = -1;  // pin a chain position; -1 selects by size
+  };
+
+  void SetRequirement(const Requirement& requirement);
+  const Requirement& GetRequirement() const { return requirement_; }
+  void Invalidate() { cached_index_ = -1; }
+
+  // Returns nullptr when the chain has no usable image.
+  const RawImage* Select(const RawImage* head);
+
+  // Largest image the source tensor is built from.
+  static constexpr uint32_t kMaxSize = 4096;
+
+ private:
+  struct Geometry {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    PixelLayout layout = PixelLayout::eUnknown;
+
+    bool Matches(const RawImage& image) const {
+      return image.width == width && image.height == height && SdkAccess::Layout(image) == layout;
+    }
+  };
+
+  static bool Usable(const RawImage& image);
+  int Choose(const RawImage* head) const;
+
+  Requirement requirement_;
+  int cached_index_ = -1;
+  Geometry cached_head_;
+  Geometry cached_stream_;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "class_result.h"
+
+/**
+ * @brief Temporal smoothing of classification results across frames, per
+ *        model output and object (the crop, or the whole frame), so the
+ *        top-1 class does not flicker between neighbouring labels.
+ *        Only the top-K of each frame is known, so the average runs over a
+ *        running candidate set: a class missing from a frame counts as 0.
+ *          eEma    : score = (1 - alpha) * score + alpha * x, divided by
+ *                    1 - (1 - alpha)^n after n frames so the first ones are
+ *                    not biased towards 0; at most kMaxCandidates classes
+ *                    kept, the weakest dropped, and those decayed to ~0
+ *          eWindow : mean over the last |window| frames
+ *        Both cost O(K) per frame for a fixed window. Meant for
+ *        probabilities (softmax/sigmoid outputs); raw logits do not average
+ *        meaningfully against the implicit 0. Non-finite scores are
+ *        ignored. Called from one thread at a time (the one that publishes).
+ */
+class TemporalSmoother {
+ public:
+  enum class Type {
+    eNone = 0,
+    eEma,
+    eWindow
+  };
+
+  static constexpr uint32_t kMaxWindow = 32;
+  static constexpr uint32_t kMaxCandidates = 2 * ClassResult::kMaxTopK;
+
+  struct Settings {
+    Type type = Type::eNone;
+    float alpha = 0.3f;    // eEma: weight of the newest frame, (0, 1]
+    uint32_t window = 5;   // eWindow: frames averaged, [1, kMaxWindow]
+  };
+
+  // "" and "none" map to eNone.
+  static bool FromString(const std::string& name, Type& type);
+
+  // Also forgets the history.
+  void Configure(const Settings& settings);
+  void Reset() { tracks_.clear(); }
+  // Forgets the history of one network, e.g. once a new model replaced it.
+  void Forget(const std::string& model_path) { tracks_.erase(model_path); }
+
+  // Folds |objects| into the history and returns the smoothed results (the
+  // same boxes, each with as many classes as it came with). The returned
+  // array stays valid until the next call; with eNone it is |objects|.
+  const ClassResult* Smooth(const std::string& model_path, uint32_t output, const ClassResult* objects,
+                            size_t count);
+
+ private:
+  struct Candidate {
+    int id;
+    float sum;       // eEma: the average itself
+    uint32_t seen;   // eWindow: frames in the window that carry the class
+  };
+  struct Object {
+    std::vector<Candidate> candidates;
+    std::vector<ClassResult> frames;  // eWindow ring
+    float weight = 0.0f;  // eEma: 1 - (1 - alpha)^frames, the bias correction
+    uint32_t next = 0;
+    uint32_t filled = 0;
+  };
+  struct Track {
+    std::vector<Object> objects;
+    std::vector<ClassResult> smoothed;
+  };
+
+  void Update(Object& object, const ClassResult& frame);
+  static Candidate& Find(std::vector<Candidate>& candidates, int id);
+
+  Settings settings_;
+  std::map<std::string, std::vector<Track>> tracks_;  // per network, per output
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Partial selection of the K largest scores of a network output.
+ *        A min-heap of the current K best sets a threshold, and blocks of
+ *        16 scores are tested against it with NEON (aarch64) or SSE2 (x86)
+ *        before any of them is looked at one by one, so once the heap has
+ *        settled almost the whole output is a vector max and a compare.
+ *        Works on any width and on signed scores (logits); NaN never wins.
+ *        Uint8/int8 outputs of quantised networks are ranked as they are,
+ *        16 per vector compare.
+ */
+class TopK {
+ public:
+  struct Entry {
+    int id;
+    float value;
+  };
+
+  // Writes the min(|k|, |width|) best entries of |data| to |out| in
+  // descending order, earlier index first on ties, and returns how many.
+  // |out| must hold |k| entries; it is also the working heap.
+  static size_t Select(const float* data, size_t width, size_t k, Entry* out);
+  // Quantised outputs: ranked on the raw integers (order is the same as
+  // after dequantisation for a positive scale); |out| values are the raw
+  // integers as floats.
+  static size_t Select(const uint8_t* data, size_t width, size_t k, Entry* out);
+  static size_t Select(const int8_t* data, size_t width, size_t k, Entry* out);
+};
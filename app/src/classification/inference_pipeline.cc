@@ -0,0 +1,111 @@
+#include "inference_pipeline.h"
+
+using namespace std;
+
+bool InferencePipeline::Start(size_t queue_depth, BatchFunc execute, StageFunc publish)
+{
+  if (running_) { return false; }
+
+  execute_ = move(execute);
+  publish_ = move(publish);
+  execute_queue_.Reopen(queue_depth);
+  publish_queue_.Reopen(queue_depth);
+  pending_ = 0;
+
+  running_ = true;
+  execute_thread_ = thread(&InferencePipeline::ExecuteLoop, this);
+  publish_thread_ = thread(&InferencePipeline::PublishLoop, this);
+  return true;
+}
+
+void InferencePipeline::SetBatching(size_t max_batch, StageClock::duration max_wait)
+{
+  if (running_) { return; }
+
+  max_batch_ = max_batch ? max_batch : 1;
+  max_wait_ = max_wait;
+}
+
+void InferencePipeline::Stop()
+{
+  if (!running_) { return; }
+
+  Drain();
+  execute_queue_.Close();
+  publish_queue_.Close();
+  if (execute_thread_.joinable()) { execute_thread_.join(); }
+  if (publish_thread_.joinable()) { publish_thread_.join(); }
+  running_ = false;
+}
+
+bool InferencePipeline::CanSubmit() const
+{
+  return running_ && execute_queue_.Size() < execute_queue_.Capacity();
+}
+
+bool InferencePipeline::Submit(unique_ptr<FrameJob> job)
+{
+  if (!running_ || !job) { return false; }
+
+  {
+    lock_guard<mutex> lock(pending_mutex_);
+    pending_++;
+  }
+  if (!execute_queue_.Push(move(job))) {
+    JobDone();
+    return false;
+  }
+  return true;
+}
+
+void InferencePipeline::Drain()
+{
+  unique_lock<mutex> lock(pending_mutex_);
+  pending_cv_.wait(lock, [this] { return pending_ == 0; });
+}
+
+void InferencePipeline::JobDone()
+{
+  lock_guard<mutex> lock(pending_mutex_);
+  pending_--;
+  pending_cv_.notify_all();
+}
+
+void InferencePipeline::ExecuteLoop()
+{
+  vector<unique_ptr<FrameJob>> batch;
+  vector<FrameJob*> jobs;
+  unique_ptr<FrameJob> job;
+  while (execute_queue_.Pop(job)) {
+    batch.push_back(move(job));
+    const auto deadline = StageClock::now() + max_wait_;
+    while (batch.size() < max_batch_ && execute_queue_.PopUntil(job, deadline)) {
+      batch.push_back(move(job));
+    }
+
+    jobs.clear();
+    for (auto& item : batch) { jobs.push_back(item.get()); }
+    execute_(jobs);
+
+    for (auto& item : batch) {
+      // the source tensor and its raw frame are not needed past the NPU stage
+      item->rgb.reset();
+      item->source.Reset();
+      item->image = nullptr;
+      if (!publish_queue_.Push(move(item))) {
+        JobDone();
+      }
+    }
+    batch.clear();
+  }
+}
+
+void InferencePipeline::PublishLoop()
+{
+  unique_ptr<FrameJob> job;
+  while (publish_queue_.Pop(job)) {
+    publish_(*job);
+    job.reset();
+    JobDone();
+  }
+}
@@ -0,0 +1,259 @@
+#include "metadata_writer.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+using namespace std;
+
+namespace {
+
+constexpr char kHeader[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+    "<tt:MetadataStream xmlns:tt=\"http://www.onvif.org/ver10/schema\" xmlns:ttr=\"https://www.onvif.org/ver20/analytics/radiometry\" xmlns:wsnt=\"http://docs.oasis-open.org/wsn/b-2\" xmlns:tns1=\"http://www.onvif.org/ver10/topics\" xmlns:tnssamsung=\"http://www.samsungcctv.com/2011/event/topics\" xmlns:fc=\"http://www.onvif.org/ver20/analytics/humanface\" xmlns:bd=\"http://www.onvif.org/ver20/analytics/humanbody\"><tt:VideoAnalytics>"
+    "<tt:Frame UtcTime=\"";
+constexpr char kFooter[] = "</tt:Frame></tt:VideoAnalytics></tt:MetadataStream>";
+
+constexpr char kBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// room for a document of a few objects before the first growth
+constexpr size_t kInitialCapacity = 4096;
+
+}  // namespace
+
+MetadataWriter::MetadataWriter()
+{
+  buffer_.reserve(kInitialCapacity);
+  record_.reserve(kInitialCapacity);
+}
+
+bool MetadataWriter::FromString(const string& name, Format& format)
+{
+  if (name.empty() || name == "xml") {
+    format = Format::eXml;
+  } else if (name == "json") {
+    format = Format::eJson;
+  } else if (name == "binary") {
+    format = Format::eBinary;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+uint32_t MetadataWriter::ModelId(const string& model_name)
+{
+  uint32_t hash = 2166136261u;
+  for (unsigned char c : model_name) {
+    hash ^= c;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+void MetadataWriter::AppendInt(int64_t value)
+{
+  char digits[24];
+  auto result = to_chars(digits, digits + sizeof(digits), value);
+  Append(digits, result.ptr - digits);
+}
+
+void MetadataWriter::AppendFixed(float value)
+{
+  // a float times 1e6 is exact in a double, and nearbyint() rounds ties to
+  // even like printf("%f"), so this matches std::to_string(float)
+  const double scaled = fabs(static_cast<double>(value)) * 1e6;
+  if (!(scaled < 9e18)) {
+    char text[64];
+    int length = snprintf(text, sizeof(text), "%f", value);
+    Append(text, static_cast<size_t>(max(0, min(length, static_cast<int>(sizeof(text)) - 1))));
+    return;
+  }
+
+  const auto micros = static_cast<uint64_t>(nearbyint(scaled));
+  char text[32];
+  char* p = text;
+  if (signbit(value)) { *p++ = '-'; }
+  p = to_chars(p, text + sizeof(text), micros / 1000000).ptr;
+  *p++ = '.';
+  uint64_t fraction = micros % 1000000;
+  for (int i = 5; i >= 0; i--) {
+    p[i] = static_cast<char>('0' + fraction % 10);
+    fraction /= 10;
+  }
+  Append(text, (p + 6) - text);
+}
+
+void MetadataWriter::AppendTime(uint64_t timestamp_ms)
+{
+  const auto second = static_cast<int64_t>(timestamp_ms / 1000);
+  if (second != cached_second_) {
+    time_t sec = static_cast<time_t>(second);
+    struct tm conv_time = {};
+    gmtime_r(&sec, &conv_time);
+    second_prefix_length_ = strftime(second_prefix_, sizeof(second_prefix_), "%FT%T.", &conv_time);
+    cached_second_ = second;
+  }
+  Append(second_prefix_, second_prefix_length_);
+
+  const auto msec = static_cast<uint32_t>(timestamp_ms % 1000);
+  const char digits[4] = {static_cast<char>('0' + msec / 100), static_cast<char>('0' + msec / 10 % 10),
+                          static_cast<char>('0' + msec % 10), 'Z'};
+  Append(digits, sizeof(digits));
+}
+
+void MetadataWriter::AppendRecord(uint64_t value, size_t bytes)
+{
+  for (size_t i = 0; i < bytes; i++) {
+    record_.push_back(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+void MetadataWriter::AppendRecord(float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  AppendRecord(bits, sizeof(bits));
+}
+
+const string& MetadataWriter::Write(Format format, uint32_t model_id, int channel, const ClassResult* objects,
+                                    size_t count, uint64_t timestamp_ms)
+{
+  buffer_.clear();
+  switch (format) {
+    case Format::eJson:
+      WriteJson(model_id, channel, objects, count, timestamp_ms);
+      break;
+    case Format::eBinary:
+      WriteBinary(model_id, channel, objects, count, timestamp_ms);
+      break;
+    case Format::eXml:
+      WriteXml(objects, count, timestamp_ms);
+      break;
+  }
+  return buffer_;
+}
+
+void MetadataWriter::WriteXml(const ClassResult* objects, size_t count, uint64_t timestamp_ms)
+{
+  Append(kHeader);
+  AppendTime(timestamp_ms);
+  Append("\">");
+
+  for (size_t i = 0; i < count; i++) {
+    const auto& object = objects[i];
+    Append("<tt:Object ObjectId=\"");
+    AppendInt(static_cast<int64_t>(2 + i));
+    Append("\"><tt:Appearance>");
+    if (object.has_box) {
+      // ONVIF default frame coordinates: [-1, 1], y pointing up
+      const float left = object.box.x * 2.0f - 1.0f;
+      const float right = (object.box.x + object.box.width) * 2.0f - 1.0f;
+      const float top = 1.0f - object.box.y * 2.0f;
+      const float bottom = 1.0f - (object.box.y + object.box.height) * 2.0f;
+      Append("<tt:Shape><tt:BoundingBox left=\"");
+      AppendFixed(left);
+      Append("\" top=\"");
+      AppendFixed(top);
+      Append("\" right=\"");
+      AppendFixed(right);
+      Append("\" bottom=\"");
+      AppendFixed(bottom);
+      Append("\"/><tt:CenterOfGravity x=\"");
+      AppendFixed((left + right) / 2);
+      Append("\" y=\"");
+      AppendFixed((top + bottom) / 2);
+      Append("\"/></tt:Shape>");
+    }
+    Append("<tt:Class>");
+    for (uint32_t k = 0; k < object.count; k++) {
+      Append("<tt:Type Likelihood=\"");
+      AppendFixed(object.top[k].value);
+      Append("\">");
+      AppendInt(object.top[k].id);
+      Append("</tt:Type>");
+    }
+    Append("</tt:Class></tt:Appearance></tt:Object>");
+  }
+  Append(kFooter);
+}
+
+void MetadataWriter::WriteJson(uint32_t model_id, int channel, const ClassResult* objects, size_t count,
+                               uint64_t timestamp_ms)
+{
+  Append("{\"t\":");
+  AppendInt(static_cast<int64_t>(timestamp_ms));
+  Append(",\"ch\":");
+  AppendInt(channel);
+  Append(",\"model\":");
+  AppendInt(model_id);
+  Append(",\"objects\":[");
+  for (size_t i = 0; i < count; i++) {
+    const auto& object = objects[i];
+    if (i > 0) { Append(","); }
+    Append("{");
+    if (object.has_box) {
+      Append("\"box\":[");
+      AppendFixed(object.box.x);
+      Append(",");
+      AppendFixed(object.box.y);
+      Append(",");
+      AppendFixed(object.box.width);
+      Append(",");
+      AppendFixed(object.box.height);
+      Append("],");
+    }
+    Append("\"classes\":[");
+    for (uint32_t k = 0; k < object.count; k++) {
+      if (k > 0) { Append(","); }
+      Append("[");
+      AppendInt(object.top[k].id);
+      Append(",");
+      AppendFixed(object.top[k].value);
+      Append("]");
+    }
+    Append("]}");
+  }
+  Append("]}");
+}
+
+void MetadataWriter::WriteBinary(uint32_t model_id, int channel, const ClassResult* objects, size_t count,
+                                 uint64_t timestamp_ms)
+{
+  record_.clear();
+  AppendRecord(kBinaryVersion, 1);
+  AppendRecord(static_cast<uint8_t>(channel), 1);
+  AppendRecord(min<size_t>(count, UINT16_MAX), 2);
+  AppendRecord(model_id, 4);
+  AppendRecord(timestamp_ms, 8);
+  for (size_t i = 0; i < min<size_t>(count, UINT16_MAX); i++) {
+    const auto& object = objects[i];
+    AppendRecord(object.count, 1);
+    AppendRecord(object.has_box ? 1 : 0, 1);
+    AppendRecord(0, 2);
+    if (object.has_box) {
+      AppendRecord(object.box.x);
+      AppendRecord(object.box.y);
+      AppendRecord(object.box.width);
+      AppendRecord(object.box.height);
+    }
+    for (uint32_t k = 0; k < object.count; k++) {
+      AppendRecord(static_cast<uint32_t>(object.top[k].id), 4);
+      AppendRecord(object.top[k].value);
+    }
+  }
+
+  // StringMetadata is a text payload
+  const auto* data = reinterpret_cast<const uint8_t*>(record_.data());
+  const size_t size = record_.size();
+  for (size_t i = 0; i < size; i += 3) {
+    const uint32_t chunk = (uint32_t(data[i]) << 16) | (i + 1 < size ? uint32_t(data[i + 1]) << 8 : 0) |
+                           (i + 2 < size ? uint32_t(data[i + 2]) : 0);
+    const char text[4] = {kBase64[chunk >> 18], kBase64[(chunk >> 12) & 63],
+                          i + 1 < size ? kBase64[(chunk >> 6) & 63] : '=', i + 2 < size ? kBase64[chunk & 63] : '='};
+    Append(text, sizeof(text));
+  }
+}
@@ -0,0 +1,94 @@
+#include "model_cache.h"
+
+#include <sys/stat.h>
+
+#include <sstream>
+
+#include "sdk_access.h"
+
+using namespace std;
+
+ModelCache& ModelCache::Instance()
+{
+  static ModelCache cache;
+  return cache;
+}
+
+string ModelCache::Key(const string& model_path, const NeuralNetwork& network, const vector<float>& mean,
+                       const vector<float>& scale)
+{
+  // a model file replaced in place is a different model
+  ostringstream key;
+  key << model_path;
+  struct stat st;
+  if (::stat(model_path.c_str(), &st) == 0) {
+    key << '|' << st.st_size << '|' << st.st_mtim.tv_sec << '.' << st.st_mtim.tv_nsec;
+  }
+  for (auto& tensor : network.GetAllInputTensors()) {
+    key << "|i:" << tensor->Name() << ':' << SdkAccess::ShapeKey(*tensor);
+  }
+  for (auto& tensor : network.GetAllOutputTensors()) { key << "|o:" << tensor->Name(); }
+  key << '|';
+  for (auto value : mean) { key << value << ','; }
+  key << '|';
+  for (auto value : scale) { key << value << ','; }
+  return key.str();
+}
+
+shared_ptr<NeuralNetwork> ModelCache::Acquire(const string& key, const function<shared_ptr<NeuralNetwork>()>& load)
+{
+  promise<shared_ptr<Entry>> loaded;
+  shared_future<shared_ptr<Entry>> ready;
+  bool loader = false;
+  {
+    lock_guard<mutex> lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      it = (!it->second.loading.valid() && it->second.entry.expired()) ? entries_.erase(it) : next(it);
+    }
+
+    auto& slot = entries_[key];
+    if (auto entry = slot.entry.lock()) { return MakeLease(move(entry)); }
+    if (!slot.loading.valid()) {
+      slot.loading = loaded.get_future().share();
+      loader = true;
+    }
+    ready = slot.loading;
+  }
+
+  if (loader) {
+    // loaded outside the lock, so other models are acquired and released
+    // meanwhile; the channels asking for this one wait on |ready|
+    shared_ptr<Entry> entry;
+    if (auto network = load()) {
+      entry = make_shared<Entry>();
+      entry->network = move(network);
+    }
+    {
+      lock_guard<mutex> lock(mutex_);
+      auto& slot = entries_[key];
+      slot.loading = shared_future<shared_ptr<Entry>>();
+      slot.entry = entry;
+    }
+    loaded.set_value(entry);
+  }
+
+  auto entry = ready.get();
+  if (!entry) {
+    // a channel that waited on a failed load tries with its own network
+    return loader ? nullptr : Acquire(key, load);
+  }
+  return MakeLease(move(entry));
+}
+
+shared_ptr<NeuralNetwork> ModelCache::MakeLease(shared_ptr<Entry> entry)
+{
+  auto* network = entry->network.get();
+  return shared_ptr<NeuralNetwork>(network, Lease{move(entry)});
+}
+
+unique_lock<mutex> ModelCache::Lock(const shared_ptr<NeuralNetwork>& network)
+{
+  auto* lease = get_deleter<Lease>(network);
+  if (!lease || !lease->entry) { return unique_lock<mutex>(); }
+  return unique_lock<mutex>(lease->entry->run_mutex);
+}
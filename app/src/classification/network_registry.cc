@@ -0,0 +1,96 @@
+#include "network_registry.h"
+
+using namespace std;
+
+namespace {
+
+void Release(NeuralNetwork* network)
+{
+  network->UnloadNetwork();
+  delete network;
+}
+
+}  // namespace
+
+shared_ptr<NeuralNetwork> NetworkRegistry::Create()
+{
+  auto* network = NeuralNetwork::Create();
+  if (!network) { return nullptr; }
+  return shared_ptr<NeuralNetwork>(network, Release);
+}
+
+NeuralNetwork* NetworkRegistry::Find(const string& name) const
+{
+  lock_guard<mutex> lock(write_mutex_);
+  auto it = networks_.find(name);
+  return it != networks_.end() ? it->second.get() : nullptr;
+}
+
+NeuralNetwork* NetworkRegistry::GetOrCreate(const string& name)
+{
+  lock_guard<mutex> lock(write_mutex_);
+  auto it = networks_.find(name);
+  if (it != networks_.end()) { return it->second.get(); }
+
+  auto network = Create();
+  if (!network) { return nullptr; }
+  networks_[name] = network;
+  return network.get();
+}
+
+shared_ptr<NeuralNetwork> NetworkRegistry::Get(const string& name) const
+{
+  lock_guard<mutex> lock(write_mutex_);
+  auto it = networks_.find(name);
+  return it != networks_.end() ? it->second : nullptr;
+}
+
+bool NetworkRegistry::Activate(const string& name)
+{
+  lock_guard<mutex> lock(write_mutex_);
+  auto it = networks_.find(name);
+  if (it == networks_.end()) { return false; }
+
+  auto current = Load();
+  if (current->count(name) > 0) { return true; }
+  auto next = make_shared<Map>(*current);
+  next->emplace(name, it->second);
+  Publish(move(next));
+  return true;
+}
+
+bool NetworkRegistry::Replace(const string& name, shared_ptr<NeuralNetwork> network)
+{
+  lock_guard<mutex> lock(write_mutex_);
+  auto it = networks_.find(name);
+  if (!network || it == networks_.end()) { return false; }
+
+  auto current = Load();
+  it->second = network;
+  if (current->count(name) > 0) {
+    auto next = make_shared<Map>(*current);
+    (*next)[name] = move(network);
+    Publish(move(next));
+  }
+  return true;
+}
+
+void NetworkRegistry::Remove(const string& name)
+{
+  lock_guard<mutex> lock(write_mutex_);
+  networks_.erase(name);
+
+  auto current = Load();
+  if (current->count(name) > 0) {
+    auto next = make_shared<Map>(*current);
+    next->erase(name);
+    Publish(move(next));
+  }
+  // |current| may hold the last reference: the network is released here,
+  // or by the frame still using it
+}
+
+void NetworkRegistry::Publish(shared_ptr<Map> next)
+{
+  atomic_store(&snapshot_, Snapshot(move(next)));
+}
@@ -0,0 +1,65 @@
+#include "network_workers.h"
+
+using namespace std;
+
+void NetworkWorkers::Resize(size_t threads)
+{
+  if (threads == threads_.size()) { return; }
+
+  {
+    lock_guard<mutex> lock(mutex_);
+    closed_ = true;
+  }
+  wake_cv_.notify_all();
+  for (auto& thread : threads_) { thread.join(); }
+  threads_.clear();
+
+  closed_ = false;
+  for (size_t i = 0; i < threads; i++) { threads_.emplace_back(&NetworkWorkers::WorkerLoop, this); }
+}
+
+void NetworkWorkers::Run(size_t count, const Task& task)
+{
+  if (count == 0) { return; }
+  if (threads_.empty() || count == 1) {
+    for (size_t i = 0; i < count; i++) { task(i); }
+    return;
+  }
+
+  lock_guard<mutex> run_lock(run_mutex_);
+  unique_lock<mutex> lock(mutex_);
+  task_ = &task;
+  count_ = count;
+  next_ = 0;
+  finished_ = 0;
+  wake_cv_.notify_all();
+
+  // the caller takes its share instead of waiting idle
+  RunTasks(lock);
+  done_cv_.wait(lock, [this] { return finished_ == count_; });
+  task_ = nullptr;
+}
+
+void NetworkWorkers::RunTasks(unique_lock<mutex>& lock)
+{
+  while (task_ && next_ < count_) {
+    const Task& task = *task_;
+    const size_t index = next_++;
+
+    lock.unlock();
+    task(index);
+    lock.lock();
+
+    if (++finished_ == count_) { done_cv_.notify_all(); }
+  }
+}
+
+void NetworkWorkers::WorkerLoop()
+{
+  unique_lock<mutex> lock(mutex_);
+  while (true) {
+    wake_cv_.wait(lock, [this] { return closed_ || (task_ && next_ < count_); });
+    if (closed_) { break; }
+    RunTasks(lock);
+  }
+}
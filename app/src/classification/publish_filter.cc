@@ -0,0 +1,75 @@
+#include "publish_filter.h"
+
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+int TopId(const ClassResult& result)
+{
+  return result.count > 0 ? result.top[0].id : -1;
+}
+
+}  // namespace
+
+void PublishFilter::Configure(const Settings& settings)
+{
+  settings_ = settings;
+  Reset();
+}
+
+bool PublishFilter::Admit(const string& model_path, uint32_t output, const ClassResult* objects, size_t count,
+                          uint64_t pts_ms)
+{
+  if (!settings_.enabled) { return true; }
+
+  auto it = tracks_.find(model_path);
+  if (it == tracks_.end()) { it = tracks_.emplace(model_path, vector<Track>()).first; }
+  auto& outputs = it->second;
+  if (outputs.size() <= output) { outputs.resize(output + 1); }
+  auto& track = outputs[output];
+
+  if (!Changed(track, objects, count, pts_ms)) { return false; }
+
+  track.valid = true;
+  track.published_pts = pts_ms;
+  track.published.assign(objects, objects + count);
+  track.candidates.assign(count, Candidate());
+  return true;
+}
+
+bool PublishFilter::Changed(Track& track, const ClassResult* objects, size_t count, uint64_t pts_ms)
+{
+  if (!track.valid || track.published.size() != count || pts_ms < track.published_pts) { return true; }
+  if (settings_.keep_alive_ms > 0 && pts_ms - track.published_pts >= settings_.keep_alive_ms) { return true; }
+
+  bool changed = false;
+  for (size_t i = 0; i < count; i++) {
+    const auto& published = track.published[i];
+    const auto& current = objects[i];
+    auto& candidate = track.candidates[i];
+
+    const int id = TopId(current);
+    if (id != TopId(published)) {
+      // hysteresis: the new top-1 has to hold for the debounce window
+      if (!candidate.pending || candidate.id != id) {
+        candidate.pending = true;
+        candidate.id = id;
+        candidate.since = pts_ms;
+      }
+      changed |= pts_ms - candidate.since >= settings_.debounce_ms;
+      continue;
+    }
+    candidate.pending = false;
+
+    for (uint32_t k = 0; k < published.count && !changed; k++) {
+      for (uint32_t j = 0; j < current.count; j++) {
+        if (current.top[j].id != published.top[k].id) { continue; }
+        changed = fabs(current.top[j].value - published.top[k].value) > settings_.score_delta;
+        break;
+      }
+    }
+  }
+  return changed;
+}
@@ -0,0 +1,82 @@
+#include "raw_frame_pool.h"
+
+using namespace std;
+
+RawFrame& RawFrame::operator=(RawFrame&& other) noexcept
+{
+  if (this != &other) {
+    Reset();
+    pool_ = other.pool_;
+    slot_ = other.slot_;
+    other.pool_ = nullptr;
+    other.slot_ = nullptr;
+  }
+  return *this;
+}
+
+RawImage* RawFrame::Image() const
+{
+  return slot_ ? slot_->frame->GetRawImage() : nullptr;
+}
+
+void RawFrame::Reset()
+{
+  if (!slot_) { return; }
+  pool_->Release(slot_);
+  pool_ = nullptr;
+  slot_ = nullptr;
+}
+
+RawFrame RawFramePool::Acquire(Blob& blob)
+{
+  RawFrame::Slot* slot = nullptr;
+  {
+    lock_guard<mutex> lock(mutex_);
+    if (free_.empty()) {
+      auto created = make_unique<RawFrame::Slot>();
+      slot = created.get();
+      slots_.push_back(move(created));
+      free_.reserve(slots_.size());
+    } else {
+      slot = free_.back();
+      free_.pop_back();
+    }
+  }
+
+  // one frame object per lease: it owns the RawImage chain it deserializes
+  // and frees it when destroyed, so the chain goes with the lease
+  slot->frame.reset(new ("GetImage") IPLVideoFrameRaw());
+  std::pair<std::variant<BaseObject*, char*>, uint64_t> ret((char*)blob.GetRawData(), blob.GetSize());
+  if (!slot->frame->DeserializeBaseObject(slot->frame.get(), ret) || !slot->frame->GetRawImage()) {
+    blob.ClearResource();
+    Release(slot);
+    return RawFrame();
+  }
+
+  slot->blob = blob;
+  blob.ClearResource();
+  return RawFrame(this, slot);
+}
+
+void RawFramePool::Release(RawFrame::Slot* slot)
+{
+  // free the RawImage chain, then hand the shared buffer it points into back
+  // to the stream provider
+  slot->frame.reset();
+  slot->blob.ClearResource();
+
+  lock_guard<mutex> lock(mutex_);
+  free_.push_back(slot);
+}
+
+size_t RawFramePool::Capacity() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return slots_.size();
+}
+
+size_t RawFramePool::InUse() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return slots_.size() - free_.size();
+}
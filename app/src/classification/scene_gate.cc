@@ -0,0 +1,83 @@
+#include "scene_gate.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "sdk_access.h"
+
+using namespace std;
+
+void SceneGate::Configure(const Settings& settings)
+{
+  settings_ = settings;
+  Reset();
+}
+
+bool SceneGate::Signature(const RawImage& image, uint8_t* signature) const
+{
+  const uint8_t* base = SdkAccess::Pixels(image);
+  if (base == nullptr || image.width < kGrid || image.height < kGrid) { return false; }
+
+  const PixelLayout layout = SdkAccess::Layout(image);
+  size_t stride = SdkAccess::Stride(image);
+  size_t step = 1;
+  size_t offset = 0;
+  if (layout == PixelLayout::eRGB888) {
+    if (stride == 0) { stride = static_cast<size_t>(image.width) * 3; }
+    step = 3;
+    offset = 1;
+  } else if (layout == PixelLayout::eNV12) {
+    if (stride == 0) { stride = image.width; }
+  } else {
+    return false;
+  }
+
+  // sample points sit at the centres of a kGrid * kSamples lattice
+  constexpr uint32_t kPoints = kGrid * kSamples;
+  uint32_t columns[kPoints];
+  for (uint32_t i = 0; i < kPoints; i++) {
+    columns[i] = static_cast<uint32_t>((2 * i + 1) * static_cast<uint64_t>(image.width) / (2 * kPoints));
+  }
+
+  for (uint32_t gy = 0; gy < kGrid; gy++) {
+    uint32_t sums[kGrid] = {};
+    for (uint32_t sy = 0; sy < kSamples; sy++) {
+      const uint32_t y = static_cast<uint32_t>((2 * (gy * kSamples + sy) + 1) * static_cast<uint64_t>(image.height) /
+                                               (2 * kPoints));
+      const uint8_t* row = base + y * stride + offset;
+      for (uint32_t i = 0; i < kPoints; i++) { sums[i / kSamples] += row[columns[i] * step]; }
+    }
+    for (uint32_t gx = 0; gx < kGrid; gx++) {
+      signature[gy * kGrid + gx] = static_cast<uint8_t>(sums[gx] / (kSamples * kSamples));
+    }
+  }
+  return true;
+}
+
+bool SceneGate::Unchanged(const RawImage& image)
+{
+  if (!settings_.enabled) { return false; }
+  if (!Signature(image, current_)) {
+    has_reference_ = false;
+    return false;
+  }
+
+  bool unchanged = has_reference_ && image.width == reference_width_ && image.height == reference_height_ &&
+                   image.pts >= reference_pts_ &&
+                   (settings_.refresh_ms == 0 || image.pts - reference_pts_ < settings_.refresh_ms);
+  if (unchanged) {
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < kGrid * kGrid; i++) { total += abs(current_[i] - reference_[i]); }
+    last_difference_ = static_cast<float>(total) / (kGrid * kGrid);
+    unchanged = last_difference_ < settings_.threshold;
+  }
+
+  if (!unchanged) {
+    memcpy(reference_, current_, sizeof(reference_));
+    reference_width_ = image.width;
+    reference_height_ = image.height;
+    reference_pts_ = image.pts;
+    has_reference_ = true;
+  }
+  return unchanged;
+}
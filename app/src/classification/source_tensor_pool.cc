@@ -0,0 +1,56 @@
+#include "source_tensor_pool.h"
+
+#include <algorithm>
+#include <atomic>
+
+using namespace std;
+
+shared_ptr<Tensor> SourceTensorPool::Acquire(const RawImage& image)
+{
+  shared_ptr<Tensor> tensor;
+  const PixelLayout layout = SdkAccess::Layout(image);
+  {
+    lock_guard<mutex> lock(mutex_);
+    for (auto& entry : entries_) {
+      if (entry.width == image.width && entry.height == image.height && entry.layout == layout &&
+          entry.tensor.use_count() == 1) {
+        // pairs with the release in the last user's shared_ptr destructor,
+        // so its reads of the old pixels happen before we overwrite them
+        atomic_thread_fence(memory_order_acquire);
+        tensor = entry.tensor;
+        break;
+      }
+    }
+
+    if (!tensor) {
+      // the stream geometry changed (or every tensor is in flight): free
+      // idle tensors of other geometries before adding one
+      entries_.erase(remove_if(entries_.begin(), entries_.end(),
+                               [&image, layout](const Entry& entry) {
+                                 return entry.tensor.use_count() == 1 &&
+                                        (entry.width != image.width || entry.height != image.height ||
+                                         entry.layout != layout);
+                               }),
+                     entries_.end());
+      tensor.reset(Tensor::Create());
+      entries_.push_back({image.width, image.height, layout, tensor});
+    }
+  }
+
+  if (tensor->Allocate(image) == false) { return nullptr; }
+  return tensor;
+}
+
+void SourceTensorPool::Clear()
+{
+  lock_guard<mutex> lock(mutex_);
+  entries_.erase(remove_if(entries_.begin(), entries_.end(),
+                           [](const Entry& entry) { return entry.tensor.use_count() == 1; }),
+                 entries_.end());
+}
+
+size_t SourceTensorPool::Size() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return entries_.size();
+}
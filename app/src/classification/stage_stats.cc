@@ -0,0 +1,159 @@
+#include "stage_stats.h"
+
+using namespace std;
+using namespace chrono;
+
+int LatencyHistogram::BucketIndex(uint64_t usec) {
+  if (usec < kSubBuckets) { return static_cast<int>(usec); }
+  int msb = 63 - __builtin_clzll(usec);
+  int shift = msb - kSubBucketBits;
+  return (shift + 1) * kSubBuckets + static_cast<int>((usec >> shift) & (kSubBuckets - 1));
+}
+
+uint64_t LatencyHistogram::BucketValue(int index) {
+  if (index < kSubBuckets) { return static_cast<uint64_t>(index); }
+  int shift = index / kSubBuckets - 1;
+  uint64_t low = (static_cast<uint64_t>(kSubBuckets + index % kSubBuckets)) << shift;
+  // middle of the bucket
+  return low + ((1ull << shift) >> 1);
+}
+
+void LatencyHistogram::Record(uint64_t usec) {
+  buckets_[BucketIndex(usec)].fetch_add(1, memory_order_relaxed);
+  count_.fetch_add(1, memory_order_relaxed);
+  sum_.fetch_add(usec, memory_order_relaxed);
+
+  uint64_t prev = max_.load(memory_order_relaxed);
+  while (usec > prev && !max_.compare_exchange_weak(prev, usec, memory_order_relaxed)) {
+  }
+}
+
+LatencyHistogram::Summary LatencyHistogram::Summarize() const {
+  Summary summary = {0, 0, 0, 0, 0, 0};
+
+  // the buckets are summed rather than trusting count_, so a reader racing
+  // with Record() still sees a self-consistent distribution
+  uint64_t snapshot[kBuckets];
+  uint64_t total = 0;
+  for (int i = 0; i < kBuckets; i++) {
+    snapshot[i] = buckets_[i].load(memory_order_relaxed);
+    total += snapshot[i];
+  }
+  if (total == 0) { return summary; }
+
+  summary.count = total;
+  summary.max = max_.load(memory_order_relaxed);
+  summary.mean = sum_.load(memory_order_relaxed) / max<uint64_t>(count_.load(memory_order_relaxed), 1);
+
+  const uint64_t rank50 = (total * 50 + 99) / 100;
+  const uint64_t rank95 = (total * 95 + 99) / 100;
+  const uint64_t rank99 = (total * 99 + 99) / 100;
+  // a percentile is the bucket in which the running count reaches its rank;
+  // 0 is a valid value (sub-microsecond stages), so it can't mean "not set"
+  uint64_t seen = 0;
+  for (int i = 0; i < kBuckets; i++) {
+    if (snapshot[i] == 0) { continue; }
+    const uint64_t before = seen;
+    seen += snapshot[i];
+    uint64_t value = min(BucketValue(i), summary.max);
+    if (before < rank50 && seen >= rank50) { summary.p50 = value; }
+    if (before < rank95 && seen >= rank95) { summary.p95 = value; }
+    if (before < rank99 && seen >= rank99) {
+      summary.p99 = value;
+      break;
+    }
+  }
+  return summary;
+}
+
+void LatencyHistogram::Reset() {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, memory_order_relaxed);
+  }
+  count_.store(0, memory_order_relaxed);
+  sum_.store(0, memory_order_relaxed);
+  max_.store(0, memory_order_relaxed);
+}
+
+const char* StageStats::StageName(Stage stage) {
+  switch (stage) {
+    case Stage::eFrameInterval: return "frame_interval";
+    case Stage::eDeserialize: return "deserialize";
+    case Stage::eAllocate: return "allocate";
+    case Stage::eResize: return "resize";
+    case Stage::eExecute: return "execute";
+    case Stage::eNpuPre: return "npu_pre";
+    case Stage::eNpuRun: return "npu_run";
+    case Stage::eNpuPost: return "npu_post";
+    case Stage::eParse: return "parse";
+    case Stage::eBuildXml: return "build_xml";
+    case Stage::eSend: return "send";
+    case Stage::eFrameTotal: return "frame_total";
+    default: return "unknown";
+  }
+}
+
+const char* StageStats::CounterName(Counter counter) {
+  switch (counter) {
+    case Counter::eReceived: return "received";
+    case Counter::eDropped: return "dropped";
+    case Counter::eInferred: return "inferred";
+    case Counter::eSuppressed: return "suppressed";
+    case Counter::eReused: return "reused";
+    default: return "unknown";
+  }
+}
+
+StageClock::time_point StageStats::Record(Stage stage, StageClock::time_point start) {
+  auto now = StageClock::now();
+  Record(stage, static_cast<uint64_t>(duration_cast<microseconds>(now - start).count()));
+  return now;
+}
+
+void StageStats::FrameArrived(StageClock::time_point arrival) {
+  int64_t now_ns = duration_cast<nanoseconds>(arrival.time_since_epoch()).count();
+  int64_t prev_ns = last_arrival_ns_.exchange(now_ns, memory_order_relaxed);
+  if (prev_ns != 0 && now_ns > prev_ns) {
+    Record(Stage::eFrameInterval, static_cast<uint64_t>((now_ns - prev_ns) / 1000));
+  }
+}
+
+void StageStats::Reset() {
+  for (auto& histogram : histograms_) {
+    histogram.Reset();
+  }
+  for (auto& counter : counters_) {
+    counter.store(0, memory_order_relaxed);
+  }
+  last_arrival_ns_.store(0, memory_order_relaxed);
+}
+
+string StageStats::ToJson() const {
+  JsonUtility::JsonDocument document(JsonUtility::Type::kObjectType);
+  auto& alloc = document.GetAllocator();
+
+  JsonUtility::ValueType stages(rapidjson::kObjectType);
+  for (int i = 0; i < static_cast<int>(Stage::eCount); i++) {
+    auto summary = histograms_[i].Summarize();
+
+    JsonUtility::ValueType stage(rapidjson::kObjectType);
+    JsonUtility::set(stage, "count", summary.count, alloc);
+    JsonUtility::set(stage, "p50_us", summary.p50, alloc);
+    JsonUtility::set(stage, "p95_us", summary.p95, alloc);
+    JsonUtility::set(stage, "p99_us", summary.p99, alloc);
+    JsonUtility::set(stage, "max_us", summary.max, alloc);
+    JsonUtility::set(stage, "mean_us", summary.mean, alloc);
+    stages.AddMember(JsonUtility::ValueType(StageName(static_cast<Stage>(i)), alloc), stage, alloc);
+  }
+  document.AddMember(JsonUtility::ValueType("Stages", alloc), stages, alloc);
+
+  JsonUtility::ValueType frames(rapidjson::kObjectType);
+  for (int i = 0; i < static_cast<int>(Counter::eCount); i++) {
+    JsonUtility::set(frames, CounterName(static_cast<Counter>(i)), Get(static_cast<Counter>(i)), alloc);
+  }
+  document.AddMember(JsonUtility::ValueType("Frames", alloc), frames, alloc);
+
+  string str_out;
+  getJsonString(document, str_out);
+  return str_out;
+}
@@ -0,0 +1,60 @@
+#include "stream_selector.h"
+
+void StreamSelector::SetRequirement(const Requirement& requirement)
+{
+  requirement_ = requirement;
+  Invalidate();
+}
+
+bool StreamSelector::Usable(const RawImage& image)
+{
+  // the pixels are only read directly where the SDK declares them
+  return image.width != 0 && image.height != 0 && (!SdkAccess::kExtended || SdkAccess::Pixels(image)) &&
+         image.width <= kMaxSize && image.height <= kMaxSize;
+}
+
+const RawImage* StreamSelector::Select(const RawImage* head)
+{
+  if (!head) { return nullptr; }
+
+  if (cached_index_ >= 0 && cached_head_.Matches(*head)) {
+    const RawImage* image = head;
+    for (int i = 0; i < cached_index_ && image; i++) { image = image->next; }
+    if (image && cached_stream_.Matches(*image) && Usable(*image)) { return image; }
+  }
+
+  cached_index_ = Choose(head);
+  if (cached_index_ < 0) { return nullptr; }
+
+  const RawImage* image = head;
+  for (int i = 0; i < cached_index_; i++) { image = image->next; }
+  cached_head_ = {head->width, head->height, SdkAccess::Layout(*head)};
+  cached_stream_ = {image->width, image->height, SdkAccess::Layout(*image)};
+  return image;
+}
+
+int StreamSelector::Choose(const RawImage* head) const
+{
+  int fit = -1;
+  uint64_t fit_area = 0;
+  int largest = -1;
+  uint64_t largest_area = 0;
+
+  int index = 0;
+  for (const RawImage* image = head; image; image = image->next, index++) {
+    if (!Usable(*image)) { continue; }
+    if (index == requirement_.stream_index) { return index; }
+
+    const uint64_t area = static_cast<uint64_t>(image->width) * image->height;
+    if (image->width >= requirement_.min_width && image->height >= requirement_.min_height &&
+        (fit < 0 || area < fit_area)) {
+      fit = index;
+      fit_area = area;
+    }
+    if (largest < 0 || area > largest_area) {
+      largest = index;
+      largest_area = area;
+    }
+  }
+  return fit >= 0 ? fit : largest;
+}
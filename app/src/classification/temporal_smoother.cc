@@ -0,0 +1,138 @@
+#include "temporal_smoother.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+// EMA candidates whose corrected score is closer to 0 than this are forgotten
+constexpr float kEmaFloor = 1e-4f;
+
+}  // namespace
+
+bool TemporalSmoother::FromString(const string& name, Type& type)
+{
+  if (name.empty() || name == "none") {
+    type = Type::eNone;
+  } else if (name == "ema") {
+    type = Type::eEma;
+  } else if (name == "window") {
+    type = Type::eWindow;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void TemporalSmoother::Configure(const Settings& settings)
+{
+  settings_ = settings;
+  settings_.alpha = min(1.0f, max(settings_.alpha, 1e-3f));
+  settings_.window = min(kMaxWindow, max<uint32_t>(settings_.window, 1));
+  Reset();
+}
+
+TemporalSmoother::Candidate& TemporalSmoother::Find(vector<Candidate>& candidates, int id)
+{
+  for (auto& candidate : candidates) {
+    if (candidate.id == id) { return candidate; }
+  }
+  candidates.push_back({id, 0.0f, 0});
+  return candidates.back();
+}
+
+const ClassResult* TemporalSmoother::Smooth(const string& model_path, uint32_t output, const ClassResult* objects,
+                                            size_t count)
+{
+  if (settings_.type == Type::eNone) { return objects; }
+
+  auto it = tracks_.find(model_path);
+  if (it == tracks_.end()) { it = tracks_.emplace(model_path, vector<Track>()).first; }
+  auto& outputs = it->second;
+  if (outputs.size() <= output) { outputs.resize(output + 1); }
+  auto& track = outputs[output];
+
+  // a different set of objects (crops reconfigured) starts over
+  if (track.objects.size() != count) {
+    track.objects.assign(count, Object());
+    for (auto& object : track.objects) {
+      object.candidates.reserve(settings_.type == Type::eEma ? kMaxCandidates + ClassResult::kMaxTopK
+                                                            : settings_.window * ClassResult::kMaxTopK);
+      if (settings_.type == Type::eWindow) { object.frames.resize(settings_.window); }
+    }
+  }
+  track.smoothed.assign(objects, objects + count);
+
+  for (size_t i = 0; i < count; i++) {
+    auto& object = track.objects[i];
+    Update(object, objects[i]);
+
+    // best first, earlier class id on ties, like TopK
+    auto& candidates = object.candidates;
+    auto& result = track.smoothed[i];
+    result.count = static_cast<uint32_t>(min<size_t>(objects[i].count, candidates.size()));
+    partial_sort(candidates.begin(), candidates.begin() + result.count, candidates.end(),
+                 [](const Candidate& a, const Candidate& b) { return a.sum > b.sum || (a.sum == b.sum && a.id < b.id); });
+    const float scale = settings_.type == Type::eWindow ? 1.0f / object.filled : 1.0f / object.weight;
+    for (uint32_t k = 0; k < result.count; k++) {
+      result.top[k] = {candidates[k].id, candidates[k].sum * scale};
+    }
+  }
+  return track.smoothed.data();
+}
+
+void TemporalSmoother::Update(Object& object, const ClassResult& frame)
+{
+  auto& candidates = object.candidates;
+
+  // a NaN would never leave the average again
+  ClassResult current = frame;
+  current.count = 0;
+  for (uint32_t k = 0; k < frame.count; k++) {
+    if (isfinite(frame.top[k].value)) { current.top[current.count++] = frame.top[k]; }
+  }
+
+  if (settings_.type == Type::eEma) {
+    const float keep = 1.0f - settings_.alpha;
+    for (auto& candidate : candidates) { candidate.sum *= keep; }
+    for (uint32_t k = 0; k < current.count; k++) {
+      Find(candidates, current.top[k].id).sum += settings_.alpha * current.top[k].value;
+    }
+    object.weight = object.weight * keep + settings_.alpha;
+    // by magnitude, so negative logits are kept too
+    const float floor = kEmaFloor * object.weight;
+    candidates.erase(remove_if(candidates.begin(), candidates.end(),
+                               [floor](const Candidate& c) { return fabs(c.sum) < floor; }),
+                     candidates.end());
+    if (candidates.size() > kMaxCandidates) {
+      nth_element(candidates.begin(), candidates.begin() + kMaxCandidates, candidates.end(),
+                  [](const Candidate& a, const Candidate& b) { return a.sum > b.sum; });
+      candidates.resize(kMaxCandidates);
+    }
+    return;
+  }
+
+  // eWindow: drop the frame leaving the window, add the new one
+  auto& slot = object.frames[object.next];
+  if (object.filled == settings_.window) {
+    for (uint32_t k = 0; k < slot.count; k++) {
+      auto& candidate = Find(candidates, slot.top[k].id);
+      candidate.sum -= slot.top[k].value;
+      candidate.seen--;
+    }
+    candidates.erase(remove_if(candidates.begin(), candidates.end(),
+                               [](const Candidate& c) { return c.seen == 0; }),
+                     candidates.end());
+  } else {
+    object.filled++;
+  }
+  slot = current;
+  object.next = (object.next + 1) % settings_.window;
+  for (uint32_t k = 0; k < current.count; k++) {
+    auto& candidate = Find(candidates, current.top[k].id);
+    candidate.sum += current.top[k].value;
+    candidate.seen++;
+  }
+}
@@ -0,0 +1,163 @@
+#include "top_k.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TOP_K_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define TOP_K_SSE2 1
+#endif
+
+using namespace std;
+
+namespace {
+
+// scores per pre-filter test: four 128-bit vectors
+template <typename T>
+constexpr size_t kBlock = 64 / sizeof(T);
+
+// heap order: the worst entry is on top
+inline bool Better(const TopK::Entry& a, const TopK::Entry& b)
+{
+  return a.value > b.value || (a.value == b.value && a.id < b.id);
+}
+
+// Replaces the worst entry and sifts the new one down; a candidate is only
+// offered when it beats the worst, so it never has to move up.
+inline void Offer(TopK::Entry* heap, size_t k, int id, float value, float& threshold)
+{
+  if (!(value > threshold)) { return; }
+  const TopK::Entry entry = {id, value};
+  size_t i = 0;
+  for (;;) {
+    size_t child = 2 * i + 1;
+    if (child >= k) { break; }
+    if (child + 1 < k && Better(heap[child], heap[child + 1])) { child++; }
+    if (!Better(entry, heap[child])) { break; }
+    heap[i] = heap[child];
+    i = child;
+  }
+  heap[i] = entry;
+  threshold = heap[0].value;
+}
+
+// Bit i set when score i of the kBlock at |p| may beat |threshold|. NEON
+// has no cheap movemask, so there a passing block reports every lane.
+inline uint64_t BlockCandidates(const float* p, float threshold)
+{
+#if defined(TOP_K_NEON)
+  float32x4_t m = vmaxq_f32(vmaxq_f32(vld1q_f32(p), vld1q_f32(p + 4)),
+                            vmaxq_f32(vld1q_f32(p + 8), vld1q_f32(p + 12)));
+  return vmaxvq_f32(m) > threshold ? 0xFFFF : 0;
+#elif defined(TOP_K_SSE2)
+  const __m128 t = _mm_set1_ps(threshold);
+  const __m128 beats = _mm_or_ps(_mm_or_ps(_mm_cmpgt_ps(_mm_loadu_ps(p), t), _mm_cmpgt_ps(_mm_loadu_ps(p + 4), t)),
+                                 _mm_or_ps(_mm_cmpgt_ps(_mm_loadu_ps(p + 8), t), _mm_cmpgt_ps(_mm_loadu_ps(p + 12), t)));
+  if (_mm_movemask_ps(beats) == 0) { return 0; }
+  return static_cast<uint64_t>(_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(p), t))) |
+         static_cast<uint64_t>(_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(p + 4), t))) << 4 |
+         static_cast<uint64_t>(_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(p + 8), t))) << 8 |
+         static_cast<uint64_t>(_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(p + 12), t))) << 12;
+#else
+  uint64_t mask = 0;
+  for (size_t i = 0; i < kBlock<float>; i++) { mask |= static_cast<uint64_t>(p[i] > threshold) << i; }
+  return mask;
+#endif
+}
+
+// Quantised scores: the threshold is always one of the integers, so the
+// block test is exact.
+inline uint64_t BlockCandidates(const uint8_t* p, float threshold)
+{
+#if defined(TOP_K_NEON)
+  uint8x16_t m = vmaxq_u8(vmaxq_u8(vld1q_u8(p), vld1q_u8(p + 16)),
+                          vmaxq_u8(vld1q_u8(p + 32), vld1q_u8(p + 48)));
+  return vmaxvq_u8(m) > threshold ? ~0ull : 0;
+#elif defined(TOP_K_SSE2)
+  // no unsigned byte compare: v > t  <=>  max(v, t) != t
+  const __m128i t = _mm_set1_epi8(static_cast<char>(static_cast<uint8_t>(threshold)));
+  uint64_t mask = 0;
+  for (int i = 0; i < 4; i++) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+    mask |= static_cast<uint64_t>(~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, t), t)) & 0xFFFF) << (16 * i);
+  }
+  return mask;
+#else
+  uint64_t mask = 0;
+  for (size_t i = 0; i < kBlock<uint8_t>; i++) { mask |= static_cast<uint64_t>(p[i] > threshold) << i; }
+  return mask;
+#endif
+}
+
+inline uint64_t BlockCandidates(const int8_t* p, float threshold)
+{
+#if defined(TOP_K_NEON)
+  int8x16_t m = vmaxq_s8(vmaxq_s8(vld1q_s8(p), vld1q_s8(p + 16)),
+                         vmaxq_s8(vld1q_s8(p + 32), vld1q_s8(p + 48)));
+  return vmaxvq_s8(m) > threshold ? ~0ull : 0;
+#elif defined(TOP_K_SSE2)
+  const __m128i t = _mm_set1_epi8(static_cast<char>(static_cast<int8_t>(threshold)));
+  uint64_t mask = 0;
+  for (int i = 0; i < 4; i++) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+    mask |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(v, t))) << (16 * i);
+  }
+  return mask;
+#else
+  uint64_t mask = 0;
+  for (size_t i = 0; i < kBlock<int8_t>; i++) { mask |= static_cast<uint64_t>(p[i] > threshold) << i; }
+  return mask;
+#endif
+}
+
+inline float Seed(float v) { return isnan(v) ? -INFINITY : v; }
+inline float Seed(uint8_t v) { return v; }
+inline float Seed(int8_t v) { return v; }
+
+template <typename T>
+size_t SelectImpl(const T* data, size_t width, size_t k, TopK::Entry* out)
+{
+  const size_t n = min(k, width);
+  if (n == 0 || data == nullptr || out == nullptr) { return 0; }
+
+  for (size_t i = 0; i < n; i++) {
+    out[i] = {static_cast<int>(i), Seed(data[i])};
+  }
+  make_heap(out, out + n, Better);
+  float threshold = out[0].value;
+
+  size_t i = n;
+  for (; i + kBlock<T> <= width; i += kBlock<T>) {
+    // candidates are re-checked by Offer(), as the threshold rises
+    for (uint64_t mask = BlockCandidates(data + i, threshold); mask; mask &= mask - 1) {
+      const size_t j = i + __builtin_ctzll(mask);
+      Offer(out, n, static_cast<int>(j), data[j], threshold);
+    }
+  }
+  for (; i < width; i++) {
+    Offer(out, n, static_cast<int>(i), data[i], threshold);
+  }
+
+  sort_heap(out, out + n, Better);
+  return n;
+}
+
+}  // namespace
+
+size_t TopK::Select(const float* data, size_t width, size_t k, Entry* out)
+{
+  return SelectImpl(data, width, k, out);
+}
+
+size_t TopK::Select(const uint8_t* data, size_t width, size_t k, Entry* out)
+{
+  return SelectImpl(data, width, k, out);
+}
+
+size_t TopK::Select(const int8_t* data, size_t width, size_t k, Entry* out)
+{
+  return SelectImpl(data, width, k, out);
+}
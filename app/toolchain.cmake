@@ -11,7 +11,12 @@ endif()
 
 message("SOC: ${SOC}")
 
-if (SOC STREQUAL "cv5")
+if (SOC STREQUAL "host")
+  set(TOOLCHAIN_PATH "")
+  if (NOT CMAKE_BUILD_TYPE)
+    set(CMAKE_BUILD_TYPE RelWithDebInfo)
+  endif()
+elseif (SOC STREQUAL "cv5")
   set(TOOLCHAIN_PATH "${SDK_PATH}/toolchain/cortex-a76-2022.08-gcc12.1-linux5.15/bin/aarch64-linux-gnu-")
 elseif(SOC STREQUAL "orinnx8g_jp512")
   set(TOOLCHAIN_PATH "${SDK_PATH}/toolchain/bootlin-toolchain-gcc-93/bin/aarch64-buildroot-linux-gnu-")